@@ -17,6 +17,8 @@ class ImpliedAddressingMode : public AddressingMode {
 public:
     ImpliedAddressingMode() { mnemonic = "IMP"; }
     uint16_t operator()(CPU& cpu) override;
+    static uint16_t resolve(CPU& cpu);
+    static uint16_t fromOperand(CPU& cpu, uint16_t operand);
 };
 
 // Immediate Addressing Mode
@@ -24,6 +26,8 @@ class ImmediateAddressingMode : public AddressingMode {
 public:
     ImmediateAddressingMode() { mnemonic = "IMM"; }
     uint16_t operator()(CPU& cpu) override;
+    static uint16_t resolve(CPU& cpu);
+    static uint16_t fromOperand(CPU& cpu, uint16_t operand);
 };
 
 // Zero Page Addressing Mode
@@ -31,6 +35,8 @@ class ZeroPageAddressingMode : public AddressingMode {
 public:
     ZeroPageAddressingMode() { mnemonic = "ZP"; }
     uint16_t operator()(CPU& cpu) override;
+    static uint16_t resolve(CPU& cpu);
+    static uint16_t fromOperand(CPU& cpu, uint16_t operand);
 };
 
 // Absolute Addressing Mode
@@ -38,6 +44,8 @@ class AbsoluteAddressingMode : public AddressingMode {
 public:
     AbsoluteAddressingMode() { mnemonic = "ABS"; }
     uint16_t operator()(CPU& cpu) override;
+    static uint16_t resolve(CPU& cpu);
+    static uint16_t fromOperand(CPU& cpu, uint16_t operand);
 };
 
 // Zero Page,X Addressing Mode
@@ -45,6 +53,8 @@ class ZeroPageXAddressingMode : public AddressingMode {
 public:
     ZeroPageXAddressingMode() { mnemonic = "ZPX"; }
     uint16_t operator()(CPU& cpu) override;
+    static uint16_t resolve(CPU& cpu);
+    static uint16_t fromOperand(CPU& cpu, uint16_t operand);
 };
 
 // Zero Page,Y Addressing Mode
@@ -52,6 +62,8 @@ class ZeroPageYAddressingMode : public AddressingMode {
 public:
     ZeroPageYAddressingMode() { mnemonic = "ZPY"; }
     uint16_t operator()(CPU& cpu) override;
+    static uint16_t resolve(CPU& cpu);
+    static uint16_t fromOperand(CPU& cpu, uint16_t operand);
 };
 
 // Absolute,X Addressing Mode
@@ -59,6 +71,12 @@ class AbsoluteXAddressingMode : public AddressingMode {
 public:
     AbsoluteXAddressingMode() { mnemonic = "ABS,X"; }
     uint16_t operator()(CPU& cpu) override;
+    static uint16_t resolve(CPU& cpu);
+    static uint16_t fromOperand(CPU& cpu, uint16_t operand);
+    // For read instructions, which take a cycle more when indexing crosses
+    // a page.
+    static uint16_t resolveForRead(CPU& cpu);
+    static uint16_t fromOperandForRead(CPU& cpu, uint16_t operand);
 };
 
 // Absolute,Y Addressing Mode
@@ -66,6 +84,10 @@ class AbsoluteYAddressingMode : public AddressingMode {
 public:
     AbsoluteYAddressingMode() { mnemonic = "ABS,Y"; }
     uint16_t operator()(CPU& cpu) override;
+    static uint16_t resolve(CPU& cpu);
+    static uint16_t fromOperand(CPU& cpu, uint16_t operand);
+    static uint16_t resolveForRead(CPU& cpu);
+    static uint16_t fromOperandForRead(CPU& cpu, uint16_t operand);
 };
 
 // Indirect Addressing Mode
@@ -73,6 +95,27 @@ class IndirectAddressingMode : public AddressingMode {
 public:
     IndirectAddressingMode() { mnemonic = "IND"; }
     uint16_t operator()(CPU& cpu) override;
+    static uint16_t resolve(CPU& cpu);
+    static uint16_t fromOperand(CPU& cpu, uint16_t operand);
+};
+
+// Indirect Addressing Mode as the 65C02 does it: the pointer's high byte is
+// read from the next address even when that is on the next page.
+class IndirectNoWrapAddressingMode : public AddressingMode {
+public:
+    IndirectNoWrapAddressingMode() { mnemonic = "IND"; }
+    uint16_t operator()(CPU& cpu) override;
+    static uint16_t resolve(CPU& cpu);
+    static uint16_t fromOperand(CPU& cpu, uint16_t operand);
+};
+
+// Zero Page Indirect Addressing Mode (65C02)
+class ZeroPageIndirectAddressingMode : public AddressingMode {
+public:
+    ZeroPageIndirectAddressingMode() { mnemonic = "ZPI"; }
+    uint16_t operator()(CPU& cpu) override;
+    static uint16_t resolve(CPU& cpu);
+    static uint16_t fromOperand(CPU& cpu, uint16_t operand);
 };
 
 // Indirect Indexed (X) Addressing Mode
@@ -80,6 +123,8 @@ class IndexedIndirectXAddressingMode : public AddressingMode {
 public:
     IndexedIndirectXAddressingMode() { mnemonic = "IX"; }
     uint16_t operator()(CPU& cpu) override;
+    static uint16_t resolve(CPU& cpu);
+    static uint16_t fromOperand(CPU& cpu, uint16_t operand);
 };
 
 // Indirect Indexed (Y) Addressing Mode
@@ -87,6 +132,10 @@ class IndirectIndexedYAddressingMode : public AddressingMode {
 public:
     IndirectIndexedYAddressingMode() { mnemonic = "IY"; }
     uint16_t operator()(CPU& cpu) override;
+    static uint16_t resolve(CPU& cpu);
+    static uint16_t fromOperand(CPU& cpu, uint16_t operand);
+    static uint16_t resolveForRead(CPU& cpu);
+    static uint16_t fromOperandForRead(CPU& cpu, uint16_t operand);
 };
 
 // Relative Addressing Mode
@@ -94,6 +143,8 @@ class RelativeAddressingMode : public AddressingMode {
 public:
     RelativeAddressingMode() { mnemonic = "REL"; }
     uint16_t operator()(CPU& cpu) override;
+    static uint16_t resolve(CPU& cpu);
+    static uint16_t fromOperand(CPU& cpu, uint16_t operand);
 };
 
 #endif
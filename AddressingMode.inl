@@ -0,0 +1,206 @@
+#ifndef ADDRESSINGMODE_INL
+#define ADDRESSINGMODE_INL
+
+// Addressing mode logic shared by the virtual classes and the fused handlers.
+// Include only where CPU is a complete type.
+//
+// resolve() fetches the operand bytes at PC; fromOperand() computes the
+// effective address from an operand that was already extracted, with PC
+// pointing past the instruction. Predecoded blocks call fromOperand directly.
+
+#include "AddressingMode.h"
+#include "CPU.h"
+
+//Implied Addressing Mode
+inline uint16_t ImpliedAddressingMode::resolve(CPU& cpu) {
+    return 0;  // Implied addressing mode doesn't need an operand
+}
+
+inline uint16_t ImpliedAddressingMode::fromOperand(CPU& cpu, uint16_t operand) {
+    return 0;
+}
+
+// Immediate Addressing Mode
+inline uint16_t ImmediateAddressingMode::resolve(CPU& cpu) {
+    cpu.setPC(cpu.getPC()+1);
+    return cpu.getPC()-1;
+}
+
+inline uint16_t ImmediateAddressingMode::fromOperand(CPU& cpu, uint16_t operand) {
+    return cpu.getPC()-1;
+}
+
+// Zero Page Addressing Mode
+inline uint16_t ZeroPageAddressingMode::resolve(CPU& cpu) {
+    return fromOperand(cpu, cpu.fetch());
+}
+
+inline uint16_t ZeroPageAddressingMode::fromOperand(CPU& cpu, uint16_t operand) {
+    return operand & 0xFF;
+}
+
+// Absolute Addressing Mode
+inline uint16_t AbsoluteAddressingMode::resolve(CPU& cpu) {
+    uint8_t lowByte = cpu.fetch();
+    uint8_t highByte = cpu.fetch();
+    return fromOperand(cpu, (highByte << 8) | lowByte);
+}
+
+inline uint16_t AbsoluteAddressingMode::fromOperand(CPU& cpu, uint16_t operand) {
+    return operand;
+}
+
+// Zero Page,X Addressing Mode
+inline uint16_t ZeroPageXAddressingMode::resolve(CPU& cpu) {
+    return fromOperand(cpu, cpu.fetch());
+}
+
+inline uint16_t ZeroPageXAddressingMode::fromOperand(CPU& cpu, uint16_t operand) {
+    return (operand + cpu.getX()) & 0xFF;
+}
+
+// Zero Page,Y Addressing Mode
+inline uint16_t ZeroPageYAddressingMode::resolve(CPU& cpu) {
+    return fromOperand(cpu, cpu.fetch());
+}
+
+inline uint16_t ZeroPageYAddressingMode::fromOperand(CPU& cpu, uint16_t operand) {
+    return (operand + cpu.getY()) & 0xFF;
+}
+
+// Absolute,X Addressing Mode
+inline uint16_t AbsoluteXAddressingMode::resolve(CPU& cpu) {
+    uint8_t lowByte = cpu.fetch();
+    uint8_t highByte = cpu.fetch();
+    return fromOperand(cpu, (highByte << 8) | lowByte);
+}
+
+inline uint16_t AbsoluteXAddressingMode::fromOperand(CPU& cpu, uint16_t operand) {
+    return operand + cpu.getX();
+}
+
+inline uint16_t AbsoluteXAddressingMode::resolveForRead(CPU& cpu) {
+    uint8_t lowByte = cpu.fetch();
+    uint8_t highByte = cpu.fetch();
+    return fromOperandForRead(cpu, (highByte << 8) | lowByte);
+}
+
+inline uint16_t AbsoluteXAddressingMode::fromOperandForRead(CPU& cpu, uint16_t operand) {
+    uint16_t address = fromOperand(cpu, operand);
+    cpu.addCycles(((operand ^ address) >> 8) != 0);
+    return address;
+}
+
+// Absolute,Y Addressing Mode
+inline uint16_t AbsoluteYAddressingMode::resolve(CPU& cpu) {
+    uint8_t lowByte = cpu.fetch();
+    uint8_t highByte = cpu.fetch();
+    return fromOperand(cpu, (highByte << 8) | lowByte);
+}
+
+inline uint16_t AbsoluteYAddressingMode::fromOperand(CPU& cpu, uint16_t operand) {
+    return operand + cpu.getY();
+}
+
+inline uint16_t AbsoluteYAddressingMode::resolveForRead(CPU& cpu) {
+    uint8_t lowByte = cpu.fetch();
+    uint8_t highByte = cpu.fetch();
+    return fromOperandForRead(cpu, (highByte << 8) | lowByte);
+}
+
+inline uint16_t AbsoluteYAddressingMode::fromOperandForRead(CPU& cpu, uint16_t operand) {
+    uint16_t address = fromOperand(cpu, operand);
+    cpu.addCycles(((operand ^ address) >> 8) != 0);
+    return address;
+}
+
+// Indirect Addressing Mode
+inline uint16_t IndirectAddressingMode::resolve(CPU& cpu) {
+    uint8_t lowByte = cpu.fetch();
+    uint8_t highByte = cpu.fetch();
+    return fromOperand(cpu, (highByte << 8) | lowByte);
+}
+
+// The NMOS 6502 does not carry into the pointer's high byte, so JMP ($xxFF)
+// takes its high byte from $xx00.
+inline uint16_t IndirectAddressingMode::fromOperand(CPU& cpu, uint16_t operand) {
+    uint8_t low = cpu.read(operand);
+    uint8_t high = cpu.read((operand & 0xFF00) | ((operand + 1) & 0xFF));
+    return (high << 8) | low;
+}
+
+// Indirect Addressing Mode, 65C02
+inline uint16_t IndirectNoWrapAddressingMode::resolve(CPU& cpu) {
+    uint8_t lowByte = cpu.fetch();
+    uint8_t highByte = cpu.fetch();
+    return fromOperand(cpu, (highByte << 8) | lowByte);
+}
+
+inline uint16_t IndirectNoWrapAddressingMode::fromOperand(CPU& cpu, uint16_t operand) {
+    uint8_t low = cpu.read(operand);
+    uint8_t high = cpu.read(operand + 1);
+    return (high << 8) | low;
+}
+
+// Zero Page Indirect Addressing Mode
+inline uint16_t ZeroPageIndirectAddressingMode::resolve(CPU& cpu) {
+    return fromOperand(cpu, cpu.fetch());
+}
+
+inline uint16_t ZeroPageIndirectAddressingMode::fromOperand(CPU& cpu, uint16_t operand) {
+    uint8_t address = operand;
+
+    uint8_t low = cpu.read(address);
+    uint8_t high = cpu.read(static_cast<uint8_t>(address + 1));
+    return (high << 8) | low;
+}
+
+// Indexed Indirect (X) Addressing Mode
+inline uint16_t IndexedIndirectXAddressingMode::resolve(CPU& cpu) {
+    return fromOperand(cpu, cpu.fetch());
+}
+
+inline uint16_t IndexedIndirectXAddressingMode::fromOperand(CPU& cpu, uint16_t operand) {
+    uint16_t address = (operand + cpu.getX()) & 0xFF;
+
+    uint8_t low = cpu.read(address);
+    uint8_t high = cpu.read(address + 1);
+    return (high << 8) | low;
+}
+
+// Indirect Indexed (Y) Addressing Mode
+inline uint16_t IndirectIndexedYAddressingMode::resolve(CPU& cpu) {
+    return fromOperand(cpu, cpu.fetch());
+}
+
+inline uint16_t IndirectIndexedYAddressingMode::fromOperand(CPU& cpu, uint16_t operand) {
+    uint16_t address = operand & 0xFF;
+
+    uint8_t low = cpu.read(address);
+    uint8_t high = cpu.read(address + 1);
+    uint16_t indirectAddress = (high << 8) | low;
+    return indirectAddress + cpu.getY();
+}
+
+inline uint16_t IndirectIndexedYAddressingMode::resolveForRead(CPU& cpu) {
+    return fromOperandForRead(cpu, cpu.fetch());
+}
+
+inline uint16_t IndirectIndexedYAddressingMode::fromOperandForRead(CPU& cpu, uint16_t operand) {
+    uint16_t address = fromOperand(cpu, operand);
+    uint16_t indirectAddress = address - cpu.getY();
+    cpu.addCycles(((indirectAddress ^ address) >> 8) != 0);
+    return address;
+}
+
+// Relative Addressing Mode
+inline uint16_t RelativeAddressingMode::resolve(CPU& cpu) {
+    return fromOperand(cpu, cpu.fetch());
+}
+
+inline uint16_t RelativeAddressingMode::fromOperand(CPU& cpu, uint16_t operand) {
+    int8_t offset = static_cast<int8_t>(operand);
+    return cpu.getPC() + offset;
+}
+
+#endif
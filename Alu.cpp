@@ -0,0 +1,39 @@
+#include "Alu.h"
+#include <vector>
+
+namespace {
+
+typedef AluResult (*AluFunction)(bool decimal, bool carry, uint8_t accumulator, uint8_t operand);
+
+template <AluFunction Compute, bool Decimal>
+const AluResult* aluTable() {
+    static const std::vector<AluResult> table = [] {
+        std::vector<AluResult> entries(0x20000);
+        for (uint32_t index = 0; index < entries.size(); index++) {
+            entries[index] = Compute(Decimal, index >> 16, (index >> 8) & 0xFF, index & 0xFF);
+        }
+        return entries;
+    }();
+    return table.data();
+}
+
+template <typename Variant>
+const AluTables& variantAluTables() {
+    const AluResult* adcTable = aluTable<&computeAdc<NMOS6502>, false>();
+    const AluResult* sbcTable = aluTable<&computeSbc<NMOS6502>, false>();
+    static const AluTables tables = {
+        {adcTable, Variant::decimalMode ? aluTable<&computeAdc<Variant>, true>() : adcTable},
+        {sbcTable, Variant::decimalMode ? aluTable<&computeSbc<Variant>, true>() : sbcTable},
+    };
+    return tables;
+}
+
+}
+
+const AluTables& getAluTables(CpuVariant variant) {
+    switch (variant) {
+        case CpuVariant::WDC65C02: return variantAluTables<WDC65C02>();
+        case CpuVariant::Ricoh2A03: return variantAluTables<Ricoh2A03>();
+        default: return variantAluTables<NMOS6502>();
+    }
+}
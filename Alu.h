@@ -0,0 +1,112 @@
+#ifndef ALU_H
+#define ALU_H
+
+#include <cstdint>
+#include "OpcodeTable.h"
+
+// Result of an ADC or SBC: the new accumulator, and C, Z, V and N in their
+// status register positions with every other bit clear.
+struct AluResult {
+    uint8_t value;
+    uint8_t flags;
+};
+
+// ADC and SBC of one variant as lookup tables over every (carry, A, operand),
+// one table per operation and decimal flag, so both modes take the same
+// single indexed load. Each table holds 128K entries (256 KB); a loop that
+// only ever adds a handful of operands touches a few cache lines of it, one
+// that adds arbitrary bytes spreads over all of it, where the computed forms
+// below touch no data at all (Benchmark compares the two).
+struct AluTables {
+    const AluResult* adc[2];   // indexed by D
+    const AluResult* sbc[2];
+};
+
+inline uint32_t aluIndex(bool carry, uint8_t accumulator, uint8_t operand) {
+    return (static_cast<uint32_t>(carry) << 16) | (accumulator << 8) | operand;
+}
+
+// Built on first use and shared by every CPU of the variant. The binary
+// tables are shared by all variants, and a variant without decimal mode
+// uses them for D set as well.
+const AluTables& getAluTables(CpuVariant variant);
+
+// The computed forms the tables are filled from. Decimal mode follows the
+// NMOS part, whose N, V and Z come from intermediate steps of the BCD
+// correction rather than from the result; the CMOS parts set N and Z from
+// the result. Only valid BCD operands give meaningful results, but every
+// input gives the one the hardware does.
+inline AluResult binaryAdc(bool carry, uint8_t accumulator, uint8_t operand) {
+    unsigned sum = accumulator + operand + carry;
+    uint8_t value = sum & 0xFF;
+    bool overflow = (~(accumulator ^ operand) & (accumulator ^ sum) & 0x80) != 0;
+    return AluResult{value, static_cast<uint8_t>((sum > 0xFF ? FLAG_C : 0) | (value == 0 ? FLAG_Z : 0) |
+                                                 (overflow ? FLAG_V : 0) | (value & FLAG_N))};
+}
+
+// A - operand - !carry is A + ~operand + carry, flags included.
+inline AluResult binarySbc(bool carry, uint8_t accumulator, uint8_t operand) {
+    return binaryAdc(carry, accumulator, ~operand);
+}
+
+template <typename Variant>
+AluResult computeAdc(bool decimal, bool carry, uint8_t accumulator, uint8_t operand) {
+    AluResult binary = binaryAdc(carry, accumulator, operand);
+    if (!Variant::decimalMode || !decimal) {
+        return binary;
+    }
+    unsigned low = (accumulator & 0x0F) + (operand & 0x0F) + carry;
+    if (low >= 0x0A) {
+        low = ((low + 0x06) & 0x0F) + 0x10;
+    }
+    unsigned sum = (accumulator & 0xF0) + (operand & 0xF0) + low;
+    int signedSum = static_cast<int8_t>(accumulator & 0xF0) + static_cast<int8_t>(operand & 0xF0) + static_cast<int>(low);
+    uint8_t negative = sum & 0x80;
+    bool overflow = signedSum < -128 || signedSum > 127;
+    if (sum >= 0xA0) {
+        sum += 0x60;
+    }
+    uint8_t value = sum & 0xFF;
+    uint8_t flags = (sum > 0xFF ? FLAG_C : 0) | (overflow ? FLAG_V : 0);
+    if (Variant::cmosInstructions) {
+        flags |= (value == 0 ? FLAG_Z : 0) | (value & FLAG_N);
+    } else {
+        flags |= (binary.flags & FLAG_Z) | negative;
+    }
+    return AluResult{value, flags};
+}
+
+template <typename Variant>
+AluResult computeSbc(bool decimal, bool carry, uint8_t accumulator, uint8_t operand) {
+    AluResult binary = binarySbc(carry, accumulator, operand);
+    if (!Variant::decimalMode || !decimal) {
+        return binary;
+    }
+    int low = (accumulator & 0x0F) - (operand & 0x0F) + carry - 1;
+    int difference;
+    if (Variant::cmosInstructions) {
+        difference = accumulator - operand + carry - 1;
+        if (difference < 0) {
+            difference -= 0x60;
+        }
+        if (low < 0) {
+            difference -= 0x06;
+        }
+    } else {
+        if (low < 0) {
+            low = ((low - 0x06) & 0x0F) - 0x10;
+        }
+        difference = (accumulator & 0xF0) - (operand & 0xF0) + low;
+        if (difference < 0) {
+            difference -= 0x60;
+        }
+    }
+    uint8_t value = difference & 0xFF;
+    if (!Variant::cmosInstructions) {
+        return AluResult{value, binary.flags};
+    }
+    return AluResult{value, static_cast<uint8_t>((binary.flags & (FLAG_C | FLAG_V)) | (value == 0 ? FLAG_Z : 0) |
+                                                 (value & FLAG_N))};
+}
+
+#endif
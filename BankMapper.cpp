@@ -0,0 +1,107 @@
+#include "BankMapper.h"
+#include <cstring>
+
+BankMapper::BankMapper(Bus& bus, const uint8_t* image, size_t size, uint32_t bankSize, RegionType type)
+    : bus(bus), image(const_cast<uint8_t*>(image)), bankCount(size / bankSize), bankSize(bankSize),
+      writable(type == RegionType::Ram), windowCount(0), registerPage(-1), switches(0) {
+    std::memset(pageWindows, -1, sizeof(pageWindows));
+}
+
+// A switchable ROM window traps writes to pick up bank numbers; the rest
+// are plain memory pages, read-only for ROM.
+bool BankMapper::mapWindow(const Window& window) {
+    uint8_t flags = 0;
+    if (!writable) {
+        flags = PAGE_READ_ONLY | (window.switchable ? PAGE_WRITE_TRAP : 0);
+    }
+    return bus.mapMemory(window.firstPage, bankSize >> 8, image + static_cast<size_t>(window.bank) * bankSize,
+                         flags, this);
+}
+
+int BankMapper::addWindow(uint16_t address, unsigned bank, bool switchable) {
+    if (windowCount == MAX_WINDOWS || (address & 0xFF) || bankCount == 0) {
+        return -1;
+    }
+    Window window{static_cast<uint8_t>(address >> 8), switchable, bank % bankCount};
+    if (!mapWindow(window)) {
+        return -1;
+    }
+    int index = windowCount++;
+    windows[index] = window;
+    for (uint32_t page = window.firstPage; page < 256 && page < window.firstPage + (bankSize >> 8); page++) {
+        pageWindows[page] = index;
+    }
+    return index;
+}
+
+bool BankMapper::mapRegisters(uint8_t page) {
+    if (!bus.mapDevice(page, 1, this)) {
+        return false;
+    }
+    registerPage = page;
+    return true;
+}
+
+void BankMapper::select(int window, unsigned bank) {
+    Window& selected = windows[window];
+    selected.bank = bank % bankCount;
+    bus.remapMemory(selected.firstPage, bankSize >> 8, image + static_cast<size_t>(selected.bank) * bankSize);
+    switches++;
+}
+
+unsigned BankMapper::getBank(int window) const {
+    return windows[window].bank;
+}
+
+unsigned BankMapper::getBankCount() const {
+    return bankCount;
+}
+
+uint64_t BankMapper::getSwitches() const {
+    return switches;
+}
+
+uint8_t BankMapper::read(uint16_t address) {
+    int window = address & 0xFF;
+    return window < windowCount ? windows[window].bank : 0xFF;
+}
+
+void BankMapper::write(uint16_t address, uint8_t data) {
+    uint8_t page = address >> 8;
+    if (page == registerPage) {
+        int window = address & 0xFF;
+        if (window < windowCount) {
+            select(window, data);
+        }
+        return;
+    }
+    int window = pageWindows[page];
+    if (window >= 0 && windows[window].switchable) {
+        select(window, data);
+    }
+}
+
+void BankMapper::saveState(std::vector<uint8_t>& out) const {
+    for (int window = 0; window < windowCount; window++) {
+        for (int shift = 0; shift < 32; shift += 8) {
+            out.push_back(static_cast<uint8_t>(windows[window].bank >> shift));
+        }
+    }
+    if (writable) {
+        out.insert(out.end(), image, image + static_cast<size_t>(bankCount) * bankSize);
+    }
+}
+
+// The banks are filled before selecting, and selecting repoints every
+// window, so code cached from them is dropped even where the bank stays.
+bool BankMapper::loadState(const uint8_t* data, size_t size) {
+    size_t banks = writable ? static_cast<size_t>(bankCount) * bankSize : 0;
+    if (size != static_cast<size_t>(windowCount) * 4 + banks) {
+        return false;
+    }
+    std::memcpy(image, data + windowCount * 4, banks);
+    for (int window = 0; window < windowCount; window++, data += 4) {
+        select(window, data[0] | (data[1] << 8) | (data[2] << 16) | (static_cast<unsigned>(data[3]) << 24));
+    }
+    return true;
+}
@@ -0,0 +1,73 @@
+#ifndef BANKMAPPER_H
+#define BANKMAPPER_H
+
+#include <cstddef>
+#include <cstdint>
+#include "Bus.h"
+#include "MemoryMap.h"
+
+// Banked ROM or RAM for images larger than the address space. The image is
+// mapped once and never copied; windows on the bus each show one bank of
+// it, and selecting another repoints the window's entries in the page
+// table, 32 of them for an 8K bank and 64 for a 16K one. Engines caching
+// code in a window hear about the switch through
+// WriteWatcher::onPageRemapped().
+//
+// Banks are selected the way simple cartridge mappers do it: a write to a
+// switchable ROM window selects the bank that window shows, the written
+// value being the bank number, and a write to offset n of the register
+// page, if one is mapped, selects the bank of window n. Reading a register
+// returns the bank selected. Bank numbers wrap at the bank count.
+class BankMapper : public Device {
+public:
+    static const int MAX_WINDOWS = 8;
+
+private:
+    struct Window {
+        uint8_t firstPage;
+        bool switchable;
+        unsigned bank;
+    };
+
+    Bus& bus;
+    uint8_t* image;
+    unsigned bankCount;
+    uint32_t bankSize;
+    bool writable;
+    Window windows[MAX_WINDOWS];
+    int windowCount;
+    // Window each page belongs to, -1 outside them.
+    int8_t pageWindows[256];
+    int registerPage;
+    uint64_t switches;
+
+    bool mapWindow(const Window& window);
+
+public:
+    // bankSize is a multiple of 256, and image holds at least one bank; a
+    // partial bank at the end is ignored. Type is Rom or Ram, and RAM banks
+    // are written through image, which must then be writable.
+    BankMapper(Bus& bus, const uint8_t* image, size_t size, uint32_t bankSize, RegionType type);
+    BankMapper(const BankMapper&) = delete;
+    BankMapper& operator=(const BankMapper&) = delete;
+
+    // Maps a window of one bank at address, which must start a page, and
+    // returns its number, or -1 when every window is taken or the bus
+    // refuses the pages. A fixed window ignores writes to it, but can still
+    // be switched with select().
+    int addWindow(uint16_t address, unsigned bank, bool switchable = true);
+    bool mapRegisters(uint8_t page);
+    void select(int window, unsigned bank);
+    unsigned getBank(int window) const;
+    unsigned getBankCount() const;
+    uint64_t getSwitches() const;
+
+    uint8_t read(uint16_t address) override;
+    void write(uint16_t address, uint8_t data) override;
+    // The bank of each window, four bytes apiece, then for RAM the whole
+    // image, every bank in order.
+    void saveState(std::vector<uint8_t>& out) const override;
+    bool loadState(const uint8_t* data, size_t size) override;
+};
+
+#endif
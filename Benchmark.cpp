@@ -0,0 +1,1299 @@
+#include "Benchmark.h"
+#include "Alu.h"
+#include "BankMapper.h"
+#include "BlockCache.h"
+#include "Bus.h"
+#include "CPU.h"
+#include "DirtyPageTracker.h"
+#include "InstructionFactory.h"
+#include "Jit.h"
+#include "MachineFork.h"
+#include "Memory.h"
+#include "MemoryMap.h"
+#include "ProgramLoader.h"
+#include "Recompiler.h"
+#include "RomImage.h"
+#include "SaveState.h"
+#include "Superinstructions.h"
+#include "TrapRoutines.h"
+#include "Traps.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// The fixture program recompiled; see emitStaticFixture().
+extern const RecompiledProgram staticFixtureProgram;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+void report(const char* label, uint64_t instructions, Clock::duration elapsed) {
+    double seconds = std::chrono::duration<double>(elapsed).count();
+    std::cout << label << ": " << std::dec << instructions << " instructions in "
+              << seconds * 1000.0 << " ms (" << instructions / seconds / 1e6 << " MIPS)" << std::endl;
+}
+
+// Runs step(cpu) config.instructions times on a freshly loaded machine.
+template <typename Step>
+void timeSteps(const char* label, const BenchmarkConfig& config, Step step) {
+    Memory memory;
+    Bus bus(memory);
+    CPU cpu(bus);
+    memory.loadProgram(config.programPath, config.loadAddress);
+    cpu.reset();
+    cpu.setPC(config.startPC);
+
+    auto start = Clock::now();
+    for (uint64_t i = 0; i < config.instructions; i++) {
+        step(cpu);
+    }
+    report(label, config.instructions, Clock::now() - start);
+}
+
+// Mines adjacent opcode sequences from a short run of the same program.
+std::vector<uint16_t> profileSuperinstructions(const BenchmarkConfig& config) {
+    Memory memory;
+    Bus bus(memory);
+    CPU cpu(bus);
+    memory.loadProgram(config.programPath, config.loadAddress);
+    cpu.reset();
+    cpu.setPC(config.startPC);
+
+    SuperinstructionProfile profile;
+    profile.collect(cpu, std::min<uint64_t>(config.instructions, 1000000));
+    profile.print(8);
+    return profile.select(0.001);
+}
+
+// Hands the whole budget to the engine in one run() call, optionally with
+// superinstructions enabled in the block cache, stop conditions to check or
+// another CPU variant.
+void timeEngine(const char* label, const BenchmarkConfig& config, ExecutionEngine engine,
+                const std::vector<uint16_t>& superinstructions = std::vector<uint16_t>(),
+                const StopConditions& conditions = StopConditions(),
+                CpuVariant variant = CpuVariant::NMOS6502) {
+    Memory memory;
+    Bus bus(memory);
+    CPU cpu(bus, variant);
+    memory.loadProgram(config.programPath, config.loadAddress);
+    cpu.reset();
+    cpu.setPC(config.startPC);
+    cpu.setExecutionEngine(engine);
+    if (!superinstructions.empty()) {
+        cpu.getBlockCache()->setSuperinstructions(superinstructions);
+    }
+
+    auto start = Clock::now();
+    RunResult result = cpu.run(config.instructions, conditions);
+    report(label, result.instructions, Clock::now() - start);
+
+    if (cpu.getBlockCache()) {
+        cpu.getBlockCache()->printStats();
+        if (!superinstructions.empty()) {
+            cpu.getBlockCache()->printSuperinstructionStats();
+        }
+    }
+    if (cpu.getJit()) {
+        cpu.getJit()->printStats();
+    }
+}
+
+// Runs the threaded engine over bus, on a freshly loaded program.
+void timeBus(const std::string& label, const BenchmarkConfig& config, Bus& bus, Memory& memory) {
+    CPU cpu(bus);
+    memory.loadProgram(config.programPath, config.loadAddress);
+    cpu.reset();
+    cpu.setPC(config.startPC);
+    cpu.setExecutionEngine(ExecutionEngine::Threaded);
+
+    auto start = Clock::now();
+    RunResult result = cpu.run(config.instructions);
+    report(label.c_str(), result.instructions, Clock::now() - start);
+}
+
+// The same machine decoded through the page table, set up from Map at run
+// time, and through a MappedBus built on it.
+template <typename Map>
+void timeMemoryMap(const char* name, const BenchmarkConfig& config) {
+    {
+        Memory memory;
+        Bus bus(memory);
+        mapRegions(bus, memory, Map::regions, sizeof(Map::regions) / sizeof(MemoryRegion));
+        timeBus(std::string("threaded engine, page table, ") + name, config, bus, memory);
+    }
+    {
+        Memory memory;
+        MappedBus<Map> bus(memory);
+        timeBus(std::string("threaded engine, fixed map, ") + name, config, bus, memory);
+    }
+}
+
+// Bank switching over a 1 MB ROM of 8K banks, four windows of it at $8000:
+// select() called straight, then a loop storing a bank number into a window
+// every fourth instruction, against the same loop storing to RAM. Every
+// switch repoints the window's 32 page table entries.
+void timeBankSwitching(uint64_t instructions) {
+    std::vector<uint8_t> image(1 << 20);
+    for (size_t i = 0; i < image.size(); i++) {
+        image[i] = static_cast<uint8_t>(i >> 13);
+    }
+    {
+        Memory memory;
+        Bus bus(memory);
+        BankMapper mapper(bus, image.data(), image.size(), 0x2000, RegionType::Rom);
+        for (int window = 0; window < 4; window++) {
+            mapper.addWindow(0x8000 + window * 0x2000, window);
+        }
+        const uint64_t count = 10000000;
+        unsigned seen = 0;
+        auto start = Clock::now();
+        for (uint64_t i = 0; i < count; i++) {
+            mapper.select(i & 3, static_cast<unsigned>(i));
+            seen += bus.readMemory(0x8000 + ((i & 3) << 13));
+        }
+        double nanoseconds = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        std::cout << "bank switch, select(): " << nanoseconds / count << " ns per switch (" << seen % 10 << ")"
+                  << std::endl;
+    }
+    for (bool banked : {false, true}) {
+        Memory memory;
+        Bus bus(memory);
+        BankMapper mapper(bus, image.data(), image.size(), 0x2000, RegionType::Rom);
+        mapper.addWindow(0x8000, 0);
+        CPU cpu(bus);
+        // TXA; STA $8000 or $0300; INX; JMP $0200
+        const uint8_t loop[] = {0x8A, 0x8D, 0x00, static_cast<uint8_t>(banked ? 0x80 : 0x03), 0xE8, 0x4C, 0x00, 0x02};
+        for (size_t i = 0; i < sizeof(loop); i++) {
+            bus.writeMemory(0x0200 + i, loop[i]);
+        }
+        cpu.reset();
+        cpu.setPC(0x0200);
+        cpu.setExecutionEngine(ExecutionEngine::Fused);
+
+        auto start = Clock::now();
+        RunResult result = cpu.run(instructions);
+        report(banked ? "fused engine, bank switch loop" : "fused engine, RAM store loop", result.instructions,
+               Clock::now() - start);
+        if (banked) {
+            std::cout << "  " << mapper.getSwitches() << " bank switches" << std::endl;
+        }
+    }
+}
+
+// Many short runs of the program from the same starting state: a fresh
+// machine built and loaded for each, against one put back with
+// resetToBaseline() between runs.
+void timeBaselineResets(const BenchmarkConfig& config, int runs, uint64_t length) {
+    Memory image;
+    image.loadProgram(config.programPath, config.loadAddress);
+
+    auto start = Clock::now();
+    for (int i = 0; i < runs; i++) {
+        Memory memory;
+        memory.writeBlock(0, &image[0], 0x10000);
+        Bus bus(memory);
+        CPU cpu(bus);
+        cpu.reset();
+        cpu.setPC(config.startPC);
+        cpu.run(length);
+    }
+    double fresh = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+    Memory memory;
+    memory.writeBlock(0, &image[0], 0x10000);
+    Bus bus(memory);
+    CPU cpu(bus);
+    cpu.reset();
+    cpu.setPC(config.startPC);
+    DirtyPageTracker tracker(cpu, memory);
+    int dirtyPages = 0;
+    start = Clock::now();
+    for (int i = 0; i < runs; i++) {
+        cpu.run(length);
+        dirtyPages = tracker.getDirtyPageCount();
+        tracker.resetToBaseline();
+    }
+    double tracked = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+    std::cout << "short runs of " << length << " instructions, fresh machine: " << fresh / runs << " us per run"
+              << std::endl;
+    std::cout << "short runs of " << length << " instructions, baseline reset: " << tracked / runs
+              << " us per run, " << dirtyPages << " pages restored" << std::endl;
+}
+
+// A search-style workload: a forked machine runs the program in slices of
+// length instructions and forks after each, keeping every handle, then
+// hops between the handles at random. Times fork() and restore() apart
+// from the running, and totals what the handles hold.
+void timeForks(const BenchmarkConfig& config, int forks, uint64_t length) {
+    Memory memory;
+    memory.loadProgram(config.programPath, config.loadAddress);
+    Bus bus(memory);
+    CPU cpu(bus);
+    cpu.reset();
+    cpu.setPC(config.startPC);
+    ForkedMachine machine(captureMachine(cpu));
+
+    std::vector<SnapshotHandle> handles;
+    handles.reserve(forks);
+    Clock::duration forking{};
+    size_t footprint = 0;
+    for (int i = 0; i < forks; i++) {
+        machine.getCpu().run(length);
+        auto start = Clock::now();
+        handles.push_back(machine.fork());
+        forking += Clock::now() - start;
+        footprint += handles.back()->getFootprint();
+    }
+
+    uint32_t seed = 1;
+    auto start = Clock::now();
+    for (int i = 0; i < forks; i++) {
+        seed = seed * 1103515245 + 12345;
+        machine.restore(handles[(seed >> 8) % handles.size()]);
+    }
+    auto restoring = Clock::now() - start;
+
+    std::cout << "fork every " << length << " instructions: "
+              << std::chrono::duration<double, std::nano>(forking).count() / forks << " ns per fork, "
+              << footprint / forks << " bytes per handle, " << footprint / 1024 << " KB for " << forks << std::endl;
+    std::cout << "restore a random fork: " << std::chrono::duration<double, std::nano>(restoring).count() / forks
+              << " ns" << std::endl;
+}
+
+// Save and restore latency for the functional test part way through, in
+// memory so the disk stays out of it: capturing, then checking the header
+// and checksum and putting the state back, by copy and by attaching the
+// pages.
+void timeSaveStates(const BenchmarkConfig& config, int count) {
+    Memory memory;
+    memory.loadProgram(config.programPath, config.loadAddress);
+    Bus bus(memory);
+    CPU cpu(bus);
+    cpu.reset();
+    cpu.setPC(config.startPC);
+    cpu.run(1000000);
+
+    for (bool compress : {false, true}) {
+        const char* label = compress ? "save state, LZ4" : "save state, uncompressed";
+        SaveState state;
+        auto start = Clock::now();
+        for (int i = 0; i < count; i++) {
+            state.capture(cpu, compress);
+        }
+        double saving = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / count;
+
+        SaveState loaded;
+        start = Clock::now();
+        for (int i = 0; i < count; i++) {
+            loaded.load(state.getData(), state.getSize());
+            loaded.restore(cpu);
+        }
+        double restoring = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / count;
+
+        start = Clock::now();
+        for (int i = 0; i < count; i++) {
+            loaded.load(state.getData(), state.getSize());
+            loaded.attach(cpu);
+        }
+        double attaching = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / count;
+        bus.unmap(0, 256);
+
+        std::cout << label << ": " << state.getSize() << " bytes, save " << saving << " us, load and restore "
+                  << restoring << " us, load and attach " << attaching << " us" << std::endl;
+    }
+}
+
+// Startup cost of the program image, loaded count times into fresh
+// machines: copied into RAM, and mapped read-only over the top of the
+// address space.
+void timeImageLoads(const BenchmarkConfig& config, int count) {
+    double copied = 0;
+    double mapped = 0;
+    size_t resident = 0;
+    for (int i = 0; i < count; i++) {
+        Memory memory;
+        copied += loadRamImage(memory, config.programPath, config.loadAddress).milliseconds;
+
+        Bus bus(memory);
+        RomImage rom;
+        auto start = Clock::now();
+        if (rom.open(config.programPath) && rom.getSize() <= 0x10000 && !(rom.getSize() & 0xFF)) {
+            rom.attach(bus, (0x10000 - rom.getSize()) & 0xFF00);
+        }
+        mapped += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        resident = rom.getStats().residentBytes;
+    }
+    std::cout << "image load, RAM copy: " << copied * 1000.0 / count << " us per load" << std::endl;
+    std::cout << "image load, ROM mapping: " << mapped * 1000.0 / count << " us per load, "
+              << resident / 1024 << " KB resident" << std::endl;
+}
+
+// Builds a text image covering the whole address space passes times over,
+// in 32-byte data records, so the parse is timed on a multi-megabyte file
+// from memory rather than on the disk.
+std::string makeTextImage(ProgramFormat format, int passes) {
+    static const char digits[] = "0123456789ABCDEF";
+    std::string text;
+    auto put = [&](uint8_t byte, uint8_t& sum) {
+        text += digits[byte >> 4];
+        text += digits[byte & 0xF];
+        sum += byte;
+    };
+    for (int pass = 0; pass < passes; pass++) {
+        for (uint32_t address = 0; address < 0x10000; address += 32) {
+            uint8_t sum = 0;
+            if (format == ProgramFormat::IntelHex) {
+                text += ':';
+                put(32, sum);
+            } else {
+                text += "S1";
+                put(32 + 3, sum);
+            }
+            put(address >> 8, sum);
+            put(address & 0xFF, sum);
+            if (format == ProgramFormat::IntelHex) {
+                put(0x00, sum);
+            }
+            for (uint32_t i = 0; i < 32; i++) {
+                put(static_cast<uint8_t>((address + i) * 7 + pass), sum);
+            }
+            uint8_t check = format == ProgramFormat::IntelHex ? -sum : ~sum;
+            put(check, sum);
+            text += "\r\n";
+        }
+    }
+    text += format == ProgramFormat::IntelHex ? ":0400000500000400F3\r\n:00000001FF\r\n" : "S9030400F8\r\n";
+    return text;
+}
+
+void timeProgramParse(ProgramFormat format, int passes, int count) {
+    std::istringstream in(makeTextImage(format, passes));
+    size_t size = in.str().size();
+    Memory memory;
+    ProgramLoader loader(memory);
+    double best = 0;
+    for (int i = 0; i < count; i++) {
+        in.clear();
+        in.seekg(0);
+        if (!loader.load(in, format, 0)) {
+            std::cout << "loader, " << programFormatName(format) << ": " << loader.getError() << std::endl;
+            return;
+        }
+        double milliseconds = loader.getProgram().milliseconds;
+        best = i == 0 ? milliseconds : std::min(best, milliseconds);
+    }
+    const LoadedProgram& program = loader.getProgram();
+    std::cout << "loader, " << programFormatName(format) << ": " << size / 1000000.0 << " MB in " << best
+              << " ms (" << size / 1000.0 / best << " MB/s), " << program.bytes << " bytes in " << program.segments
+              << " segments" << std::endl;
+}
+
+// A timer workload: the budget runs in slices of period instructions, and
+// with pulse set an NMI is raised between slices. The handler at $FF00 is a
+// bare RTI. Slicing without pulses gives the baseline, so the difference is
+// the cost of taking the interrupts; the fast path between them only ever
+// sees a zero pending word.
+void timeInterrupts(const char* label, const BenchmarkConfig& config, ExecutionEngine engine,
+                    uint64_t period, bool pulse) {
+    Memory memory;
+    Bus bus(memory);
+    CPU cpu(bus);
+    memory.loadProgram(config.programPath, config.loadAddress);
+    bus.writeMemory(0xFF00, 0x40);
+    bus.writeMemory(0xFFFA, 0x00);
+    bus.writeMemory(0xFFFB, 0xFF);
+    cpu.reset();
+    cpu.setPC(config.startPC);
+    cpu.setExecutionEngine(engine);
+
+    uint64_t interrupts = 0;
+    auto start = Clock::now();
+    for (uint64_t done = 0; done < config.instructions; done += period) {
+        if (pulse) {
+            cpu.setNmiLine(true);
+            cpu.setNmiLine(false);
+            interrupts++;
+        }
+        cpu.run(std::min(period, config.instructions - done));
+    }
+    report(label, config.instructions, Clock::now() - start);
+    if (pulse) {
+        std::cout << "  " << interrupts << " NMIs taken" << std::endl;
+    }
+}
+
+// Chains count decimal ADCs through either the NMOS lookup table or the
+// computed form, with operands drawn from the low operandBits bits of a
+// generator: a few bits keep the table's working set to a few cache lines,
+// eight spread it over all 256 KB.
+template <bool Lookup>
+void timeAlu(const char* label, uint64_t count, unsigned operandBits) {
+    const AluResult* table = getAluTables(CpuVariant::NMOS6502).adc[1];
+    uint8_t mask = (1u << operandBits) - 1;
+    uint32_t generator = 1;
+    AluResult result = {0, 0};
+    uint32_t flagSum = 0;
+
+    auto start = Clock::now();
+    for (uint64_t i = 0; i < count; i++) {
+        generator = generator * 1664525u + 1013904223u;
+        uint8_t operand = (generator >> 24) & mask;
+        uint8_t accumulator = result.value & (mask | 0x80);
+        bool carry = result.flags & FLAG_C;
+        if (Lookup) {
+            result = table[aluIndex(carry, accumulator, operand)];
+        } else {
+            result = computeAdc<NMOS6502>(true, carry, accumulator, operand);
+        }
+        flagSum += result.flags;
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    std::cout << label << ": " << count << " decimal ADCs in " << seconds * 1000.0 << " ms ("
+              << count / seconds / 1e6 << " M/s, flag sum " << flagSum << ")" << std::endl;
+}
+
+// A machine in the differential check: random memory and registers from
+// the trace's seed, identical for the reference and every engine.
+struct VerifyMachine {
+    const char* name;
+    Memory memory;
+    Bus bus;
+    CPU cpu;
+    bool failed;
+
+    VerifyMachine(const char* name, uint32_t seed) : name(name), bus(memory), cpu(bus), failed(false) {
+        std::mt19937 random(seed);
+        for (uint32_t address = 0; address < 0x10000; address++) {
+            memory[address] = static_cast<uint8_t>(random());
+        }
+        CpuRegisters registers{};
+        registers.PC = static_cast<uint16_t>(random());
+        registers.A = static_cast<uint8_t>(random());
+        registers.X = static_cast<uint8_t>(random());
+        registers.Y = static_cast<uint8_t>(random());
+        registers.SP = static_cast<uint8_t>(random());
+        registers.P = static_cast<uint8_t>(random());
+        cpu.setRegisters(registers);
+    }
+};
+
+bool sameRegisters(const CpuRegisters& a, const CpuRegisters& b) {
+    return a.PC == b.PC && a.A == b.A && a.X == b.X && a.Y == b.Y && a.SP == b.SP && a.P == b.P &&
+           a.cycles == b.cycles;
+}
+
+void reportDifference(uint32_t seed, const VerifyMachine& machine, uint64_t executed, const std::string& what) {
+    std::cout << "trace " << std::dec << seed << ", " << machine.name << " engine: " << what << " after "
+              << executed << " instructions" << std::endl;
+}
+
+// One decimal-mode table entry against plain BCD arithmetic on two-digit
+// numbers; prints and returns false on a difference. Z and N follow the
+// result on CMOS parts, and Z the binary result on NMOS ones, whose N and
+// V are left out.
+bool checkDecimal(const char* name, bool cmos, const char* operation, bool carry, unsigned a, unsigned b,
+                  const AluResult& actual, unsigned value, bool carryOut, uint8_t binaryValue) {
+    uint8_t bcd = static_cast<uint8_t>((value / 10) << 4 | value % 10);
+    uint8_t flags = carryOut ? FLAG_C : 0;
+    uint8_t zero = cmos ? bcd : binaryValue;
+    flags |= (zero == 0 ? FLAG_Z : 0) | (cmos ? bcd & FLAG_N : 0);
+    uint8_t checked = FLAG_C | FLAG_Z | (cmos ? FLAG_N : 0);
+    if (actual.value == bcd && (actual.flags & checked) == flags) {
+        return true;
+    }
+    std::cout << std::hex << name << " decimal " << operation << " " << (a / 10 << 4 | a % 10) << ", "
+              << (b / 10 << 4 | b % 10) << ", carry " << carry << ": " << int(actual.value) << " flags "
+              << int(actual.flags & checked) << ", expected " << int(bcd) << " flags " << int(flags) << std::dec
+              << std::endl;
+    return false;
+}
+
+std::string describeRegisters(const CpuRegisters& registers) {
+    std::ostringstream out;
+    out << std::hex << "PC=" << registers.PC << " A=" << int(registers.A) << " X=" << int(registers.X)
+        << " Y=" << int(registers.Y) << " SP=" << int(registers.SP) << " P=" << int(registers.P) << std::dec
+        << " cycles=" << registers.cycles;
+    return out.str();
+}
+
+const uint16_t TRAP_DRIVER = 0x0200;
+const uint16_t MEMCPY_ADDRESS = 0x0300;
+const uint16_t MULTIPLY_ADDRESS = 0x0340;
+
+// Random memory with the trap routines at $0300 and $0340 and a driver at
+// $0200 that calls one of them and stops in a JMP * at $0203. With trapped
+// set the registry stands in for the 6502 code, in verify mode checking
+// every call against it.
+struct TrapMachine {
+    Memory memory;
+    Bus bus;
+    CPU cpu;
+    TrapRegistry traps;
+
+    TrapMachine(uint32_t seed, bool trapped, bool verify) : bus(memory), cpu(bus), traps(bus) {
+        std::mt19937 random(seed);
+        for (uint32_t address = 0; address < 0x10000; address++) {
+            memory[address] = static_cast<uint8_t>(random());
+        }
+        const uint8_t driver[] = {0x20, 0x00, 0x00, 0x4C, 0x03, 0x02};
+        for (uint16_t i = 0; i < sizeof(driver); i++) {
+            bus.writeMemory(TRAP_DRIVER + i, driver[i]);
+        }
+        placeTrapRoutine(bus, MEMCPY_ADDRESS, memcpyRoutine);
+        placeTrapRoutine(bus, MULTIPLY_ADDRESS, multiplyRoutine);
+        if (trapped) {
+            traps.install(MEMCPY_ADDRESS, memcpyRoutine.name, memcpyRoutine.native);
+            traps.install(MULTIPLY_ADDRESS, multiplyRoutine.name, multiplyRoutine.native);
+            traps.setVerify(verify);
+            cpu.setTrapRegistry(&traps);
+        }
+        cpu.setSP(0xFD);
+    }
+
+    void setWord(uint16_t address, uint16_t value) {
+        bus.writeMemory(address, value & 0xFF);
+        bus.writeMemory(address + 1, value >> 8);
+    }
+
+    void call(uint16_t routine) {
+        setWord(TRAP_DRIVER + 1, routine);
+        cpu.setPC(TRAP_DRIVER);
+        while (cpu.getPC() != TRAP_DRIVER + 3) {
+            cpu.execute();
+        }
+    }
+};
+
+// The same call made count times through the 6502 code and then through
+// its trap, on one machine each.
+template <typename Setup>
+void timeTrap(const char* label, uint16_t routine, int count, Setup setup) {
+    for (bool trapped : {false, true}) {
+        TrapMachine machine(1, trapped, false);
+        uint64_t cycles = machine.cpu.getCycles();
+        auto start = Clock::now();
+        for (int i = 0; i < count; i++) {
+            setup(machine);
+            machine.call(routine);
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        std::cout << label << (trapped ? ", trapped: " : ", 6502 code: ") << count << " calls in "
+                  << seconds * 1000.0 << " ms (" << seconds * 1e9 / count << " ns per call, "
+                  << (machine.cpu.getCycles() - cycles) / count << " cycles)" << std::endl;
+    }
+}
+
+
+const uint16_t FIXTURE_LOOP = 0x0205;
+const uint16_t FIXTURE_HALT = 0x027B;
+
+// The Static engine's fixture, recompiled into StaticFixture.cpp. The
+// driver copies and multiplies with the trap routines, rewrites an
+// immediate on page 5, adds in decimal mode, jumps through a table and
+// through BRK, and every eighth pass waits in an idle loop for an NMI. It
+// halts after 64 passes. IRQ is left to the harness, masked throughout.
+const uint8_t fixtureDriver[] = {
+    0x78,               // 0200 start:   SEI
+    0xD8,               // 0201          CLD
+    0xA2, 0xFF,         // 0202          LDX #$FF
+    0x9A,               // 0204          TXS
+    0xA9, 0x00,         // 0205 loop:    LDA #$00
+    0x85, 0xF0,         // 0207          STA $F0
+    0xA9, 0x03,         // 0209          LDA #$03
+    0x85, 0xF1,         // 020B          STA $F1
+    0xA9, 0x00,         // 020D          LDA #$00
+    0x85, 0xF2,         // 020F          STA $F2
+    0xA5, 0x10,         // 0211          LDA $10
+    0x29, 0x0F,         // 0213          AND #$0F
+    0x09, 0x10,         // 0215          ORA #$10
+    0x85, 0xF3,         // 0217          STA $F3
+    0xA5, 0x10,         // 0219          LDA $10
+    0x85, 0xF4,         // 021B          STA $F4
+    0xA9, 0x00,         // 021D          LDA #$00
+    0x85, 0xF5,         // 021F          STA $F5
+    0x20, 0x00, 0x03,   // 0221          JSR memcpy
+    0xA5, 0x10,         // 0224          LDA $10
+    0x85, 0xF0,         // 0226          STA $F0
+    0xA9, 0xA5,         // 0228          LDA #$A5
+    0x85, 0xF1,         // 022A          STA $F1
+    0xA5, 0xF4,         // 022C          LDA $F4
+    0x49, 0x5A,         // 022E          EOR #$5A
+    0x85, 0xF2,         // 0230          STA $F2
+    0xA9, 0x03,         // 0232          LDA #$03
+    0x85, 0xF3,         // 0234          STA $F3
+    0x20, 0x40, 0x03,   // 0236          JSR multiply
+    0xA5, 0xF5,         // 0239          LDA $F5
+    0x20, 0x00, 0x05,   // 023B          JSR patched
+    0xF8,               // 023E          SED
+    0x18,               // 023F          CLC
+    0x65, 0x10,         // 0240          ADC $10
+    0xD8,               // 0242          CLD
+    0x85, 0x12,         // 0243          STA $12
+    0xA5, 0x10,         // 0245          LDA $10
+    0x29, 0x01,         // 0247          AND #$01
+    0x0A,               // 0249          ASL A
+    0xAA,               // 024A          TAX
+    0xBD, 0x7E, 0x02,   // 024B          LDA table,X
+    0x85, 0x14,         // 024E          STA $14
+    0xBD, 0x7F, 0x02,   // 0250          LDA table+1,X
+    0x85, 0x15,         // 0253          STA $15
+    0x6C, 0x14, 0x00,   // 0255          JMP ($0014)
+    0xE6, 0x10,         // 0258 even:    INC $10
+    0x4C, 0x61, 0x02,   // 025A          JMP next
+    0xE6, 0x10,         // 025D odd:     INC $10
+    0x00,               // 025F          BRK
+    0xEA,               // 0260          NOP
+    0xA5, 0x10,         // 0261 next:    LDA $10
+    0x29, 0x07,         // 0263          AND #$07
+    0xF0, 0x03,         // 0265          BEQ idle
+    0x4C, 0x05, 0x02,   // 0267          JMP loop
+    0xA9, 0x00,         // 026A idle:    LDA #$00
+    0x85, 0x11,         // 026C          STA $11
+    0xA5, 0x11,         // 026E wait:    LDA $11
+    0xF0, 0xFC,         // 0270          BEQ wait
+    0xA5, 0x10,         // 0272          LDA $10
+    0xC9, 0x40,         // 0274          CMP #$40
+    0xF0, 0x03,         // 0276          BEQ halt
+    0x4C, 0x05, 0x02,   // 0278          JMP loop
+    0x4C, 0x7B, 0x02,   // 027B halt:    JMP halt
+    0x58, 0x02,         // 027E table:   .word even
+    0x5D, 0x02,         //               .word odd
+};
+const uint8_t fixtureNmi[] = {
+    0xE6, 0x11,         // 0400 nmi:     INC $11
+    0x40,               // 0402          RTI
+};
+const uint8_t fixtureBrk[] = {
+    0x40,               // 0410 brk:     RTI
+};
+const uint8_t fixturePatched[] = {
+    0x8D, 0x04, 0x05,   // 0500 patched: STA patch+1
+    0xA9, 0x00,         // 0503 patch:   LDA #$00
+    0x60,               // 0505          RTS
+};
+
+void loadStaticFixture(Bus& bus) {
+    const struct { uint16_t address; const uint8_t* code; uint16_t length; } parts[] = {
+        {0x0200, fixtureDriver, sizeof(fixtureDriver)}, {0x0400, fixtureNmi, sizeof(fixtureNmi)},
+        {0x0410, fixtureBrk, sizeof(fixtureBrk)}, {0x0500, fixturePatched, sizeof(fixturePatched)},
+    };
+    for (const auto& part : parts) {
+        for (uint16_t i = 0; i < part.length; i++) {
+            bus.writeMemory(part.address + i, part.code[i]);
+        }
+    }
+    placeTrapRoutine(bus, MEMCPY_ADDRESS, memcpyRoutine);
+    placeTrapRoutine(bus, MULTIPLY_ADDRESS, multiplyRoutine);
+    const uint16_t vectors[] = {0x0400, 0x0200, 0x0410};
+    for (int i = 0; i < 3; i++) {
+        bus.writeMemory(0xFFFA + 2 * i, vectors[i] & 0xFF);
+        bus.writeMemory(0xFFFB + 2 * i, vectors[i] >> 8);
+    }
+}
+
+// A machine in the Static engine's check, running the fixture from reset
+// with IRQ asserted.
+struct FixtureMachine {
+    Memory memory;
+    Bus bus;
+    CPU cpu;
+
+    explicit FixtureMachine(ExecutionEngine engine) : bus(memory), cpu(bus) {
+        loadStaticFixture(bus);
+        cpu.reset();
+        cpu.setExecutionEngine(engine);
+        cpu.setIrqLine(true);
+    }
+};
+
+// Stop conditions for one run of the fixture, empty one time in four.
+StopConditions randomConditions(std::mt19937& random, uint64_t cycles) {
+    StopConditions conditions;
+    if (random() % 4 == 0) {
+        return conditions;
+    }
+    for (uint32_t i = random() % 3; i > 0; i--) {
+        conditions.breakpoints.push_back(static_cast<uint16_t>(0x0200 + random() % 0x0340));
+    }
+    if (random() % 3 == 0) {
+        // Zero page, the stack or the memcpy destination.
+        static const std::pair<uint16_t, uint16_t> areas[] = {{0x0010, 0x0015}, {0x00F0, 0x00F7}, {0x0100, 0x01FF}, {0x1000, 0x1FFF}};
+        const auto& area = areas[random() % 4];
+        uint16_t first = area.first + random() % (area.second - area.first + 1);
+        conditions.writeTriggers.push_back(std::make_pair(first, std::min<uint16_t>(area.second, first + random() % 16)));
+    }
+    conditions.stopOnHalt = random() % 2;
+    conditions.idleAction = static_cast<IdleAction>(random() % 3);
+    if (random() % 3 == 0) {
+        conditions.cycleDeadline = cycles + random() % 20000;
+    }
+    return conditions;
+}
+
+std::string describeResult(const RunResult& result) {
+    std::ostringstream out;
+    out << stopReasonName(result.reason) << " after " << result.instructions << " instructions at " << std::hex
+        << result.address << std::dec << ", " << result.idleInstructions << " idle";
+    return out.str();
+}
+
+// Every region type and both kinds of mirroring in one map, for the
+// MappedBus check: 2K of RAM repeated through $0000-$1FFF, a device page,
+// RAM and 16K of ROM seen twice. Runtime keeps the threaded engine on the
+// page table, so only the bus side of it is checked.
+struct MirroredMap {
+    static constexpr MachineMap id = MachineMap::Runtime;
+    static constexpr MemoryRegion regions[] = {
+        {0x0000, 0x1FFF, RegionType::Ram, 0x0800},
+        {0x8000, 0xFFFF, RegionType::Rom, 0x4000},
+        {0x2000, 0x20FF, RegionType::Device, 0x0100},
+        {0x2100, 0x7FFF, RegionType::Ram, 0x10000},
+    };
+};
+
+// Answers reads with a function of the address and logs writes, so two
+// buses can be compared on what reached their devices.
+struct RecordingDevice : Device {
+    std::vector<std::pair<uint16_t, uint8_t>> writes;
+
+    uint8_t read(uint16_t address) override { return static_cast<uint8_t>(address * 7 ^ address >> 8); }
+    void write(uint16_t address, uint8_t data) override { writes.push_back(std::make_pair(address, data)); }
+};
+
+struct RecordingWatcher : WriteWatcher {
+    std::vector<uint16_t> writes;
+
+    void onWatchedWrite(uint16_t address) override { writes.push_back(address); }
+};
+
+// A random address, half the time within two bytes of a region's start,
+// end or one of its mirror boundaries.
+uint16_t regionEdge(std::mt19937& random, const MemoryRegion* regions, size_t count) {
+    if (random() % 2) {
+        return static_cast<uint16_t>(random());
+    }
+    const MemoryRegion& region = regions[random() % count];
+    uint32_t span = region.end - region.start + 1;
+    uint32_t step = region.type == RegionType::Device ? span : std::min(span, region.size);
+    return static_cast<uint16_t>(region.start + random() % (span / step + 1) * step + random() % 5 - 2);
+}
+
+// MappedBus<Map> against a plain Bus set up from the same regions with
+// mapRegions(), on identical random memory with a RecordingDevice on the
+// Device regions and every eighth page watched. Random reads and writes
+// must read the same, reach the devices and watchers the same and leave
+// the same memory, with the ROM untouched. Then, for maps an engine is
+// instantiated on, the threaded engine on the MappedBus runs traces from
+// random registers in lockstep with the interpreter on the page table.
+// Returns 1 and prints the first difference, or 0.
+template <typename Map>
+int verifyMemoryMap(const char* name, int accesses, int traces, uint64_t instructions) {
+    const size_t count = sizeof(Map::regions) / sizeof(MemoryRegion);
+    std::mt19937 random(0x6502);
+    Memory pagedMemory;
+    Memory fixedMemory;
+    std::vector<uint8_t> initial(0x10000);
+    for (uint32_t address = 0; address < 0x10000; address++) {
+        initial[address] = static_cast<uint8_t>(random());
+        pagedMemory[address] = fixedMemory[address] = initial[address];
+    }
+    Bus paged(pagedMemory);
+    mapRegions(paged, pagedMemory, Map::regions, count);
+    MappedBus<Map> fixed(fixedMemory);
+    RecordingDevice pagedDevice;
+    RecordingDevice fixedDevice;
+    for (const MemoryRegion& region : Map::regions) {
+        if (region.type == RegionType::Device) {
+            paged.mapDevice(region.start >> 8, ((region.end - region.start) >> 8) + 1, &pagedDevice);
+        }
+    }
+    fixed.attachDevice(&fixedDevice);
+    RecordingWatcher pagedWatcher;
+    RecordingWatcher fixedWatcher;
+    int pagedSlot = paged.addWriteWatcher(&pagedWatcher);
+    int fixedSlot = fixed.addWriteWatcher(&fixedWatcher);
+    for (int page = 0; page < 256; page += 8) {
+        paged.watchPage(pagedSlot, page, true);
+        fixed.watchPage(fixedSlot, page, true);
+    }
+
+    auto fail = [name](const std::string& what) {
+        std::cout << "verify: " << name << " map: " << what << std::endl;
+        return 1;
+    };
+    for (int i = 0; i < accesses; i++) {
+        uint16_t address = regionEdge(random, Map::regions, count);
+        if (random() % 2) {
+            uint8_t data = static_cast<uint8_t>(random());
+            paged.writeMemory(address, data);
+            fixed.writeMemory(address, data);
+            continue;
+        }
+        uint8_t expected = paged.readMemory(address);
+        uint8_t actual = fixed.readMemory(address);
+        if (actual != expected) {
+            std::ostringstream what;
+            what << "read of " << std::hex << address << " gave " << int(actual) << ", page table " << int(expected);
+            return fail(what.str());
+        }
+    }
+    if (fixedDevice.writes != pagedDevice.writes) {
+        return fail("device writes differ from the page table's");
+    }
+    if (fixedWatcher.writes != pagedWatcher.writes) {
+        return fail("watched writes differ from the page table's");
+    }
+    paged.removeWriteWatcher(pagedSlot);
+    fixed.removeWriteWatcher(fixedSlot);
+
+    if (Map::id != MachineMap::Runtime) {
+        CPU reference(paged);
+        CPU threaded(fixed);
+        threaded.setExecutionEngine(ExecutionEngine::Threaded);
+        std::streambuf* output = std::cout.rdbuf(nullptr);
+        std::string difference;
+        for (int trace = 0; trace < traces && difference.empty(); trace++) {
+            CpuRegisters registers{};
+            registers.PC = static_cast<uint16_t>(random());
+            registers.A = static_cast<uint8_t>(random());
+            registers.X = static_cast<uint8_t>(random());
+            registers.Y = static_cast<uint8_t>(random());
+            registers.SP = static_cast<uint8_t>(random());
+            registers.P = static_cast<uint8_t>(random());
+            reference.setRegisters(registers);
+            threaded.setRegisters(registers);
+            for (uint64_t executed = 0; executed < instructions;) {
+                uint64_t chunk = std::min<uint64_t>(1 + random() % 64, instructions - executed);
+                for (uint64_t i = 0; i < chunk; i++) {
+                    reference.execute();
+                }
+                threaded.executeInstructions(chunk);
+                executed += chunk;
+                if (!sameRegisters(threaded.getRegisters(), reference.getRegisters())) {
+                    std::ostringstream what;
+                    what << "threaded engine in trace " << trace << " has "
+                         << describeRegisters(threaded.getRegisters()) << ", interpreter "
+                         << describeRegisters(reference.getRegisters()) << " after " << executed << " instructions";
+                    difference = what.str();
+                    break;
+                }
+            }
+        }
+        std::cout.rdbuf(output);
+        std::cout.clear();
+        if (!difference.empty()) {
+            return fail(difference);
+        }
+    }
+
+    for (uint32_t address = 0; address < 0x10000; address++) {
+        if (fixedMemory[address] != pagedMemory[address]) {
+            std::ostringstream what;
+            what << "memory at " << std::hex << address << " is " << int(fixedMemory[address]) << ", page table "
+                 << int(pagedMemory[address]);
+            return fail(what.str());
+        }
+    }
+    for (const MemoryRegion& region : Map::regions) {
+        if (region.type != RegionType::Rom) {
+            continue;
+        }
+        for (uint32_t address = region.start; address < region.start + region.size; address++) {
+            if (fixedMemory[address] != initial[address]) {
+                std::ostringstream what;
+                what << "ROM at " << std::hex << address << " was written";
+                return fail(what.str());
+            }
+        }
+    }
+    return 0;
+}
+
+}
+
+void benchmarkDispatch(const BenchmarkConfig& config) {
+    InstructionFactory* factory = InstructionFactory::getInstance();
+    const DispatchEntry* dispatchTable = factory->getDispatchTable();
+
+    // The original execute(): hash lookup, RTTI and one new/delete per step.
+    timeSteps("createInstruction", config, [factory](CPU& cpu) {
+        uint8_t opcode = cpu.fetch();
+        Instruction* instruction = factory->createInstruction(opcode);
+        if (instruction) {
+            instruction->execute(cpu);
+            delete instruction;
+        }
+    });
+
+    // Table lookup but still two virtual calls through the class hierarchy.
+    timeSteps("virtual dispatch table", config, [dispatchTable](CPU& cpu) {
+        const DispatchEntry& entry = dispatchTable[cpu.fetch()];
+        cpu.addCycles(entry.cycles);
+        if (entry.accumulatorOperation) {
+            (*entry.accumulatorOperation)(cpu);
+        } else if (entry.operation) {
+            uint16_t effectiveAddress = (*entry.addressingMode)(cpu);
+            (*entry.operation)(cpu, effectiveAddress);
+        }
+    });
+
+    timeSteps("fused handlers", config, [](CPU& cpu) {
+        cpu.execute();
+    });
+
+    timeEngine("fused engine", config, ExecutionEngine::Fused);
+    timeEngine("threaded engine", config, ExecutionEngine::Threaded);
+    timeEngine("block cache engine", config, ExecutionEngine::Cached);
+    timeEngine("block cache + superinstructions", config, ExecutionEngine::Cached, profileSuperinstructions(config));
+    if (Jit::isSupported()) {
+        timeEngine("jit engine", config, ExecutionEngine::Jit);
+    }
+    timeEngine("cycle-stepped engine", config, ExecutionEngine::Cycle);
+    // Only when a program recompiled with --recompile is linked in; it is
+    // meant for the program it was generated from.
+    if (const RecompiledProgram* program = findRecompiledProgram()) {
+        std::cout << "Recompiled program: " << program->name << std::endl;
+        timeEngine("static recompiled", config, ExecutionEngine::Static);
+    }
+
+    // Each variant has its own generated table, so these should match the
+    // NMOS fused engine.
+    timeEngine("fused engine, 65C02", config, ExecutionEngine::Fused, std::vector<uint16_t>(), StopConditions(), CpuVariant::WDC65C02);
+    timeEngine("fused engine, 2A03", config, ExecutionEngine::Fused, std::vector<uint16_t>(), StopConditions(), CpuVariant::Ricoh2A03);
+
+    // Conditions that never fire, to show what checking them costs.
+    StopConditions unreachable;
+    unreachable.breakpoints.push_back(0xFFF0);
+    unreachable.writeTriggers.push_back(std::make_pair<uint16_t, uint16_t>(0xFF00, 0xFF0F));
+    unreachable.stopOnHalt = true;
+
+    timeEngine("fused engine, checked run", config, ExecutionEngine::Fused, std::vector<uint16_t>(), unreachable);
+    timeEngine("threaded engine, checked run", config, ExecutionEngine::Threaded, std::vector<uint16_t>(), unreachable);
+    timeEngine("block cache engine, checked run", config, ExecutionEngine::Cached, std::vector<uint16_t>(), unreachable);
+    if (Jit::isSupported()) {
+        timeEngine("jit engine, checked run", config, ExecutionEngine::Jit, std::vector<uint16_t>(), unreachable);
+    }
+
+    // The same engines driven by a 1000-instruction timer, with and
+    // without the NMI.
+    const uint64_t timerPeriod = 1000;
+    timeInterrupts("fused engine, timer slices", config, ExecutionEngine::Fused, timerPeriod, false);
+    timeInterrupts("fused engine, timer NMIs", config, ExecutionEngine::Fused, timerPeriod, true);
+    timeInterrupts("threaded engine, timer slices", config, ExecutionEngine::Threaded, timerPeriod, false);
+    timeInterrupts("threaded engine, timer NMIs", config, ExecutionEngine::Threaded, timerPeriod, true);
+    timeInterrupts("block cache engine, timer slices", config, ExecutionEngine::Cached, timerPeriod, false);
+    timeInterrupts("block cache engine, timer NMIs", config, ExecutionEngine::Cached, timerPeriod, true);
+    if (Jit::isSupported()) {
+        timeInterrupts("jit engine, timer slices", config, ExecutionEngine::Jit, timerPeriod, false);
+        timeInterrupts("jit engine, timer NMIs", config, ExecutionEngine::Jit, timerPeriod, true);
+    }
+
+    timeImageLoads(config, 1000);
+    timeProgramParse(ProgramFormat::IntelHex, 32, 10);
+    timeProgramParse(ProgramFormat::SRecord, 32, 10);
+    timeBankSwitching(config.instructions);
+    timeBaselineResets(config, 100000, 100);
+    timeForks(config, 10000, 1000);
+    timeSaveStates(config, 1000);
+
+    // Native routines against the 6502 code they stand in for.
+    timeTrap("memcpy of 1 KB", MEMCPY_ADDRESS, 2000, [](TrapMachine& machine) {
+        machine.setWord(0xF0, 0x1000);
+        machine.setWord(0xF2, 0x6000);
+        machine.setWord(0xF4, 0x0400);
+    });
+    timeTrap("16 x 16 bit multiply", MULTIPLY_ADDRESS, 200000, [](TrapMachine& machine) {
+        machine.setWord(0xF0, 0xBEEF);
+        machine.setWord(0xF2, 0x1234);
+    });
+
+    // Runtime against compile-time address decode.
+    timeMemoryMap<FlatRamMap>("flat RAM", config);
+    timeMemoryMap<MonitorRomMap>("monitor ROM", config);
+
+    // Lookup against computed ADC, inside and outside the data cache.
+    std::cout << "ALU table: " << sizeof(AluResult) * 0x20000 / 1024 << " KB per operation and mode" << std::endl;
+    timeAlu<true>("ALU lookup, 2-bit operands", config.instructions, 2);
+    timeAlu<false>("ALU computed, 2-bit operands", config.instructions, 2);
+    timeAlu<true>("ALU lookup, 8-bit operands", config.instructions, 8);
+    timeAlu<false>("ALU computed, 8-bit operands", config.instructions, 8);
+}
+
+// Each engine runs in lockstep with the interpreter, execute() one
+// instruction at a time, in chunks of random length so the block engines
+// are stopped mid-block. Registers and cycles are compared after every
+// chunk and memory at the end. The JIT translates blocks on their second
+// entry, so short traces still reach native code. Guests hit invalid
+// opcodes constantly, so the run keeps std::cout to itself.
+int verifyEngines(int traces, uint64_t instructions) {
+    static const std::pair<ExecutionEngine, const char*> engines[] = {
+        {ExecutionEngine::Fused, "fused"}, {ExecutionEngine::Threaded, "threaded"},
+        {ExecutionEngine::Cached, "cached"}, {ExecutionEngine::Jit, "jit"}, {ExecutionEngine::Cycle, "cycle"},
+    };
+    int differing = 0;
+    for (int trace = 0; trace < traces; trace++) {
+        uint32_t seed = static_cast<uint32_t>(trace);
+        std::unique_ptr<VerifyMachine> reference(new VerifyMachine("interpreter", seed));
+        std::vector<std::unique_ptr<VerifyMachine>> machines;
+        for (const auto& engine : engines) {
+            machines.emplace_back(new VerifyMachine(engine.second, seed));
+            CPU& cpu = machines.back()->cpu;
+            cpu.setExecutionEngine(engine.first);
+            if (cpu.getJit()) {
+                cpu.getJit()->setHotThreshold(2);
+            }
+        }
+
+        std::mt19937 chunks(seed ^ 0x9E3779B9u);
+        std::streambuf* output = std::cout.rdbuf(nullptr);
+        for (uint64_t executed = 0; executed < instructions;) {
+            uint64_t chunk = std::min<uint64_t>(1 + chunks() % 64, instructions - executed);
+            for (uint64_t i = 0; i < chunk; i++) {
+                reference->cpu.execute();
+            }
+            executed += chunk;
+            CpuRegisters expected = reference->cpu.getRegisters();
+            for (auto& machine : machines) {
+                if (machine->failed) {
+                    continue;
+                }
+                machine->cpu.executeInstructions(chunk);
+                CpuRegisters actual = machine->cpu.getRegisters();
+                if (!sameRegisters(expected, actual)) {
+                    machine->failed = true;
+                    std::cout.rdbuf(output);
+                    std::cout.clear();
+                    reportDifference(seed, *machine, executed,
+                                     describeRegisters(actual) + ", interpreter " + describeRegisters(expected));
+                    std::cout.rdbuf(nullptr);
+                }
+            }
+        }
+        std::cout.rdbuf(output);
+        std::cout.clear();
+
+        for (auto& machine : machines) {
+            if (machine->failed) {
+                continue;
+            }
+            for (uint32_t address = 0; address < 0x10000; address++) {
+                if (machine->memory[address] != reference->memory[address]) {
+                    machine->failed = true;
+                    std::ostringstream what;
+                    what << "memory at " << std::hex << address << " is " << int(machine->memory[address])
+                         << ", interpreter " << int(reference->memory[address]);
+                    reportDifference(seed, *machine, instructions, what.str());
+                    break;
+                }
+            }
+        }
+        differing += std::any_of(machines.begin(), machines.end(),
+                                 [](const std::unique_ptr<VerifyMachine>& machine) { return machine->failed; });
+    }
+    std::cout << std::dec << "verify: " << traces << " traces of " << instructions << " instructions, "
+              << differing << " with differences" << std::endl;
+    return differing;
+}
+
+// Every pair of two-digit BCD operands and carry in, through the tables
+// the engines use.
+int verifyDecimalMode() {
+    static const std::pair<CpuVariant, const char*> variants[] = {
+        {CpuVariant::NMOS6502, "6502"}, {CpuVariant::WDC65C02, "65C02"},
+    };
+    int mismatches = 0;
+    for (const auto& variant : variants) {
+        const AluTables& tables = getAluTables(variant.first);
+        bool cmos = variant.first == CpuVariant::WDC65C02;
+        for (unsigned a = 0; a < 100; a++) {
+            for (unsigned b = 0; b < 100; b++) {
+                for (bool carry : {false, true}) {
+                    uint8_t x = static_cast<uint8_t>(a / 10 << 4 | a % 10);
+                    uint8_t y = static_cast<uint8_t>(b / 10 << 4 | b % 10);
+                    uint32_t index = aluIndex(carry, x, y);
+                    unsigned sum = a + b + carry;
+                    int difference = int(a) - int(b) - !carry;
+                    mismatches += !checkDecimal(variant.second, cmos, "ADC", carry, a, b, tables.adc[1][index],
+                                                sum % 100, sum >= 100, binaryAdc(carry, x, y).value);
+                    mismatches += !checkDecimal(variant.second, cmos, "SBC", carry, a, b, tables.sbc[1][index],
+                                                (difference + 100) % 100, difference >= 0,
+                                                binarySbc(carry, x, y).value);
+                }
+            }
+        }
+    }
+    std::cout << "verify: decimal ADC and SBC on every BCD pair, " << mismatches << " mismatches" << std::endl;
+    return mismatches;
+}
+
+// Random calls to each trap routine on three machines: one running the 6502
+// code, one the native routine and one in verify mode, whose registry
+// reports any call where the two disagree. The first two are also compared
+// directly, registers, cycles and memory other than the trap opcodes, and
+// the multiply against the host's.
+int verifyTraps(int calls) {
+    TrapMachine guest(2, false, false);
+    TrapMachine native(2, true, false);
+    TrapMachine verified(2, true, true);
+    std::mt19937 random(3);
+    int differing = 0;
+    for (int i = 0; i < calls; i++) {
+        bool copy = i % 2 == 0;
+        uint16_t first = 0;
+        uint16_t second = 0;
+        uint16_t count = 0;
+        if (copy) {
+            // Whole pages, short copies and overlapping copies upwards.
+            first = 0x1000 + random() % 0x4000;
+            second = random() % 8 == 0 ? first + 1 + random() % 0x300 : 0x6000 + random() % 0x4000;
+            count = random() % 4 == 0 ? (random() % 10) << 8 : random() % 0x0A00;
+        } else {
+            first = random() % 8 == 0 ? 0xFFFF : static_cast<uint16_t>(random());
+            second = random() % 8 == 0 ? 0 : static_cast<uint16_t>(random());
+            // What the product's low half held, which it shifts out.
+            count = static_cast<uint16_t>(random());
+        }
+        CpuRegisters registers = guest.cpu.getRegisters();
+        registers.A = static_cast<uint8_t>(random());
+        registers.X = static_cast<uint8_t>(random());
+        registers.Y = static_cast<uint8_t>(random());
+        registers.P = static_cast<uint8_t>(random());
+
+        for (TrapMachine* machine : {&guest, &native, &verified}) {
+            machine->setWord(0xF0, first);
+            machine->setWord(0xF2, second);
+            machine->setWord(0xF4, count);
+            registers.cycles = machine->cpu.getCycles();
+            machine->cpu.setRegisters(registers);
+            machine->call(copy ? MEMCPY_ADDRESS : MULTIPLY_ADDRESS);
+        }
+
+        std::ostringstream what;
+        CpuRegisters expected = guest.cpu.getRegisters();
+        CpuRegisters actual = native.cpu.getRegisters();
+        uint32_t product = guest.memory[0xF4] | guest.memory[0xF5] << 8 | guest.memory[0xF6] << 16 |
+                           static_cast<uint32_t>(guest.memory[0xF7]) << 24;
+        if (!sameRegisters(expected, actual)) {
+            what << describeRegisters(actual) << ", 6502 code " << describeRegisters(expected);
+        } else if (!copy && product != static_cast<uint32_t>(first) * second) {
+            what << std::hex << "6502 product " << product;
+        } else {
+            for (uint32_t address = 0; address < 0x10000; address++) {
+                if (native.memory[address] != guest.memory[address] && !native.traps.find(address)) {
+                    what << std::hex << "memory at " << address << " is " << int(native.memory[address])
+                         << ", 6502 code " << int(guest.memory[address]);
+                    break;
+                }
+            }
+        }
+        if (!what.str().empty()) {
+            std::cout << std::hex << (copy ? "memcpy " : "multiply ") << first << ", " << second << ", " << count
+                      << std::dec << ": " << what.str() << std::endl;
+            differing++;
+        }
+    }
+    uint64_t mismatches = verified.traps.find(MEMCPY_ADDRESS)->mismatches +
+                          verified.traps.find(MULTIPLY_ADDRESS)->mismatches;
+    std::cout << std::dec << "verify: " << calls << " memcpy and multiply trap calls, " << differing
+              << " differing from the 6502 code, " << mismatches << " verify mode mismatches" << std::endl;
+    return differing + static_cast<int>(mismatches);
+}
+
+// The fixture on the Static engine against the fused interpreter, in runs
+// of random length under random stop conditions, a quarter of them through
+// executeInstructions() instead. NMIs arrive between runs. Results and
+// registers are compared after every run and memory at the end.
+int verifyStaticEngine(int runs) {
+    const RecompiledProgram* linked = findRecompiledProgram();
+    registerRecompiledProgram(&staticFixtureProgram);
+    FixtureMachine reference(ExecutionEngine::Fused);
+    FixtureMachine recompiled(ExecutionEngine::Static);
+    registerRecompiledProgram(linked);
+
+    size_t stale = countStaleBlocks(recompiled.bus, staticFixtureProgram);
+    if (stale) {
+        std::cout << "verify: " << stale << " blocks of StaticFixture.cpp do not match the fixture, regenerate it "
+                  << "with --recompile-fixture=StaticFixture.cpp" << std::endl;
+        return static_cast<int>(stale);
+    }
+
+    std::mt19937 random(5);
+    int differing = 0;
+    for (int run = 0; run < runs && !differing; run++) {
+        StopConditions conditions = randomConditions(random, reference.cpu.getCycles());
+        uint64_t budget = 1 + random() % 20000;
+        bool unchecked = random() % 4 == 0;
+        if (random() % 4 == 0) {
+            for (FixtureMachine* machine : {&reference, &recompiled}) {
+                machine->cpu.setNmiLine(true);
+                machine->cpu.setNmiLine(false);
+            }
+        }
+
+        RunResult expected{StopReason::Budget, budget, 0, 0};
+        RunResult actual = expected;
+        if (unchecked) {
+            reference.cpu.executeInstructions(budget);
+            recompiled.cpu.executeInstructions(budget);
+        } else {
+            expected = reference.cpu.run(budget, conditions);
+            actual = recompiled.cpu.run(budget, conditions);
+        }
+        CpuRegisters expectedRegisters = reference.cpu.getRegisters();
+        CpuRegisters actualRegisters = recompiled.cpu.getRegisters();
+        if (actual.reason != expected.reason || actual.instructions != expected.instructions ||
+            actual.address != expected.address || actual.idleInstructions != expected.idleInstructions) {
+            std::cout << "static engine run " << run << ": " << describeResult(actual) << ", interpreter "
+                      << describeResult(expected) << std::endl;
+            differing++;
+        } else if (!sameRegisters(expectedRegisters, actualRegisters)) {
+            std::cout << "static engine run " << run << ": " << describeRegisters(actualRegisters) << ", interpreter "
+                      << describeRegisters(expectedRegisters) << std::endl;
+            differing++;
+        }
+        if (reference.cpu.getPC() == FIXTURE_HALT) {
+            reference.cpu.setPC(FIXTURE_LOOP);
+            recompiled.cpu.setPC(FIXTURE_LOOP);
+        }
+    }
+    for (uint32_t address = 0; address < 0x10000 && !differing; address++) {
+        if (recompiled.memory[address] != reference.memory[address]) {
+            std::cout << std::hex << "static engine: memory at " << address << " is " << int(recompiled.memory[address])
+                      << ", interpreter " << int(reference.memory[address]) << std::dec << std::endl;
+            differing++;
+        }
+    }
+    std::cout << std::dec << "verify: " << runs << " static engine runs of the fixture, " << differing
+              << " differing from the interpreter" << std::endl;
+    return differing;
+}
+
+int verifyMemoryMaps(int accesses, int traces, uint64_t instructions) {
+    int differing = verifyMemoryMap<FlatRamMap>("flat RAM", accesses, traces, instructions) +
+                    verifyMemoryMap<MonitorRomMap>("monitor ROM", accesses, traces, instructions) +
+                    verifyMemoryMap<MirroredMap>("mirrored", accesses, traces, instructions);
+    std::cout << std::dec << "verify: 3 fixed memory maps, " << accesses << " accesses and " << traces
+              << " threaded engine traces each, " << differing << " differing from the page table" << std::endl;
+    return differing;
+}
+
+void emitStaticFixture(std::ostream& out) {
+    Memory memory;
+    Bus bus(memory);
+    loadStaticFixture(bus);
+    Recompiler recompiler(bus);
+    // Reset, NMI and the jump table's targets, which the walk cannot see.
+    for (uint16_t entry : {0x0200, 0x0400, 0x0258, 0x025D}) {
+        recompiler.addEntry(entry);
+    }
+    recompiler.walk();
+    recompiler.emit(out, "Static engine fixture", "staticFixtureProgram");
+}
@@ -0,0 +1,41 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+// Throughput comparisons between execution paths. Every benchmark loads the
+// program into a fresh machine so each path starts from identical state.
+struct BenchmarkConfig {
+    std::string programPath;
+    uint16_t loadAddress;
+    uint16_t startPC;
+    uint64_t instructions;
+};
+
+void benchmarkDispatch(const BenchmarkConfig& config);
+
+// Differential check of every engine against the interpreter on machines
+// filled with random memory and registers, one per trace. Prints each
+// difference and returns the number of traces that had any.
+int verifyEngines(int traces, uint64_t instructions);
+// Decimal ADC and SBC tables against BCD arithmetic; returns the entries
+// that differ.
+int verifyDecimalMode();
+// The trap routines' native code against their 6502 code, directly and
+// through the registry's verify mode; returns the calls that differ.
+int verifyTraps(int calls);
+// The Static engine on a fixture program recompiled into StaticFixture.cpp,
+// against the interpreter under random stop conditions; returns the number
+// of differences, or of stale blocks when the fixture needs regenerating.
+int verifyStaticEngine(int runs);
+// Each MappedBus map against the page table set up from its regions, on
+// random accesses and on threaded engine traces; returns the maps that
+// differ.
+int verifyMemoryMaps(int accesses, int traces, uint64_t instructions);
+// Writes the fixture's recompiled C++, which is checked in as
+// StaticFixture.cpp.
+void emitStaticFixture(std::ostream& out);
+
+#endif
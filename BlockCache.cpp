@@ -0,0 +1,261 @@
+#include "BlockCache.h"
+#include "OpcodeTable.h"
+#include <algorithm>
+#include <iostream>
+
+BlockCache::BlockCache(Bus& bus)
+    : bus(bus), retireListener(nullptr), boundaries(nullptr), blocks(0x10000, nullptr), stats{},
+      fusedPairs(0x10000, nullptr), superinstructionCounts(superinstructions.size(), 0) {
+    watchSlot = bus.addWriteWatcher(this);
+}
+
+BlockCache::~BlockCache() {
+    flush();
+    releaseRetired();
+    bus.removeWriteWatcher(watchSlot);
+}
+
+Block* BlockCache::lookup(uint16_t pc) {
+    releaseRetired();
+    stats.lookups++;
+
+    Block* block = blocks[pc];
+    if (block) {
+        stats.hits++;
+        return block;
+    }
+    return decode(pc);
+}
+
+// Like lookup(), but never decodes and does not count towards the statistics.
+Block* BlockCache::find(uint16_t pc) const {
+    return blocks[pc];
+}
+
+Block* BlockCache::decode(uint16_t pc) {
+    Block* block = new Block();
+    block->startPC = pc;
+    block->valid = true;
+    block->extraCycles = 0;
+    block->cycles = 0;
+    block->pageCount = 0;
+    block->superinstructionCount = 0;
+    block->flagFreeCount = 0;
+    block->entryCount = 0;
+    block->nativeCode = nullptr;
+
+    uint32_t address = pc;
+    for (int i = 0; i < MAX_BLOCK_INSTRUCTIONS; i++) {
+        if (i > 0 && boundaries && boundaries[address]) {
+            break;
+        }
+        uint8_t opcode = bus.readMemory(address);
+        const OpcodeInfo& info = opcodeTable[opcode];
+        uint8_t length = 1 + (info.valid ? operandLength(info.addressingMode) : 0);
+
+        uint16_t operand = 0;
+        if (length > 1) {
+            operand = bus.readMemory(address + 1);
+        }
+        if (length > 2) {
+            operand |= bus.readMemory(address + 2) << 8;
+        }
+
+        address += length;
+        block->cycles += cycleTable[opcode];
+        if (hasPageCrossPenalty(info)) {
+            block->extraCycles += 1;
+        } else if (info.valid && info.addressingMode == AddressingModeType::Relative) {
+            block->extraCycles += 2;
+        }
+        block->instructions.push_back(DecodedInstruction{predecodedHandlerTable[opcode], operand, static_cast<uint16_t>(address), opcode, nullptr});
+
+        // Stop at anything that can redirect PC, and never let a block wrap
+        // around the top of the address space.
+        if (!info.valid || changesControlFlow(info.operation) || address + 3 > 0x10000) {
+            break;
+        }
+    }
+    block->length = address - pc;
+    eliminateDeadFlags(block);
+    fuse(block);
+
+    uint8_t firstPage = pc >> 8;
+    uint8_t lastPage = (address - 1) >> 8;
+    block->pages[block->pageCount++] = firstPage;
+    if (lastPage != firstPage) {
+        block->pages[block->pageCount++] = lastPage;
+    }
+    for (int i = 0; i < block->pageCount; i++) {
+        pageBlocks[block->pages[i]].push_back(block);
+        bus.watchPage(watchSlot, block->pages[i], true);
+    }
+
+    blocks[pc] = block;
+    stats.blocksDecoded++;
+    stats.instructionsDecoded += block->instructions.size();
+    return block;
+}
+
+// Backward flag liveness over the block. Flags are live when the block ends,
+// since its successor is unknown, and after every store, since a store can
+// retire the block before the instructions that would overwrite them run.
+// Instructions whose every flag result is dead switch to their flag-free
+// handler; CPU::executeBlock only uses those when the whole block runs.
+void BlockCache::eliminateDeadFlags(Block* block) {
+    uint8_t live = FLAG_ALL;
+    for (auto it = block->instructions.rbegin(); it != block->instructions.rend(); ++it) {
+        const OpcodeInfo& info = opcodeTable[it->opcode];
+        if (!info.valid) {
+            live = FLAG_ALL;
+            continue;
+        }
+        if (writesMemory(info)) {
+            live = FLAG_ALL;
+        }
+
+        uint8_t written = flagsWritten(info.operation);
+        if (written && !(written & live) && flagFreeHandlerTable[it->opcode]) {
+            it->handler = flagFreeHandlerTable[it->opcode];
+            block->flagFreeCount++;
+            stats.flagFreeInstructions++;
+        }
+        live = (live & ~written) | flagsRead(info.operation);
+    }
+}
+
+// Marks the start of each enabled superinstruction, longest match first.
+void BlockCache::fuse(Block* block) {
+    std::vector<DecodedInstruction>& instructions = block->instructions;
+    size_t i = 0;
+    while (i + 1 < instructions.size()) {
+        const Superinstruction* match = nullptr;
+        for (const Superinstruction* triple : fusedTriples) {
+            if (i + 2 < instructions.size() && triple->opcodes[0] == instructions[i].opcode &&
+                triple->opcodes[1] == instructions[i + 1].opcode && triple->opcodes[2] == instructions[i + 2].opcode) {
+                match = triple;
+                break;
+            }
+        }
+        if (!match) {
+            match = fusedPairs[(instructions[i].opcode << 8) | instructions[i + 1].opcode];
+        }
+
+        if (match) {
+            instructions[i].superinstruction = match;
+            block->superinstructionCount++;
+            // Fused steps run their own handlers, flag-free or not.
+            for (size_t j = i; j < i + match->length; j++) {
+                if (instructions[j].handler != predecodedHandlerTable[instructions[j].opcode]) {
+                    block->flagFreeCount--;
+                }
+            }
+            i += match->length;
+        } else {
+            i++;
+        }
+    }
+}
+
+void BlockCache::onWatchedWrite(uint16_t address) {
+    invalidatePage(address >> 8);
+}
+
+void BlockCache::onPageRemapped(uint8_t page) {
+    invalidatePage(page);
+}
+
+void BlockCache::invalidatePage(uint8_t page) {
+    std::vector<Block*> victims;
+    victims.swap(pageBlocks[page]);
+
+    for (Block* block : victims) {
+        for (int i = 0; i < block->pageCount; i++) {
+            uint8_t other = block->pages[i];
+            if (other == page) {
+                continue;
+            }
+            std::vector<Block*>& list = pageBlocks[other];
+            list.erase(std::remove(list.begin(), list.end(), block), list.end());
+            if (list.empty()) {
+                bus.watchPage(watchSlot, other, false);
+            }
+        }
+        block->valid = false;
+        blocks[block->startPC] = nullptr;
+        if (retireListener) {
+            retireListener->onBlockRetired(block);
+        }
+        retired.push_back(block);
+        stats.invalidations++;
+    }
+    bus.watchPage(watchSlot, page, false);
+}
+
+void BlockCache::setBoundaries(const uint8_t* map) {
+    boundaries = map;
+    flush();
+}
+
+void BlockCache::setRetireListener(BlockRetireListener* listener) {
+    retireListener = listener;
+}
+
+void BlockCache::releaseRetired() {
+    for (Block* block : retired) {
+        delete block;
+    }
+    retired.clear();
+}
+
+void BlockCache::flush() {
+    for (int page = 0; page < 256; page++) {
+        invalidatePage(page);
+    }
+}
+
+void BlockCache::setSuperinstructions(const std::vector<uint16_t>& enabled) {
+    std::fill(fusedPairs.begin(), fusedPairs.end(), nullptr);
+    fusedTriples.clear();
+    for (uint16_t index : enabled) {
+        const Superinstruction* superinstruction = &superinstructions[index];
+        if (superinstruction->length == 3) {
+            fusedTriples.push_back(superinstruction);
+        } else {
+            fusedPairs[(superinstruction->opcodes[0] << 8) | superinstruction->opcodes[1]] = superinstruction;
+        }
+    }
+    flush();
+}
+
+const BlockCacheStats& BlockCache::getStats() const {
+    return stats;
+}
+
+void BlockCache::printStats() const {
+    double hitRate = stats.lookups ? 100.0 * stats.hits / stats.lookups : 0.0;
+    double averageLength = stats.blocksDecoded ? (double)stats.instructionsDecoded / stats.blocksDecoded : 0.0;
+
+    std::cout << std::dec;
+    std::cout << "Block lookups: " << stats.lookups << " (" << hitRate << "% hits)" << std::endl;
+    std::cout << "Blocks decoded: " << stats.blocksDecoded << ", average length " << averageLength << " instructions" << std::endl;
+    std::cout << "Blocks invalidated: " << stats.invalidations << std::endl;
+    std::cout << "Dead flag updates: " << stats.flagFreeInstructions << " decoded instructions flag-free, "
+              << stats.flagUpdatesSkipped << " updates skipped" << std::endl;
+}
+
+void BlockCache::printSuperinstructionStats() const {
+    uint64_t saved = 0;
+    std::cout << std::dec;
+    for (size_t index = 0; index < superinstructions.size(); index++) {
+        uint64_t count = superinstructionCounts[index];
+        if (count == 0) {
+            continue;
+        }
+        uint64_t dispatches = count * (superinstructions[index].length - 1);
+        std::cout << "  " << superinstructions[index].name << ": " << count << " times, "
+                  << dispatches << " dispatches saved" << std::endl;
+        saved += dispatches;
+    }
+    std::cout << "Superinstruction dispatches saved: " << saved << std::endl;
+}
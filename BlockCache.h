@@ -0,0 +1,124 @@
+#ifndef BLOCKCACHE_H
+#define BLOCKCACHE_H
+
+#include <cstdint>
+#include <vector>
+#include "Bus.h"
+#include "FusedHandlers.h"
+#include "Superinstructions.h"
+
+// superinstruction is set on the first instruction of a fused run; the
+// following instructions stay decoded for partial budgets and the JIT.
+struct DecodedInstruction {
+    PredecodedHandler handler;
+    uint16_t operand;
+    uint16_t nextPC;
+    uint8_t opcode;
+    const Superinstruction* superinstruction;
+};
+
+// A straight-line run of instructions ending at the first control-flow
+// instruction. valid is cleared when a write hits one of its pages; the block
+// is only freed once nothing can still be executing it. cycles is the sum of
+// the instructions' base cycles; page crossings and taken branches can add
+// up to extraCycles on top. entryCount and nativeCode belong to the JIT tier.
+struct Block {
+    uint16_t startPC;
+    uint16_t length;
+    bool valid;
+    uint8_t extraCycles;
+    uint32_t cycles;
+    uint8_t pages[2];
+    uint8_t pageCount;
+    uint8_t superinstructionCount;
+    uint8_t flagFreeCount;
+    uint32_t entryCount;
+    void* nativeCode;
+    std::vector<DecodedInstruction> instructions;
+};
+
+// Told about every block the cache retires, before it is freed.
+class BlockRetireListener {
+public:
+    virtual void onBlockRetired(Block* block) = 0;
+    virtual ~BlockRetireListener() = default;
+};
+
+struct BlockCacheStats {
+    uint64_t lookups;
+    uint64_t hits;
+    uint64_t blocksDecoded;
+    uint64_t instructionsDecoded;
+    uint64_t invalidations;
+    uint64_t flagFreeInstructions;
+    uint64_t flagUpdatesSkipped;
+};
+
+// Decoded basic blocks keyed by start PC. Pages holding cached code are
+// watched on the bus so self-modifying code invalidates the affected blocks.
+// Memory changed behind the bus's back (loadProgram, Memory::operator[])
+// requires an explicit flush().
+class BlockCache : public WriteWatcher {
+private:
+    static const int MAX_BLOCK_INSTRUCTIONS = 64;
+
+    Bus& bus;
+    int watchSlot;
+    BlockRetireListener* retireListener;
+    const uint8_t* boundaries;
+    std::vector<Block*> blocks;
+    std::vector<Block*> pageBlocks[256];
+    std::vector<Block*> retired;
+    BlockCacheStats stats;
+
+    // Enabled superinstructions: pairs indexed by (first << 8) | second,
+    // triples matched in catalogue order before any pair.
+    std::vector<const Superinstruction*> fusedPairs;
+    std::vector<const Superinstruction*> fusedTriples;
+    std::vector<uint64_t> superinstructionCounts;
+
+    Block* decode(uint16_t pc);
+    void eliminateDeadFlags(Block* block);
+    void fuse(Block* block);
+    void invalidatePage(uint8_t page);
+    void releaseRetired();
+
+public:
+    BlockCache(Bus& bus);
+    ~BlockCache() override;
+
+    Block* lookup(uint16_t pc);
+    Block* find(uint16_t pc) const;
+    void flush();
+    void onWatchedWrite(uint16_t address) override;
+    void onPageRemapped(uint8_t page) override;
+    void setRetireListener(BlockRetireListener* listener);
+    // Addresses with a non-zero entry in map (64K entries, or nullptr for
+    // none) always start a block of their own. Flushes the cache.
+    void setBoundaries(const uint8_t* map);
+    bool isBoundary(uint16_t pc) const;
+
+    // Enables the given catalogue entries (see SuperinstructionProfile::select)
+    // and flushes, so every block is decoded again with them.
+    void setSuperinstructions(const std::vector<uint16_t>& enabled);
+    void recordSuperinstruction(const Superinstruction* superinstruction);
+    void recordFlagUpdatesSkipped(uint32_t count);
+
+    const BlockCacheStats& getStats() const;
+    void printStats() const;
+    void printSuperinstructionStats() const;
+};
+
+inline void BlockCache::recordSuperinstruction(const Superinstruction* superinstruction) {
+    superinstructionCounts[superinstruction - superinstructions.data()]++;
+}
+
+inline bool BlockCache::isBoundary(uint16_t pc) const {
+    return boundaries && boundaries[pc];
+}
+
+inline void BlockCache::recordFlagUpdatesSkipped(uint32_t count) {
+    stats.flagUpdatesSkipped += count;
+}
+
+#endif
@@ -1,11 +1,168 @@
 #include "Bus.h"
+#include <algorithm>
+#include <cstring>
 
-Bus::Bus(Memory& mem) : memory(mem) {}
+Bus::Bus(Memory& mem) : devicePages(0), memory(mem), machineMap(MachineMap::Runtime) {
+    std::memset(writeWatchers, 0, sizeof(writeWatchers));
+    std::memset(watchedPages, 0, sizeof(watchedPages));
+    std::memset(fixedPages, 0, sizeof(fixedPages));
+    for (int page = 0; page < 256; page++) {
+        pages[page] = Page{&memory[page << 8], nullptr, 0};
+        readPages[page] = pages[page].data;
+        writePages[page] = pages[page].data;
+    }
+}
+
+uint8_t Bus::readDevice(uint16_t address) {
+    return pages[address >> 8].device->read(address);
+}
+
+uint8_t Bus::readPaged(uint16_t address) {
+    return readMemory(address);
+}
+
+void Bus::writePaged(uint16_t address, uint8_t data) {
+    writeMemory(address, data);
+}
+
+// Everything but a write to a plain, unwatched RAM page.
+void Bus::writeSlow(uint16_t address, uint8_t data) {
+    const Page& page = pages[address >> 8];
+    if (!page.data) {
+        page.device->write(address, data);
+    } else {
+        if (!(page.flags & PAGE_READ_ONLY)) {
+            page.data[address & 0xFF] = data;
+        }
+        if (page.flags & PAGE_WRITE_TRAP) {
+            page.device->write(address, data);
+        }
+    }
+    if (watchedPages[address >> 8]) {
+        notifyWatchers(address);
+    }
+}
+
+void Bus::notifyWatchers(uint16_t address) {
+    uint8_t watchers = watchedPages[address >> 8];
+    for (int slot = 0; watchers; slot++, watchers >>= 1) {
+        if (watchers & 1) {
+            writeWatchers[slot]->onWatchedWrite(address);
+        }
+    }
+}
+
+void Bus::notifyRemap(uint8_t page) {
+    uint8_t watchers = watchedPages[page];
+    for (int slot = 0; watchers; slot++, watchers >>= 1) {
+        if (watchers & 1) {
+            writeWatchers[slot]->onPageRemapped(page);
+        }
+    }
+}
+
+void Bus::setPage(uint8_t page, const Page& entry) {
+    bool remapped = entry.data != pages[page].data;
+    devicePages += !entry.data - !pages[page].data;
+    pages[page] = entry;
+    readPages[page] = entry.data;
+    updateWritePage(page);
+    if (remapped && watchedPages[page]) {
+        notifyRemap(page);
+    }
+}
 
-uint8_t Bus::readMemory(uint16_t address) {
-    return memory.read(address);
+void Bus::updateWritePage(uint8_t page) {
+    const Page& entry = pages[page];
+    bool direct = entry.data && !(entry.flags & (PAGE_READ_ONLY | PAGE_WRITE_TRAP)) && !watchedPages[page];
+    writePages[page] = direct ? entry.data : nullptr;
 }
 
-void Bus::writeMemory(uint16_t address, uint8_t data) {
-    memory.write(address, data);
-}
\ No newline at end of file
+bool Bus::isFixed(uint8_t firstPage, unsigned pageCount) const {
+    unsigned end = std::min(firstPage + pageCount, 256u);
+    return std::find(fixedPages + firstPage, fixedPages + end, true) != fixedPages + end;
+}
+
+bool Bus::mapMemory(uint8_t firstPage, unsigned pageCount, uint8_t* data, uint8_t flags, Device* trap) {
+    if (isFixed(firstPage, pageCount)) {
+        return false;
+    }
+    for (unsigned i = 0; i < pageCount && firstPage + i < 256; i++) {
+        setPage(firstPage + i, Page{data + i * 256, trap, flags});
+    }
+    return true;
+}
+
+bool Bus::remapMemory(uint8_t firstPage, unsigned pageCount, uint8_t* data) {
+    if (isFixed(firstPage, pageCount)) {
+        return false;
+    }
+    unsigned end = std::min(firstPage + pageCount, 256u);
+    bool watched = false;
+    for (unsigned page = firstPage; page < end; page++, data += 256) {
+        pages[page].data = data;
+        readPages[page] = data;
+        writePages[page] = writePages[page] ? data : nullptr;
+        watched |= watchedPages[page] != 0;
+    }
+    if (watched) {
+        for (unsigned page = firstPage; page < end; page++) {
+            if (watchedPages[page]) {
+                notifyRemap(page);
+            }
+        }
+    }
+    return true;
+}
+
+bool Bus::mapDevice(uint8_t firstPage, unsigned pageCount, Device* device) {
+    if (isFixed(firstPage, pageCount)) {
+        return false;
+    }
+    for (unsigned i = 0; i < pageCount && firstPage + i < 256; i++) {
+        setPage(firstPage + i, Page{nullptr, device, 0});
+    }
+    return true;
+}
+
+bool Bus::unmap(uint8_t firstPage, unsigned pageCount) {
+    if (isFixed(firstPage, pageCount)) {
+        return false;
+    }
+    for (unsigned i = 0; i < pageCount && firstPage + i < 256; i++) {
+        setPage(firstPage + i, Page{&memory[(firstPage + i) << 8], nullptr, 0});
+    }
+    return true;
+}
+
+int Bus::addWriteWatcher(WriteWatcher* watcher) {
+    for (int slot = 0; slot < MAX_WRITE_WATCHERS; slot++) {
+        if (!writeWatchers[slot]) {
+            writeWatchers[slot] = watcher;
+            return slot;
+        }
+    }
+    return -1;
+}
+
+void Bus::removeWriteWatcher(int slot) {
+    if (slot < 0) {
+        return;
+    }
+    for (int page = 0; page < 256; page++) {
+        watchPage(slot, page, false);
+    }
+    writeWatchers[slot] = nullptr;
+}
+
+void Bus::watchPage(int slot, uint8_t page, bool watched) {
+    if (slot < 0) {
+        return;
+    }
+    if (watched && writeWatchers[slot]) {
+        watchedPages[page] |= 1 << slot;
+    } else {
+        watchedPages[page] &= ~(1 << slot);
+    }
+    updateWritePage(page);
+}
@@ -2,16 +2,159 @@
 #define BUS_H
 
 #include "Memory.h"
+#include <cstddef>
 #include <cstdint>
+#include <vector>
 
+// Notified when a write lands on a page the bus has been asked to watch.
+class WriteWatcher {
+public:
+    virtual void onWatchedWrite(uint16_t address) = 0;
+    // A watched page was mapped onto different memory, as a bank switch
+    // does, so everything in it may have changed without a write.
+    virtual void onPageRemapped(uint8_t page) {}
+    virtual ~WriteWatcher() = default;
+};
+
+// Memory-mapped I/O. A device gets every access to the pages mapped to it,
+// and every write to memory pages it traps.
+class Device {
+public:
+    virtual uint8_t read(uint16_t address) = 0;
+    virtual void write(uint16_t address, uint8_t data) = 0;
+    // State for save states: whatever saveState() appends is handed back
+    // to loadState(), which returns false if it cannot use it. Stateless
+    // devices keep these.
+    virtual void saveState(std::vector<uint8_t>& out) const {}
+    virtual bool loadState(const uint8_t* data, size_t size) { return size == 0; }
+    virtual ~Device() = default;
+};
+
+enum PageFlags : uint8_t {
+    PAGE_READ_ONLY = 0x01,  // writes are dropped
+    PAGE_WRITE_TRAP = 0x02  // writes also go to the page's device
+};
 
+// One 256-byte page of the address space: host memory, or a device when
+// data is nullptr.
+struct Page {
+    uint8_t* data;
+    Device* device;
+    uint8_t flags;
+};
+
+// The fixed memory maps a MappedBus can be built on, see MemoryMap.h.
+// Runtime is a plain Bus, configured at run time.
+enum class MachineMap : uint8_t {
+    Runtime,
+    FlatRam,
+    MonitorRom
+};
+
+// Decodes addresses through a 256-entry page table. Reads of memory pages
+// and writes to plain RAM pages are a pointer load and an indexed access;
+// device pages, read-only and trapped pages, and pages a watcher is on take
+// the out-of-line path. Every page starts out mapped to the Memory.
 class Bus {
+public:
+    static const int MAX_WRITE_WATCHERS = 8;
+
 private:
+    // Host memory behind each page, nullptr for device pages.
+    uint8_t* readPages[256];
+    // The same for pages writes can go straight to, nullptr for the rest.
+    uint8_t* writePages[256];
+    Page pages[256];
+    WriteWatcher* writeWatchers[MAX_WRITE_WATCHERS];
+    int devicePages;
+
+    void writeSlow(uint16_t address, uint8_t data);
+    bool isFixed(uint8_t firstPage, unsigned pageCount) const;
+    void setPage(uint8_t page, const Page& entry);
+    void updateWritePage(uint8_t page);
+
+protected:
     Memory& memory;
+    // One bit per watcher slot.
+    uint8_t watchedPages[256];
+    MachineMap machineMap;
+    // Pages a MappedBus decodes without the page table, which must keep
+    // showing what the map put there.
+    bool fixedPages[256];
+
+    uint8_t readDevice(uint16_t address);
+    void notifyWatchers(uint16_t address);
+    // Out-of-line readMemory() and writeMemory(), for callers that only
+    // take the page table's path now and then.
+    uint8_t readPaged(uint16_t address);
+    void writePaged(uint16_t address, uint8_t data);
+
 public:
     Bus(Memory& mem);
     uint8_t readMemory(uint16_t address);
     void writeMemory(uint16_t address, uint8_t data);
+
+    // Maps pageCount pages from firstPage onto data, which must hold
+    // pageCount * 256 bytes and outlive the mapping. Mapping the same data
+    // at several places mirrors it, and mapping other data over a page
+    // switches its bank. trap gets the writes when flags has
+    // PAGE_WRITE_TRAP, after they are stored unless PAGE_READ_ONLY is set
+    // too, which suits bank-switching registers in ROM.
+    //
+    // This and the three below return false, changing nothing, when a page
+    // in the range is one a MappedBus's map fixes.
+    bool mapMemory(uint8_t firstPage, unsigned pageCount, uint8_t* data, uint8_t flags = 0,
+                   Device* trap = nullptr);
+    // Points memory pages mapped with mapMemory() at new data, keeping their
+    // flags and trap: the short path for a bank switch, touching nothing
+    // but the page table's pointers.
+    bool remapMemory(uint8_t firstPage, unsigned pageCount, uint8_t* data);
+    bool mapDevice(uint8_t firstPage, unsigned pageCount, Device* device);
+    // Puts pages back on the Memory, as plain RAM.
+    bool unmap(uint8_t firstPage, unsigned pageCount);
+    const Page& getPage(uint8_t page) const;
+    bool isDevicePage(uint8_t page) const;
+    bool hasDevicePages() const;
+    MachineMap getMachineMap() const;
+
+    // Returns the watcher's slot, or -1 when every slot is taken.
+    int addWriteWatcher(WriteWatcher* watcher);
+    void removeWriteWatcher(int slot);
+    void watchPage(int slot, uint8_t page, bool watched);
+    // Tells the watchers on page that its contents were replaced without
+    // going through the bus, as restoring a snapshot does.
+    void notifyRemap(uint8_t page);
 };
 
-#endif 
\ No newline at end of file
+inline uint8_t Bus::readMemory(uint16_t address) {
+    if (const uint8_t* data = readPages[address >> 8]) {
+        return data[address & 0xFF];
+    }
+    return readDevice(address);
+}
+
+inline void Bus::writeMemory(uint16_t address, uint8_t data) {
+    if (uint8_t* page = writePages[address >> 8]) {
+        page[address & 0xFF] = data;
+        return;
+    }
+    writeSlow(address, data);
+}
+
+inline const Page& Bus::getPage(uint8_t page) const {
+    return pages[page];
+}
+
+inline bool Bus::isDevicePage(uint8_t page) const {
+    return !readPages[page];
+}
+
+inline bool Bus::hasDevicePages() const {
+    return devicePages != 0;
+}
+
+inline MachineMap Bus::getMachineMap() const {
+    return machineMap;
+}
+
+#endif
@@ -3,176 +3,534 @@
 #include "CPU.h"
 #include "Instruction.h"
 #include "InstructionFactory.h"
+#include "ThreadedEngine.h"
+#include "BlockCache.h"
+#include "Jit.h"
+#include "CycleEngine.h"
+#include "Recompiler.h"
+#include "Traps.h"
+#include <algorithm>
 
-CPU::CPU(Bus& bus) 
-    : bus(bus),instructionFactory(InstructionFactory::getInstance()),A(0), X(0), Y(0), SP(0xFD), PC(0x0000), StatusRegister(0x34) {}
+namespace {
 
-void CPU::reset() {
-    A = 0;
-    X = 0;
-    Y = 0;
-    SP = 0xFF;
-    StatusRegister = 0x34;
-    PC = bus.readMemory(0xFFFC) | (bus.readMemory(0xFFFD) << 8);
-}
+// The most an NMOS instruction takes: BRK and read-modify-write with
+// absolute X indexing. Page crossings and taken branches stay below it.
+const uint64_t MAX_INSTRUCTION_CYCLES = 7;
 
-void CPU::execute() {
-    uint8_t opcode = fetch();
-    Instruction* instruction = instructionFactory->createInstruction(opcode); 
-    if (instruction) {
-        instruction->execute(*this);
-        delete instruction;
-    } else {
-        std::cout << "Invalid opcode: " << std::hex << (int)opcode << std::dec << std::endl;
-    }
+void trapHandler(CPU& cpu) {
+    cpu.getTrapRegistry()->execute(cpu);
 }
 
-//Memory Operations
-uint8_t CPU::fetch() {
-    return bus.readMemory(PC++);
 }
 
-uint8_t CPU::read(uint16_t address) {
-    return bus.readMemory(address);
+CPU::CPU(Bus& bus, CpuVariant variant) 
+    : bus(bus),instructionFactory(InstructionFactory::getInstance()), variant(variant),
+      dispatchTable(instructionFactory->getDispatchTable(variant)), aluTables(&::getAluTables(variant)), engine(ExecutionEngine::Fused), traps(nullptr), stopRequested(false), pendingInterrupts(0), nmiLine(false), A(0), X(0), Y(0), SP(0xFD), PC(0x0000), cycles(0) {
+    setStatusRegister(0x34);
 }
 
-void CPU::write(uint16_t address, uint8_t value) {
-    bus.writeMemory(address, value);
-}
-
-//Register Operations
-uint8_t CPU::getAccumulator() const {
-    return A;
-}
-
-void CPU::setAccumulator(uint8_t value) {
-    A = value;
-}
+CPU::~CPU() {}
 
-uint8_t CPU::getX() const {
-    return X;
-}
-
-void CPU::setX(uint8_t value) {
-    X = value;
-}
-
-uint8_t CPU::getY() const {
-    return Y;
-}
-
-void CPU::setY(uint8_t value) {
-    Y = value;
-}
-
-uint16_t CPU::getPC() const {
-    return PC;
-}
-
-void CPU::setPC(uint16_t value) {
-    PC = value;
-}
-
-uint8_t CPU::getSP() const {
-    return SP;
-}
-
-void CPU::setSP(uint8_t value) {
-    SP = value;
+void CPU::reset() {
+    A = 0;
+    X = 0;
+    Y = 0;
+    SP = 0xFF;
+    setStatusRegister(0x34);
+    PC = bus.readMemory(0xFFFC) | (bus.readMemory(0xFFFD) << 8);
+    cycles += 7;
+    if (cycleEngine) {
+        cycleEngine->reset();
+    }
+    // Devices keep holding IRQ across a reset; a latched NMI is lost.
+    pendingInterrupts.fetch_and(IRQ_SOURCES, std::memory_order_relaxed);
+}
+
+CpuRegisters CPU::getRegisters() {
+    return CpuRegisters{PC, A, X, Y, SP, getStatusRegister(), cycles,
+                        pendingInterrupts.load(std::memory_order_relaxed), nmiLine.load(std::memory_order_relaxed)};
+}
+
+void CPU::setRegisters(const CpuRegisters& registers) {
+    PC = registers.PC;
+    A = registers.A;
+    X = registers.X;
+    Y = registers.Y;
+    SP = registers.SP;
+    setStatusRegister(registers.P);
+    cycles = registers.cycles;
+    pendingInterrupts.store(registers.pendingInterrupts, std::memory_order_relaxed);
+    nmiLine.store(registers.nmiLine, std::memory_order_relaxed);
+    if (cycleEngine) {
+        cycleEngine->reset();
+    }
 }
 
-//Status Register and Flags Operations
-bool CPU::getCarryFlag() const {
-    return C;
+void CPU::setIrqLine(bool asserted, uint8_t source) {
+    uint32_t bit = 1u << (source & 7);
+    if (asserted) {
+        pendingInterrupts.fetch_or(bit, std::memory_order_relaxed);
+    } else {
+        pendingInterrupts.fetch_and(~bit, std::memory_order_relaxed);
+    }
 }
 
-void CPU::setCarryFlag(bool flag) {
-    C = flag;
+void CPU::setNmiLine(bool asserted) {
+    if (!nmiLine.exchange(asserted) && asserted) {
+        pendingInterrupts.fetch_or(NMI_PENDING, std::memory_order_relaxed);
+    }
 }
 
-bool CPU::getZeroFlag() const {
-    return Z;
+void CPU::requestReset() {
+    pendingInterrupts.fetch_or(RESET_PENDING, std::memory_order_relaxed);
 }
 
-void CPU::setZeroFlag(bool flag) {
-    Z = flag;
+uint16_t CPU::acknowledgeInterrupt() {
+    uint32_t pending = pendingInterrupts.load(std::memory_order_relaxed);
+    if (pending & RESET_PENDING) {
+        return 0xFFFC;
+    }
+    if (pending & NMI_PENDING) {
+        pendingInterrupts.fetch_and(~NMI_PENDING, std::memory_order_relaxed);
+        return 0xFFFA;
+    }
+    if ((pending & IRQ_SOURCES) && !I) {
+        return 0xFFFE;
+    }
+    return 0;
 }
 
-bool CPU::getInterruptDisableFlag() const {
-    return I;
+bool CPU::serviceInterrupts() {
+    uint16_t vector = acknowledgeInterrupt();
+    if (vector == 0) {
+        return false;
+    }
+    if (vector == 0xFFFC) {
+        reset();
+        return true;
+    }
+    pushPC();
+    pushStack((getStatusRegister() & ~FLAG_B) | FLAG_U);
+    I = 1;
+    if (variant == CpuVariant::WDC65C02) {
+        D = 0;
+    }
+    PC = read(vector) | (read(vector + 1) << 8);
+    cycles += 7;
+    return true;
 }
 
-void CPU::setInterruptDisableFlag(bool flag) {
-    I = flag;
+void CPU::execute() {
+    uint8_t opcode = fetch();
+    dispatchTable[opcode].handler(*this);
 }
 
-bool CPU::getDecimalFlag() const {
-    return D;
+void CPU::executeOpcode(uint8_t opcode) {
+    instructionFactory->getDispatchTable(variant)[opcode].handler(*this);
 }
 
-void CPU::setDecimalFlag(bool flag) {
-    D = flag;
+void CPU::executeInstructions(uint64_t count) {
+    if (engine == ExecutionEngine::Threaded) {
+        ThreadedEngine::run(*this, count);
+        return;
+    }
+    if (engine == ExecutionEngine::Cached) {
+        while (count > 0) {
+            if (hasPendingInterrupts()) {
+                serviceInterrupts();
+            }
+            count = executeBlock(blockCache->lookup(PC), count);
+        }
+        return;
+    }
+    if (engine == ExecutionEngine::Jit) {
+        jit->run(count);
+        return;
+    }
+    if (engine == ExecutionEngine::Cycle) {
+        cycleEngine->run(count);
+        return;
+    }
+    if (engine == ExecutionEngine::Static) {
+        recompiledRunner->run(count);
+        return;
+    }
+    for (uint64_t i = 0; i < count; i++) {
+        if (hasPendingInterrupts()) {
+            serviceInterrupts();
+        }
+        execute();
+    }
 }
 
-bool CPU::getBreakFlag() const {
-    return B;
-}
+RunResult CPU::run(uint64_t maxInstructions, const StopConditions& conditions) {
+    stopRequested = false;
+    if (!stopMonitor) {
+        if (conditions.empty()) {
+            executeInstructions(maxInstructions);
+            return RunResult{StopReason::Budget, maxInstructions, PC, 0};
+        }
+        stopMonitor.reset(new StopMonitor(bus, stopRequested));
+    }
+    if (stopMonitor->configure(conditions)) {
+        if (blockCache) {
+            blockCache->setBoundaries(stopMonitor->getBreakpointMap());
+        }
+        if (recompiledRunner) {
+            recompiledRunner->setBreakpoints(stopMonitor->getBreakpointMap());
+        }
+    }
+    stopMonitor->beginRun();
+    if (conditions.empty()) {
+        executeInstructions(maxInstructions);
+        return stopMonitor->finish(StopReason::Budget, maxInstructions, PC);
+    }
 
-void CPU::setBreakFlag(bool flag) {
-    B = flag;
+    if (stopMonitor->isBreakpoint(PC) && !stopMonitor->resumesFrom(PC)) {
+        return stopMonitor->finish(StopReason::Breakpoint, 0, PC);
+    }
+    if (cycles >= stopMonitor->getCycleDeadline()) {
+        return stopMonitor->finish(StopReason::CycleDeadline, 0, PC);
+    }
+    if (maxInstructions == 0) {
+        return stopMonitor->finish(StopReason::Budget, 0, PC);
+    }
+    switch (engine) {
+        case ExecutionEngine::Threaded:
+            return ThreadedEngine::run(*this, maxInstructions, *stopMonitor);
+        case ExecutionEngine::Cached:
+        case ExecutionEngine::Jit:
+            return runBlocksChecked(maxInstructions);
+        case ExecutionEngine::Static:
+            return runRecompiledChecked(maxInstructions);
+        default:
+            return runChecked(maxInstructions);
+    }
 }
 
-bool CPU::getOverflowFlag() const {
-    return V;
+// Stops are checked after each instruction: a write trigger first, then an
+// instruction that left PC where it was, then the cycle deadline, then an
+// idle loop just gone round, then a breakpoint at the new PC.
+RunResult CPU::runChecked(uint64_t maxInstructions) {
+    StopMonitor& monitor = *stopMonitor;
+    const bool stopOnHalt = monitor.stopsOnHalt();
+    const IdleAction idleAction = monitor.getIdleAction();
+    const uint64_t deadline = monitor.getCycleDeadline();
+    CycleEngine* stepped = engine == ExecutionEngine::Cycle ? cycleEngine.get() : nullptr;
+    uint64_t remaining = maxInstructions;
+    while (remaining > 0) {
+        if (!stepped && hasPendingInterrupts()) {
+            serviceInterrupts();
+        }
+        uint16_t instructionPC = PC;
+        if (stepped) {
+            stepped->run(1);
+        } else {
+            execute();
+        }
+        remaining--;
+        if (stopRequested) {
+            return monitor.finish(StopReason::WriteTrigger, maxInstructions - remaining, monitor.getTriggerAddress());
+        }
+        if (stopOnHalt && PC == instructionPC) {
+            return monitor.finish(StopReason::Halt, maxInstructions - remaining, PC);
+        }
+        if (cycles >= deadline) {
+            return monitor.finish(StopReason::CycleDeadline, maxInstructions - remaining, PC);
+        }
+        // An interrupt that is about to be taken breaks the loop.
+        if (idleAction != IdleAction::Ignore && PC <= instructionPC && !canTakeInterrupt(I)) {
+            if (uint32_t length = monitor.checkIdle(instructionPC, PC, loopState(), cycles)) {
+                if (idleAction == IdleAction::Stop) {
+                    return monitor.finish(StopReason::Idle, maxInstructions - remaining, PC);
+                }
+                remaining = monitor.fastForward(remaining, length, cycles);
+            }
+        }
+        if (monitor.isBreakpoint(PC)) {
+            return monitor.finish(StopReason::Breakpoint, maxInstructions - remaining, PC);
+        }
+    }
+    return monitor.finish(StopReason::Budget, maxInstructions, PC);
+}
+
+// The block cache starts a new block at every breakpoint, and halting
+// instructions and the jump closing an idle loop always end their block, so
+// the checks of runChecked() only need to run between blocks. Write
+// triggers end the block early, and a block that may reach the cycle
+// deadline runs one instruction at a time. Native code chains past these
+// checks, so the JIT leaves it at breakpoints and, when halts or idle loops
+// are watched, after every jump back; the deadline it cannot see is kept
+// out of reach by its budget.
+RunResult CPU::runBlocksChecked(uint64_t maxInstructions) {
+    StopMonitor& monitor = *stopMonitor;
+    const bool stopOnHalt = monitor.stopsOnHalt();
+    const IdleAction idleAction = monitor.getIdleAction();
+    const uint64_t deadline = monitor.getCycleDeadline();
+    const bool watchLoops = stopOnHalt || idleAction != IdleAction::Ignore;
+    Jit* native = engine == ExecutionEngine::Jit ? jit.get() : nullptr;
+    uint64_t remaining = maxInstructions;
+    while (remaining > 0) {
+        if (hasPendingInterrupts()) {
+            serviceInterrupts();
+        }
+        Block* block = native ? native->lookup(PC) : blockCache->lookup(PC);
+        size_t length = block->instructions.size();
+        uint16_t lastPC = length > 1 ? block->instructions[length - 2].nextPC : block->startPC;
+        uint64_t nativeBudget = std::min(remaining, (deadline - cycles - 1) / MAX_INSTRUCTION_CYCLES);
+
+        uint64_t left;
+        bool completed;
+        if (deadline - cycles <= block->cycles + block->extraCycles) {
+            left = executePartialBlock(block, remaining, deadline);
+            completed = remaining - left == length;
+        } else if (native && native->canRunNative(block, nativeBudget)) {
+            left = remaining - nativeBudget + native->runNative(block, nativeBudget, watchLoops);
+            if (native->skippedLoops()) {
+                monitor.forgetLoop();
+            }
+            int32_t jump = native->getLoopJump();
+            completed = jump >= 0;
+            lastPC = static_cast<uint16_t>(jump);
+        } else {
+            left = executeBlock(block, remaining);
+            completed = remaining - left == length;
+        }
+        remaining = left;
+
+        if (stopRequested) {
+            return monitor.finish(StopReason::WriteTrigger, maxInstructions - remaining, monitor.getTriggerAddress());
+        }
+        if (stopOnHalt && completed && PC == lastPC) {
+            return monitor.finish(StopReason::Halt, maxInstructions - remaining, PC);
+        }
+        if (cycles >= deadline) {
+            return monitor.finish(StopReason::CycleDeadline, maxInstructions - remaining, PC);
+        }
+        if (idleAction != IdleAction::Ignore && completed && PC <= lastPC && !canTakeInterrupt(I)) {
+            if (uint32_t loopLength = monitor.checkIdle(lastPC, PC, loopState(), cycles)) {
+                if (idleAction == IdleAction::Stop) {
+                    return monitor.finish(StopReason::Idle, maxInstructions - remaining, PC);
+                }
+                remaining = monitor.fastForward(remaining, loopLength, cycles);
+            }
+        }
+        if (monitor.isBreakpoint(PC)) {
+            return monitor.finish(StopReason::Breakpoint, maxInstructions - remaining, PC);
+        }
+    }
+    return monitor.finish(StopReason::Budget, maxInstructions, PC);
+}
+
+// Recompiled code runs between the checks of runBlocksChecked(). It
+// returns after every jump back while halts or idle loops are watched, and
+// after a store that hits a write trigger; blocks on a page with a
+// breakpoint are left to the interpreter, as is wherever PC has no block or
+// the deadline could be reached, one instruction at a time.
+RunResult CPU::runRecompiledChecked(uint64_t maxInstructions) {
+    StopMonitor& monitor = *stopMonitor;
+    const bool stopOnHalt = monitor.stopsOnHalt();
+    const IdleAction idleAction = monitor.getIdleAction();
+    const uint64_t deadline = monitor.getCycleDeadline();
+    const bool watchLoops = stopOnHalt || idleAction != IdleAction::Ignore;
+    uint64_t remaining = maxInstructions;
+    while (remaining > 0) {
+        if (hasPendingInterrupts()) {
+            serviceInterrupts();
+        }
+        uint16_t lastPC = PC;
+        uint64_t budget = std::min(remaining, (deadline - cycles - 1) / MAX_INSTRUCTION_CYCLES);
+        int32_t jump = -1;
+        uint64_t executed = budget ? recompiledRunner->runChecked(budget, watchLoops ? &jump : nullptr) : 0;
+        bool completed = true;
+        if (executed == 0) {
+            execute();
+            executed = 1;
+        } else {
+            completed = jump >= 0;
+            lastPC = static_cast<uint16_t>(jump);
+        }
+        remaining -= executed;
+
+        if (stopRequested) {
+            return monitor.finish(StopReason::WriteTrigger, maxInstructions - remaining, monitor.getTriggerAddress());
+        }
+        if (stopOnHalt && completed && PC == lastPC) {
+            return monitor.finish(StopReason::Halt, maxInstructions - remaining, PC);
+        }
+        if (cycles >= deadline) {
+            return monitor.finish(StopReason::CycleDeadline, maxInstructions - remaining, PC);
+        }
+        if (idleAction != IdleAction::Ignore && completed && PC <= lastPC && !canTakeInterrupt(I)) {
+            if (uint32_t loopLength = monitor.checkIdle(lastPC, PC, loopState(), cycles)) {
+                if (idleAction == IdleAction::Stop) {
+                    return monitor.finish(StopReason::Idle, maxInstructions - remaining, PC);
+                }
+                remaining = monitor.fastForward(remaining, loopLength, cycles);
+            }
+        }
+        if (monitor.isBreakpoint(PC)) {
+            return monitor.finish(StopReason::Breakpoint, maxInstructions - remaining, PC);
+        }
+    }
+    return monitor.finish(StopReason::Budget, maxInstructions, PC);
 }
 
-void CPU::setOverflowFlag(bool flag) {
-    V = flag;
+LoopState CPU::loopState() {
+    return LoopState{A, X, Y, SP, getStatusRegister()};
 }
 
-bool CPU::getNegativeFlag() const {
-    return N;
+// Replays a predecoded block, stopping early if the budget runs out or the
+// block is retired under us. Returns the unused part of the budget.
+uint64_t CPU::executeBlock(const Block* block, uint64_t count) {
+    // Flag-free handlers and superinstructions assume the rest of the block
+    // runs, so a budget that ends inside the block replays the exact ones.
+    if (count < block->instructions.size()) {
+        return executePartialBlock(block, count);
+    }
+    if (block->superinstructionCount) {
+        return executeFusedBlock(block, count);
+    }
+    for (const DecodedInstruction& instruction : block->instructions) {
+        PC = instruction.nextPC;
+        instruction.handler(*this, instruction.operand);
+        // A store into the block's own pages retires it; resume from PC
+        // with a freshly decoded block. A write trigger stops the run.
+        if (!block->valid || stopRequested) {
+            size_t executed = &instruction - block->instructions.data() + 1;
+            addBaseCycles(block, executed);
+            return count - executed;
+        }
+    }
+    cycles += block->cycles;
+    blockCache->recordFlagUpdatesSkipped(block->flagFreeCount);
+    return count - block->instructions.size();
+}
+
+// Runs the exact handlers one at a time, until the budget runs out or the
+// cycle counter reaches the deadline.
+uint64_t CPU::executePartialBlock(const Block* block, uint64_t count, uint64_t deadline) {
+    for (const DecodedInstruction& instruction : block->instructions) {
+        PC = instruction.nextPC;
+        predecodedHandlerTable[instruction.opcode](*this, instruction.operand);
+        cycles += cycleTable[instruction.opcode];
+        if (--count == 0 || !block->valid || stopRequested || cycles >= deadline) {
+            break;
+        }
+    }
+    return count;
+}
+
+// executeBlock() for blocks containing superinstructions.
+uint64_t CPU::executeFusedBlock(const Block* block, uint64_t count) {
+    const DecodedInstruction* instruction = block->instructions.data();
+    const DecodedInstruction* end = instruction + block->instructions.size();
+    while (instruction != end) {
+        const Superinstruction* superinstruction = instruction->superinstruction;
+        if (superinstruction) {
+            superinstruction->handler(*this, instruction);
+            blockCache->recordSuperinstruction(superinstruction);
+            instruction += superinstruction->length;
+        } else {
+            PC = instruction->nextPC;
+            instruction->handler(*this, instruction->operand);
+            instruction++;
+        }
+        if (!block->valid || stopRequested) {
+            size_t executed = instruction - block->instructions.data();
+            addBaseCycles(block, executed);
+            return count - executed;
+        }
+    }
+    cycles += block->cycles;
+    blockCache->recordFlagUpdatesSkipped(block->flagFreeCount);
+    return count - block->instructions.size();
 }
 
-void CPU::setNegativeFlag(bool flag) {
-    N = flag;
+// Charges the base cycles of a block's first count instructions.
+void CPU::addBaseCycles(const Block* block, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        cycles += cycleTable[block->instructions[i].opcode];
+    }
 }
 
-bool CPU::getUnusedFlag() const {
-    return U;
+void CPU::setExecutionEngine(ExecutionEngine value) {
+    if (variant != CpuVariant::NMOS6502 || traps) {
+        value = ExecutionEngine::Fused;
+    }
+    if (value == ExecutionEngine::Jit && !Jit::isSupported()) {
+        value = ExecutionEngine::Cached;
+    }
+    if (value == ExecutionEngine::Static && !findRecompiledProgram()) {
+        value = ExecutionEngine::Fused;
+    }
+    if (engine == ExecutionEngine::Cycle && value != ExecutionEngine::Cycle) {
+        cycleEngine->finishInstruction();
+    }
+    engine = value;
+    if ((engine == ExecutionEngine::Cached || engine == ExecutionEngine::Jit) && !blockCache) {
+        blockCache.reset(new BlockCache(bus));
+        if (stopMonitor) {
+            blockCache->setBoundaries(stopMonitor->getBreakpointMap());
+        }
+    }
+    if (engine == ExecutionEngine::Jit && !jit) {
+        jit.reset(new Jit(*this, *blockCache));
+    }
+    if (engine == ExecutionEngine::Cycle && !cycleEngine) {
+        cycleEngine.reset(new CycleEngine(*this));
+    }
+    // The program may have been loaded since the runner last checked.
+    if (engine == ExecutionEngine::Static) {
+        if (!recompiledRunner) {
+            recompiledRunner.reset(new RecompiledRunner(*this, bus, *findRecompiledProgram()));
+            if (stopMonitor) {
+                recompiledRunner->setBreakpoints(stopMonitor->getBreakpointMap());
+            }
+        } else {
+            recompiledRunner->validate();
+        }
+    }
 }
 
-void CPU::setUnusedFlag(bool flag) {
-    U = flag;
+ExecutionEngine CPU::getExecutionEngine() const {
+    return engine;
 }
 
-void CPU::setFlags(uint8_t flags) {
-    StatusRegister |= flags;
+CpuVariant CPU::getVariant() const {
+    return variant;
 }
 
-void CPU::clearFlags(uint8_t flags) {
-    StatusRegister &= ~flags;
+void CPU::setTrapRegistry(TrapRegistry* registry) {
+    traps = registry;
+    const DispatchEntry* table = instructionFactory->getDispatchTable(variant);
+    if (!traps) {
+        trapDispatchTable.reset();
+        dispatchTable = table;
+        return;
+    }
+    trapDispatchTable.reset(new DispatchEntry[256]);
+    std::copy(table, table + 256, trapDispatchTable.get());
+    // The registry charges the routine's cycles itself.
+    trapDispatchTable[TrapRegistry::TRAP_OPCODE] = DispatchEntry{&trapHandler, nullptr, nullptr, nullptr, 0};
+    dispatchTable = trapDispatchTable.get();
+    setExecutionEngine(engine);
 }
 
-uint8_t CPU::getStatusRegister()
-{
-    return StatusRegister;
+TrapRegistry* CPU::getTrapRegistry() const {
+    return traps;
 }
 
-void CPU::setStatusRegister(uint8_t value)
-{
-    StatusRegister = value;
+BlockCache* CPU::getBlockCache() const {
+    return blockCache.get();
 }
 
-//Stack Operations
-void CPU::pushStack(uint8_t value) {
-    bus.writeMemory(0x0100 | SP, value);
-    SP--;
+Jit* CPU::getJit() const {
+    return jit.get();
 }
 
-uint8_t CPU::pullStack() {
-    SP++;
-    return bus.readMemory(0x0100 | SP);
+CycleEngine* CPU::getCycleEngine() const {
+    return cycleEngine.get();
 }
 
 void CPU::pushPC() {
@@ -194,7 +552,7 @@ void CPU::printState() {
     std::cout << "SP (Stack Pointer): " << std::hex << (int)SP << std::endl;
     std::cout << "PC (Program Counter): " << std::hex << (int)PC << std::endl;
 
-    std::cout << "Status Register: " << std::bitset<8>(StatusRegister) << std::endl;
+    std::cout << "Status Register: " << std::bitset<8>(getStatusRegister()) << std::endl;
 
     std::cout << "Carry Flag: " << getCarryFlag() << std::endl;
     std::cout << "Zero Flag: " << getZeroFlag() << std::endl;
@@ -218,4 +576,4 @@ void CPU::printFlags() {
     std::cout << "A=" << std::hex << (int)getAccumulator() << " ";
     std::cout << "X=" << std::hex << (int)getX() << " ";
     std::cout << "Y=" << std::hex << (int)getY() << " ";
-    }
\ No newline at end of file
+    }
@@ -1,16 +1,75 @@
 #ifndef CPU_H
 #define CPU_H
  
+#include <atomic>
 #include <cstdint>
+#include <memory>
+#include "Alu.h"
 #include "Bus.h"
 #include "Instruction.h"
 #include "InstructionFactory.h"
+#include "RunControl.h"
+
+enum class ExecutionEngine {
+    Fused,      // per-instruction dispatch through the fused handler table
+    Threaded,   // direct-threaded core, see ThreadedEngine
+    Cached,     // replays predecoded basic blocks, see BlockCache
+    Jit,        // block cache with hot blocks translated to native code, see Jit
+    Cycle,      // one bus access per cycle, dummy accesses included, see CycleEngine
+    Static      // ahead-of-time recompiled code linked into the binary, see Recompiler
+};
+
+// Bits of CPU's pending-interrupt word. The word is zero unless some line
+// needs attention, so the run loops only test it for non-zero.
+enum PendingInterrupt : uint32_t {
+    IRQ_SOURCES = 0xFF,     // one bit per device holding IRQ asserted
+    NMI_PENDING = 0x100,    // latched on the asserting edge of NMI
+    RESET_PENDING = 0x200
+};
+
+// The CPU's state at an instruction boundary, for putting a machine back
+// the way it was; see DirtyPageTracker.
+struct CpuRegisters {
+    uint16_t PC;
+    uint8_t A;
+    uint8_t X;
+    uint8_t Y;
+    uint8_t SP;
+    uint8_t P;
+    uint64_t cycles;
+    uint32_t pendingInterrupts;
+    bool nmiLine;
+};
+
+class BlockCache;
+class Jit;
+class CycleEngine;
+class RecompiledRunner;
+class TrapRegistry;
+struct Block;
 
 class CPU {
 private:
     Bus& bus;
 
     InstructionFactory* instructionFactory;
+    const CpuVariant variant;
+    const DispatchEntry* dispatchTable;
+    const AluTables* aluTables;
+    ExecutionEngine engine;
+    std::unique_ptr<BlockCache> blockCache;
+    std::unique_ptr<Jit> jit;
+    std::unique_ptr<CycleEngine> cycleEngine;
+    std::unique_ptr<RecompiledRunner> recompiledRunner;
+    std::unique_ptr<StopMonitor> stopMonitor;
+    TrapRegistry* traps;
+    // Copy of the variant's dispatch table with the trap opcode routed to
+    // traps, used while a registry is attached.
+    std::unique_ptr<DispatchEntry[]> trapDispatchTable;
+    bool stopRequested;
+    // Written by devices and host threads, read by the run loops.
+    std::atomic<uint32_t> pendingInterrupts;
+    std::atomic<bool> nmiLine;
 
     uint8_t A;
     uint8_t X;
@@ -32,11 +91,88 @@ private:
         uint8_t StatusRegister;
     };
 
+    // C, Z, V and N are kept lazily, outside StatusRegister (whose bits for
+    // them stay clear): Z and N are derived from the last result byte when
+    // read, and C and V are stored unpacked. Setting them is a plain store
+    // instead of a read-modify-write of the status byte; getStatusRegister()
+    // assembles the full byte when PHP, BRK or a caller needs it.
+    uint8_t zeroResult;       // Z is set when this is 0
+    uint8_t negativeResult;   // N is bit 7
+    bool carry;
+    bool overflow;
+
+    uint64_t cycles;
+
+    uint64_t executePartialBlock(const Block* block, uint64_t count, uint64_t deadline = UINT64_MAX);
+    uint64_t executeFusedBlock(const Block* block, uint64_t count);
+    void addBaseCycles(const Block* block, size_t count);
+    RunResult runChecked(uint64_t maxInstructions);
+    RunResult runBlocksChecked(uint64_t maxInstructions);
+    RunResult runRecompiledChecked(uint64_t maxInstructions);
+    LoopState loopState();
+
 public:
-    CPU(Bus& bus);
+    // The variant is fixed for the CPU's lifetime; it picks the dispatch table.
+    CPU(Bus& bus, CpuVariant variant = CpuVariant::NMOS6502);
+    ~CPU();
     
     void reset();
     void execute();
+    // Runs an already fetched opcode, bypassing any trap.
+    void executeOpcode(uint8_t opcode);
+    void executeInstructions(uint64_t count);
+    // Runs up to maxInstructions on the current engine and reports why it
+    // stopped. Without conditions this is executeInstructions(); with them
+    // Cached, Jit and Static check between blocks, native and recompiled
+    // code returning wherever a check is due, and the other engines after
+    // each instruction.
+    RunResult run(uint64_t maxInstructions, const StopConditions& conditions = StopConditions());
+    bool isStopRequested() const;
+    uint64_t executeBlock(const Block* block, uint64_t count);
+
+    // Takes effect at the next instruction boundary: leaving the Cycle engine
+    // first finishes the instruction it is in the middle of. Only the Fused
+    // engine is generated per variant; the others implement the NMOS map, so
+    // a CPU of another variant stays on Fused when asked for them. Static
+    // also falls back to Fused when no recompiled program is linked in.
+    void setExecutionEngine(ExecutionEngine value);
+    ExecutionEngine getExecutionEngine() const;
+    CpuVariant getVariant() const;
+    // ADC and SBC lookup tables for the variant.
+    const AluTables& getAluTables() const;
+    Bus& getBus() const;
+
+    // Interrupt lines, safe to drive from devices and other threads. IRQ is
+    // level-triggered and wired-OR: it stays asserted while any of the eight
+    // sources holds it. NMI is edge-triggered: asserting it latches one NMI,
+    // and it has to be released before it can fire again. Reset is taken at
+    // the next instruction boundary. Every engine polls the pending word
+    // between instructions, or between blocks for Cached, Jit and Static.
+    void setIrqLine(bool asserted, uint8_t source = 0);
+    void setNmiLine(bool asserted);
+    void requestReset();
+    bool hasPendingInterrupts() const;
+    const std::atomic<uint32_t>& getPendingInterrupts() const;
+    // Whether an interrupt would be taken now, given the I flag: a reset or
+    // NMI always is, IRQ only with I clear.
+    bool canTakeInterrupt(bool interruptsDisabled) const;
+    // The vector of the interrupt to take at this boundary, or 0 if there is
+    // none; a returned NMI is cleared from the pending word.
+    uint16_t acknowledgeInterrupt();
+    // Takes the pending interrupt, if any can be taken: reset() for a reset,
+    // otherwise the 7-cycle sequence pushing PC and P (B clear) and
+    // vectoring through $FFFA or $FFFE. Returns true if one was taken. The
+    // interrupt does not count as an instruction.
+    bool serviceInterrupts();
+
+    // Routes TrapRegistry::TRAP_OPCODE to registry, or back to the opcode map
+    // for nullptr. Traps are part of the fused dispatch, so the CPU stays on
+    // the Fused engine while one is attached.
+    void setTrapRegistry(TrapRegistry* registry);
+    TrapRegistry* getTrapRegistry() const;
+    BlockCache* getBlockCache() const;
+    Jit* getJit() const;
+    CycleEngine* getCycleEngine() const;
     
     //Memory Operations
     uint8_t fetch();
@@ -55,6 +191,16 @@ public:
     uint8_t getSP() const;
     void setSP(uint8_t value);
     
+    //Cycle Counting
+    // Base cycles are charged by the engines per instruction or per block;
+    // page-crossing and branch penalties as they happen.
+    uint64_t getCycles() const;
+    void setCycles(uint64_t value);
+    void addCycles(uint32_t count);
+    // Sets PC for a taken branch, charging a cycle and one more when the
+    // target is on a different page than the next instruction.
+    void takeBranch(uint16_t target);
+
     //Status Register and Flags Operations
     bool getCarryFlag() const;
     void setCarryFlag(bool flag);
@@ -72,12 +218,19 @@ public:
     void setNegativeFlag(bool flag);
     bool getUnusedFlag() const;
     void setUnusedFlag(bool flag);
+    // Sets N and Z from an operation's result byte.
+    void setNZ(uint8_t result);
+    // Takes A and C, Z, V and N from an ADC or SBC result.
+    void setAluResult(const AluResult& result);
 
     void setFlags(uint8_t flags);
     void clearFlags(uint8_t flags);
     uint8_t getStatusRegister();
     void setStatusRegister(uint8_t value);
 
+    CpuRegisters getRegisters();
+    void setRegisters(const CpuRegisters& registers);
+
     //Stack Operations
     void pushStack(uint8_t value);
     uint8_t pullStack();
@@ -90,4 +243,211 @@ public:
     void printFlags();
 };
 
+//Memory Operations
+inline uint8_t CPU::fetch() {
+    return bus.readMemory(PC++);
+}
+
+inline uint8_t CPU::read(uint16_t address) {
+    return bus.readMemory(address);
+}
+
+inline void CPU::write(uint16_t address, uint8_t value) {
+    bus.writeMemory(address, value);
+}
+
+inline bool CPU::isStopRequested() const {
+    return stopRequested;
+}
+
+inline bool CPU::hasPendingInterrupts() const {
+    return pendingInterrupts.load(std::memory_order_relaxed) != 0;
+}
+
+inline const std::atomic<uint32_t>& CPU::getPendingInterrupts() const {
+    return pendingInterrupts;
+}
+
+inline bool CPU::canTakeInterrupt(bool interruptsDisabled) const {
+    uint32_t pending = pendingInterrupts.load(std::memory_order_relaxed);
+    return (pending & (NMI_PENDING | RESET_PENDING)) || ((pending & IRQ_SOURCES) && !interruptsDisabled);
+}
+
+//Register Operations
+inline uint8_t CPU::getAccumulator() const {
+    return A;
+}
+
+inline void CPU::setAccumulator(uint8_t value) {
+    A = value;
+}
+
+inline uint8_t CPU::getX() const {
+    return X;
+}
+
+inline void CPU::setX(uint8_t value) {
+    X = value;
+}
+
+inline uint8_t CPU::getY() const {
+    return Y;
+}
+
+inline void CPU::setY(uint8_t value) {
+    Y = value;
+}
+
+inline uint16_t CPU::getPC() const {
+    return PC;
+}
+
+inline void CPU::setPC(uint16_t value) {
+    PC = value;
+}
+
+inline uint8_t CPU::getSP() const {
+    return SP;
+}
+
+inline void CPU::setSP(uint8_t value) {
+    SP = value;
+}
+
+//Cycle Counting
+inline uint64_t CPU::getCycles() const {
+    return cycles;
+}
+
+inline void CPU::setCycles(uint64_t value) {
+    cycles = value;
+}
+
+inline void CPU::addCycles(uint32_t count) {
+    cycles += count;
+}
+
+inline void CPU::takeBranch(uint16_t target) {
+    cycles += 1 + (((PC ^ target) >> 8) != 0);
+    PC = target;
+}
+
+//Status Register and Flags Operations
+inline bool CPU::getCarryFlag() const {
+    return carry;
+}
+
+inline void CPU::setCarryFlag(bool flag) {
+    carry = flag;
+}
+
+inline bool CPU::getZeroFlag() const {
+    return zeroResult == 0;
+}
+
+inline void CPU::setZeroFlag(bool flag) {
+    zeroResult = !flag;
+}
+
+inline bool CPU::getInterruptDisableFlag() const {
+    return I;
+}
+
+inline void CPU::setInterruptDisableFlag(bool flag) {
+    I = flag;
+}
+
+inline bool CPU::getDecimalFlag() const {
+    return D;
+}
+
+inline void CPU::setDecimalFlag(bool flag) {
+    D = flag;
+}
+
+inline bool CPU::getBreakFlag() const {
+    return B;
+}
+
+inline void CPU::setBreakFlag(bool flag) {
+    B = flag;
+}
+
+inline bool CPU::getOverflowFlag() const {
+    return overflow;
+}
+
+inline void CPU::setOverflowFlag(bool flag) {
+    overflow = flag;
+}
+
+inline bool CPU::getNegativeFlag() const {
+    return negativeResult & 0x80;
+}
+
+inline void CPU::setNegativeFlag(bool flag) {
+    negativeResult = flag ? 0x80 : 0;
+}
+
+inline bool CPU::getUnusedFlag() const {
+    return U;
+}
+
+inline void CPU::setUnusedFlag(bool flag) {
+    U = flag;
+}
+
+inline void CPU::setNZ(uint8_t result) {
+    zeroResult = result;
+    negativeResult = result;
+}
+
+inline const AluTables& CPU::getAluTables() const {
+    return *aluTables;
+}
+
+inline Bus& CPU::getBus() const {
+    return bus;
+}
+
+inline void CPU::setAluResult(const AluResult& result) {
+    A = result.value;
+    carry = result.flags & FLAG_C;
+    overflow = result.flags & FLAG_V;
+    zeroResult = ~result.flags & FLAG_Z;
+    negativeResult = result.flags;
+}
+
+inline void CPU::setFlags(uint8_t flags) {
+    setStatusRegister(getStatusRegister() | flags);
+}
+
+inline void CPU::clearFlags(uint8_t flags) {
+    setStatusRegister(getStatusRegister() & ~flags);
+}
+
+inline uint8_t CPU::getStatusRegister() {
+    return StatusRegister | (carry ? FLAG_C : 0) | (zeroResult == 0 ? FLAG_Z : 0) |
+           (overflow ? FLAG_V : 0) | (negativeResult & FLAG_N);
+}
+
+inline void CPU::setStatusRegister(uint8_t value) {
+    StatusRegister = value & (FLAG_I | FLAG_D | FLAG_B | FLAG_U);
+    carry = value & FLAG_C;
+    zeroResult = !(value & FLAG_Z);
+    overflow = value & FLAG_V;
+    negativeResult = value & FLAG_N;
+}
+
+//Stack Operations
+inline void CPU::pushStack(uint8_t value) {
+    bus.writeMemory(0x0100 | SP, value);
+    SP--;
+}
+
+inline uint8_t CPU::pullStack() {
+    SP++;
+    return bus.readMemory(0x0100 | SP);
+}
+
 #endif
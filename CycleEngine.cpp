@@ -0,0 +1,429 @@
+#include "CycleEngine.h"
+#include "FusedHandlers.inl"
+#include <array>
+#include <utility>
+
+namespace {
+
+// Bus cycles after the opcode fetch that it takes to form the effective
+// address, not counting the cycle that fixes up a carry into the high byte.
+constexpr uint8_t addressCycles(AddressingModeType mode) {
+    switch (mode) {
+        case AddressingModeType::ZeroPage: return 1;
+        case AddressingModeType::ZeroPageX: case AddressingModeType::ZeroPageY: return 2;
+        case AddressingModeType::Absolute: return 2;
+        case AddressingModeType::AbsoluteX: case AddressingModeType::AbsoluteY: return 2;
+        case AddressingModeType::IndexedIndirectX: return 4;
+        case AddressingModeType::IndirectIndexedY: return 3;
+        default: return 0;
+    }
+}
+
+constexpr bool indexesWithCarry(AddressingModeType mode) {
+    return mode == AddressingModeType::AbsoluteX || mode == AddressingModeType::AbsoluteY ||
+           mode == AddressingModeType::IndirectIndexedY;
+}
+
+constexpr bool isStore(OperationType operation) {
+    return operation == OperationType::STA || operation == OperationType::STX || operation == OperationType::STY;
+}
+
+inline void dummyRead(CPU& cpu, uint16_t address) {
+    cpu.read(address);
+}
+
+inline bool branchTaken(CPU& cpu, OperationType operation) {
+    switch (operation) {
+        case OperationType::BCC: return !cpu.getCarryFlag();
+        case OperationType::BCS: return cpu.getCarryFlag();
+        case OperationType::BNE: return !cpu.getZeroFlag();
+        case OperationType::BEQ: return cpu.getZeroFlag();
+        case OperationType::BPL: return !cpu.getNegativeFlag();
+        case OperationType::BMI: return cpu.getNegativeFlag();
+        case OperationType::BVC: return !cpu.getOverflowFlag();
+        default: return cpu.getOverflowFlag();
+    }
+}
+
+// The value a read-modify-write instruction writes back, setting its flags
+// as Operation.inl does.
+template <OperationType Operation>
+inline uint8_t modify(CPU& cpu, uint8_t value) {
+    uint8_t result;
+    if constexpr (Operation == OperationType::INC) {
+        result = value + 1;
+    } else if constexpr (Operation == OperationType::DEC) {
+        result = value - 1;
+    } else if constexpr (Operation == OperationType::ASL) {
+        result = value << 1;
+        cpu.setCarryFlag(value & 0x80);
+    } else if constexpr (Operation == OperationType::LSR) {
+        result = value >> 1;
+        cpu.setCarryFlag(value & 0x01);
+    } else if constexpr (Operation == OperationType::ROL) {
+        result = (value << 1) | cpu.getCarryFlag();
+        cpu.setCarryFlag(value & 0x80);
+    } else {
+        result = (cpu.getCarryFlag() << 7) | (value >> 1);
+        cpu.setCarryFlag(value & 0x01);
+    }
+    cpu.setNZ(result);
+    return result;
+}
+
+// One cycle of forming the effective address, for steps 1 to addressCycles().
+template <AddressingModeType Mode>
+inline void addressStep(CPU& cpu, CycleState& state) {
+    if constexpr (Mode == AddressingModeType::ZeroPage) {
+        state.address = cpu.fetch();
+    } else if constexpr (Mode == AddressingModeType::ZeroPageX || Mode == AddressingModeType::ZeroPageY) {
+        if (state.step == 1) {
+            state.address = cpu.fetch();
+        } else {
+            dummyRead(cpu, state.address);
+            uint8_t index = Mode == AddressingModeType::ZeroPageX ? cpu.getX() : cpu.getY();
+            state.address = (state.address + index) & 0xFF;
+        }
+    } else if constexpr (Mode == AddressingModeType::Absolute) {
+        if (state.step == 1) {
+            state.address = cpu.fetch();
+        } else {
+            state.address |= cpu.fetch() << 8;
+        }
+    } else if constexpr (Mode == AddressingModeType::AbsoluteX || Mode == AddressingModeType::AbsoluteY) {
+        if (state.step == 1) {
+            state.data = cpu.fetch();
+        } else {
+            state.base = state.data | (cpu.fetch() << 8);
+            state.address = state.base + (Mode == AddressingModeType::AbsoluteX ? cpu.getX() : cpu.getY());
+        }
+    } else if constexpr (Mode == AddressingModeType::IndexedIndirectX) {
+        switch (state.step) {
+            case 1:
+                state.pointer = cpu.fetch();
+                break;
+            case 2:
+                dummyRead(cpu, state.pointer);
+                state.pointer = (state.pointer + cpu.getX()) & 0xFF;
+                break;
+            case 3:
+                state.address = cpu.read(state.pointer);
+                break;
+            default:
+                state.address |= cpu.read(state.pointer + 1) << 8;
+                break;
+        }
+    } else if constexpr (Mode == AddressingModeType::IndirectIndexedY) {
+        switch (state.step) {
+            case 1:
+                state.pointer = cpu.fetch();
+                break;
+            case 2:
+                state.data = cpu.read(state.pointer);
+                break;
+            default:
+                state.base = state.data | (cpu.read(state.pointer + 1) << 8);
+                state.address = state.base + cpu.getY();
+                break;
+        }
+    }
+}
+
+// Instructions that read, write or read-modify-write an effective address.
+template <uint8_t Opcode>
+inline bool memoryStep(CPU& cpu, CycleState& state) {
+    constexpr OpcodeInfo info = opcodeTable[Opcode];
+    constexpr AddressingModeType mode = info.addressingMode;
+    constexpr uint8_t addressed = addressCycles(mode);
+    constexpr bool readModifyWrite = writesMemory(info) && !isStore(info.operation);
+    typedef typename OperationOf<info.operation>::type Op;
+
+    if (state.step <= addressed) {
+        addressStep<mode>(cpu, state);
+        return false;
+    }
+    uint8_t access = state.step - addressed;
+    if constexpr (indexesWithCarry(mode)) {
+        if (access == 1) {
+            // The address with the index added to its low byte only. Reads
+            // that did not cross a page are done; everything else reads it
+            // and tries again with the high byte fixed.
+            uint16_t unfixed = (state.base & 0xFF00) | (state.address & 0xFF);
+            if constexpr (!writesMemory(info)) {
+                if (unfixed == state.address) {
+                    Op::apply(cpu, state.address);
+                    return true;
+                }
+            }
+            dummyRead(cpu, unfixed);
+            return false;
+        }
+        access--;
+    }
+
+    if constexpr (readModifyWrite) {
+        switch (access) {
+            case 1:
+                state.data = cpu.read(state.address);
+                return false;
+            case 2:
+                // The unmodified value goes back out while the ALU works.
+                cpu.write(state.address, state.data);
+                state.data = modify<info.operation>(cpu, state.data);
+                return false;
+            default:
+                cpu.write(state.address, state.data);
+                return true;
+        }
+    } else {
+        Op::apply(cpu, state.address);
+        return true;
+    }
+}
+
+template <uint8_t Opcode>
+bool cycleHandler(CPU& cpu, CycleState& state) {
+    constexpr OpcodeInfo info = opcodeTable[Opcode];
+    constexpr OperationType operation = info.operation;
+
+    if constexpr (!info.valid) {
+        dummyRead(cpu, cpu.getPC());
+        std::cout << "Invalid opcode: " << std::hex << (int)Opcode << std::dec << std::endl;
+        return true;
+    } else if constexpr (info.addressingMode == AddressingModeType::Immediate) {
+        OperationOf<operation>::type::apply(cpu, ImmediateAddressingMode::resolve(cpu));
+        return true;
+    } else if constexpr (info.addressingMode == AddressingModeType::Relative) {
+        switch (state.step) {
+            case 1:
+                state.data = cpu.fetch();
+                if (!branchTaken(cpu, operation)) {
+                    return true;
+                }
+                state.address = cpu.getPC() + static_cast<int8_t>(state.data);
+                return false;
+            case 2:
+                dummyRead(cpu, cpu.getPC());
+                if (((cpu.getPC() ^ state.address) & 0xFF00) == 0) {
+                    cpu.setPC(state.address);
+                    return true;
+                }
+                cpu.setPC((cpu.getPC() & 0xFF00) | (state.address & 0xFF));
+                return false;
+            default:
+                dummyRead(cpu, cpu.getPC());
+                cpu.setPC(state.address);
+                return true;
+        }
+    } else if constexpr (operation == OperationType::JMP) {
+        switch (state.step) {
+            case 1:
+                state.data = cpu.fetch();
+                return false;
+            case 2:
+                state.pointer = state.data | (cpu.fetch() << 8);
+                if constexpr (info.addressingMode == AddressingModeType::Absolute) {
+                    cpu.setPC(state.pointer);
+                    return true;
+                }
+                return false;
+            case 3:
+                state.data = cpu.read(state.pointer);
+                return false;
+            default:
+                cpu.setPC(state.data | (cpu.read((state.pointer & 0xFF00) | ((state.pointer + 1) & 0xFF)) << 8));
+                return true;
+        }
+    } else if constexpr (operation == OperationType::JSR) {
+        switch (state.step) {
+            case 1:
+                state.data = cpu.fetch();
+                return false;
+            case 2:
+                dummyRead(cpu, 0x0100 | cpu.getSP());
+                return false;
+            case 3:
+                cpu.pushStack(cpu.getPC() >> 8);
+                return false;
+            case 4:
+                cpu.pushStack(cpu.getPC() & 0xFF);
+                return false;
+            default:
+                cpu.setPC(state.data | (cpu.read(cpu.getPC()) << 8));
+                return true;
+        }
+    } else if constexpr (operation == OperationType::BRK) {
+        switch (state.step) {
+            case 1:
+                // BRK skips the byte after it.
+                cpu.fetch();
+                return false;
+            case 2:
+                cpu.pushStack(cpu.getPC() >> 8);
+                return false;
+            case 3:
+                cpu.pushStack(cpu.getPC() & 0xFF);
+                return false;
+            case 4:
+                cpu.setBreakFlag(true);
+                cpu.setUnusedFlag(true);
+                cpu.pushStack(cpu.getStatusRegister());
+                cpu.setInterruptDisableFlag(true);
+                return false;
+            case 5:
+                state.data = cpu.read(0xFFFE);
+                return false;
+            default:
+                cpu.setPC(state.data | (cpu.read(0xFFFF) << 8));
+                return true;
+        }
+    } else if constexpr (operation == OperationType::RTS || operation == OperationType::RTI) {
+        switch (state.step) {
+            case 1:
+                dummyRead(cpu, cpu.getPC());
+                return false;
+            case 2:
+                dummyRead(cpu, 0x0100 | cpu.getSP());
+                return false;
+            case 3:
+                if constexpr (operation == OperationType::RTI) {
+                    cpu.setStatusRegister(cpu.pullStack());
+                } else {
+                    state.data = cpu.pullStack();
+                }
+                return false;
+            case 4:
+                if constexpr (operation == OperationType::RTI) {
+                    state.data = cpu.pullStack();
+                } else {
+                    cpu.setPC(state.data | (cpu.pullStack() << 8));
+                }
+                return false;
+            default:
+                if constexpr (operation == OperationType::RTI) {
+                    cpu.setPC(state.data | (cpu.pullStack() << 8));
+                } else {
+                    dummyRead(cpu, cpu.getPC());
+                    cpu.setPC(cpu.getPC() + 1);
+                }
+                return true;
+        }
+    } else if constexpr (operation == OperationType::PHA || operation == OperationType::PHP) {
+        if (state.step == 1) {
+            dummyRead(cpu, cpu.getPC());
+            return false;
+        }
+        OperationOf<operation>::type::apply(cpu, 0);
+        return true;
+    } else if constexpr (operation == OperationType::PLA || operation == OperationType::PLP) {
+        switch (state.step) {
+            case 1:
+                dummyRead(cpu, cpu.getPC());
+                return false;
+            case 2:
+                dummyRead(cpu, 0x0100 | cpu.getSP());
+                return false;
+            default:
+                OperationOf<operation>::type::apply(cpu, 0);
+                return true;
+        }
+    } else if constexpr (info.addressingMode == AddressingModeType::Accumulator) {
+        dummyRead(cpu, cpu.getPC());
+        OperationOf<operation>::type::applyAccumulator(cpu);
+        return true;
+    } else if constexpr (info.addressingMode == AddressingModeType::Implied) {
+        dummyRead(cpu, cpu.getPC());
+        OperationOf<operation>::type::apply(cpu, 0);
+        return true;
+    } else {
+        return memoryStep<Opcode>(cpu, state);
+    }
+}
+
+// One cycle of an IRQ or NMI: the opcode fetch and the read of the next
+// byte are discarded, then PC and P go on the stack as for BRK but with B
+// clear. Returns true on the last cycle.
+inline bool interruptStep(CPU& cpu, CycleState& state) {
+    switch (state.step) {
+        case 0:
+        case 1:
+            dummyRead(cpu, cpu.getPC());
+            return false;
+        case 2:
+            cpu.pushStack(cpu.getPC() >> 8);
+            return false;
+        case 3:
+            cpu.pushStack(cpu.getPC() & 0xFF);
+            return false;
+        case 4:
+            cpu.pushStack((cpu.getStatusRegister() & ~FLAG_B) | FLAG_U);
+            cpu.setInterruptDisableFlag(true);
+            return false;
+        case 5:
+            state.data = cpu.read(state.vector);
+            return false;
+        default:
+            cpu.setPC(state.data | (cpu.read(state.vector + 1) << 8));
+            return true;
+    }
+}
+
+template <std::size_t... Opcodes>
+constexpr std::array<CycleHandler, 256> makeCycleHandlerTable(std::index_sequence<Opcodes...>) {
+    return {{ &cycleHandler<static_cast<uint8_t>(Opcodes)>... }};
+}
+
+const std::array<CycleHandler, 256> cycleHandlerTable = makeCycleHandlerTable(std::make_index_sequence<256>());
+
+}
+
+CycleEngine::CycleEngine(CPU& cpu) : cpu(cpu), state{} {}
+
+bool CycleEngine::tick() {
+    if (state.step == 0 && cpu.hasPendingInterrupts()) {
+        state.vector = cpu.acknowledgeInterrupt();
+        if (state.vector == 0xFFFC) {
+            cpu.reset();
+            return false;
+        }
+    }
+    cpu.addCycles(1);
+    if (state.vector) {
+        if (interruptStep(cpu, state)) {
+            state.step = 0;
+            state.vector = 0;
+        } else {
+            state.step++;
+        }
+        return false;
+    }
+    if (state.step == 0) {
+        state.opcode = cpu.fetch();
+        state.step = 1;
+        return false;
+    }
+    if (cycleHandlerTable[state.opcode](cpu, state)) {
+        state.step = 0;
+        return true;
+    }
+    state.step++;
+    return false;
+}
+
+void CycleEngine::run(uint64_t count) {
+    while (count > 0) {
+        if (tick()) {
+            count--;
+        }
+    }
+}
+
+void CycleEngine::finishInstruction() {
+    while (state.step != 0) {
+        tick();
+    }
+}
+
+void CycleEngine::reset() {
+    state = CycleState{};
+}
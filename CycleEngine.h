@@ -0,0 +1,65 @@
+#ifndef CYCLEENGINE_H
+#define CYCLEENGINE_H
+
+#include <cstdint>
+
+class CPU;
+
+// Where the cycle-stepped engine is inside the current instruction. step is
+// the number of bus cycles of the instruction already run, 0 meaning the CPU
+// is at an instruction boundary and the next cycle fetches an opcode.
+// address, base and data hold whatever the instruction has latched so far.
+// vector is non-zero while an interrupt sequence runs in place of an
+// instruction.
+struct CycleState {
+    uint8_t opcode;
+    uint8_t step;
+    uint8_t data;
+    uint16_t pointer;
+    uint16_t base;
+    uint16_t address;
+    uint16_t vector;
+};
+
+// Runs one bus cycle of the instruction in state.opcode (step 1 onwards) and
+// returns true on its last cycle.
+typedef bool (*CycleHandler)(CPU& cpu, CycleState& state);
+
+// Cycle-stepped interpreter. Every tick() performs exactly one bus access and
+// counts one cycle, in the order and at the addresses the NMOS 6502 uses:
+// the dummy reads of indexed and implied addressing, the read of the
+// unfixed address when indexing carries into the high byte, and the double
+// write of read-modify-write instructions. Architectural results match the
+// other engines, so the CPU can switch engines at any instruction boundary.
+class CycleEngine {
+private:
+    CPU& cpu;
+    CycleState state;
+
+public:
+    explicit CycleEngine(CPU& cpu);
+
+    // Returns true when the cycle completed an instruction. Pending
+    // interrupts are taken at instruction boundaries, as a 7-cycle sequence
+    // that does not count as an instruction; a reset is taken at once.
+    bool tick();
+    // Runs count instructions, finishing a partly run one first (it counts).
+    void run(uint64_t count);
+    // Ticks until the CPU is at an instruction boundary.
+    void finishInstruction();
+    // Drops a partly run instruction, for CPU::reset().
+    void reset();
+
+    bool atInstructionBoundary() const;
+    const CycleState& getState() const;
+};
+
+inline bool CycleEngine::atInstructionBoundary() const {
+    return state.step == 0;
+}
+
+inline const CycleState& CycleEngine::getState() const {
+    return state;
+}
+
+#endif
@@ -0,0 +1,53 @@
+#include "DirtyPageTracker.h"
+#include <cstring>
+
+DirtyPageTracker::DirtyPageTracker(CPU& cpu, Memory& memory)
+    : cpu(cpu), bus(cpu.getBus()), memory(memory), watchSlot(bus.addWriteWatcher(this)),
+      baseline(new uint8_t[0x10000]), registers{}, dirty{}, dirtyCount(0) {
+    captureBaseline();
+}
+
+DirtyPageTracker::~DirtyPageTracker() {
+    bus.removeWriteWatcher(watchSlot);
+}
+
+void DirtyPageTracker::captureBaseline() {
+    std::memcpy(baseline.get(), &memory[0], 0x10000);
+    registers = cpu.getRegisters();
+    std::memset(dirty, 0, sizeof(dirty));
+    dirtyCount = 0;
+    for (int page = 0; page < 256; page++) {
+        bus.watchPage(watchSlot, page, true);
+    }
+}
+
+// Written pages that still hold what they started with are left alone, so
+// code cached from them stays valid across runs.
+void DirtyPageTracker::resetToBaseline() {
+    for (int i = 0; i < dirtyCount; i++) {
+        uint8_t page = dirtyList[i];
+        uint8_t* current = &memory[page << 8];
+        const uint8_t* original = baseline.get() + (page << 8);
+        dirty[page] = false;
+        bus.watchPage(watchSlot, page, true);
+        if (std::memcmp(current, original, 256) != 0) {
+            std::memcpy(current, original, 256);
+            bus.notifyRemap(page);
+        }
+    }
+    dirtyCount = 0;
+    cpu.setRegisters(registers);
+}
+
+int DirtyPageTracker::getDirtyPageCount() const {
+    return dirtyCount;
+}
+
+void DirtyPageTracker::onWatchedWrite(uint16_t address) {
+    uint8_t page = address >> 8;
+    if (!dirty[page]) {
+        dirty[page] = true;
+        dirtyList[dirtyCount++] = page;
+        bus.watchPage(watchSlot, page, false);
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef DIRTYPAGETRACKER_H
+#define DIRTYPAGETRACKER_H
+
+#include <cstdint>
+#include <memory>
+#include "Bus.h"
+#include "CPU.h"
+#include "Memory.h"
+
+// Puts a machine back to a captured baseline by copying back only the
+// pages written through the bus since, for running the same program over
+// and over with different inputs. A page is watched until its first write, which marks
+// it dirty and unwatches it, so the write path pays for the tracking once
+// per page and run and then stores directly again. Engines that cache code
+// are told about restored pages whose contents actually changed.
+//
+// The baseline covers the CPU registers and the Memory; pages mapped onto
+// other host memory, such as RAM banks, and device state are not restored.
+class DirtyPageTracker : public WriteWatcher {
+private:
+    CPU& cpu;
+    Bus& bus;
+    Memory& memory;
+    int watchSlot;
+    std::unique_ptr<uint8_t[]> baseline;
+    CpuRegisters registers;
+    bool dirty[256];
+    uint8_t dirtyList[256];
+    int dirtyCount;
+
+public:
+    // The tracker needs a free write watcher slot on the CPU's bus.
+    DirtyPageTracker(CPU& cpu, Memory& memory);
+    ~DirtyPageTracker() override;
+    DirtyPageTracker(const DirtyPageTracker&) = delete;
+    DirtyPageTracker& operator=(const DirtyPageTracker&) = delete;
+
+    // Takes the current state as the baseline, between instructions.
+    void captureBaseline();
+    // Restores the registers and the pages written since the baseline.
+    void resetToBaseline();
+    int getDirtyPageCount() const;
+    void onWatchedWrite(uint16_t address) override;
+};
+
+#endif
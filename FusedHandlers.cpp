@@ -0,0 +1,61 @@
+#include "FusedHandlers.h"
+#include "FusedHandlers.inl"
+#include <utility>
+
+namespace {
+
+template <typename Variant, uint8_t Opcode>
+void fusedHandler(CPU& cpu) {
+    constexpr OpcodeInfo info = variantOpcodeTable<Variant>[Opcode];
+
+    cpu.addCycles(variantCycleTable<Variant>[Opcode]);
+    if constexpr (!info.valid) {
+        std::cout << "Invalid opcode: " << std::hex << (int)Opcode << std::dec << std::endl;
+    } else if constexpr (info.addressingMode == AddressingModeType::Accumulator) {
+        OperationOf<info.operation>::type::applyAccumulator(cpu);
+    } else {
+        typedef typename AddressingModeOf<info.addressingMode>::type Mode;
+        typedef typename OperationOf<info.operation>::type Op;
+        if constexpr (hasPageCrossPenalty(info)) {
+            Op::apply(cpu, Mode::resolveForRead(cpu));
+        } else {
+            Op::apply(cpu, Mode::resolve(cpu));
+        }
+    }
+}
+
+template <uint8_t Opcode>
+constexpr PredecodedHandler flagFreeEntry() {
+    if constexpr (hasFlagFreeHandler<Opcode>()) {
+        return &flagFreeHandler<Opcode>;
+    } else {
+        return nullptr;
+    }
+}
+
+template <typename Variant, std::size_t... Opcodes>
+constexpr std::array<FusedHandler, 256> makeFusedHandlerTable(std::index_sequence<Opcodes...>) {
+    return {{ &fusedHandler<Variant, static_cast<uint8_t>(Opcodes)>... }};
+}
+
+template <std::size_t... Opcodes>
+constexpr std::array<PredecodedHandler, 256> makePredecodedHandlerTable(std::index_sequence<Opcodes...>) {
+    return {{ &predecodedHandler<static_cast<uint8_t>(Opcodes)>... }};
+}
+
+template <std::size_t... Opcodes>
+constexpr std::array<PredecodedHandler, 256> makeFlagFreeHandlerTable(std::index_sequence<Opcodes...>) {
+    return {{ flagFreeEntry<static_cast<uint8_t>(Opcodes)>()... }};
+}
+
+}
+
+const std::array<FusedHandler, 256> fusedHandlerTable = makeFusedHandlerTable<NMOS6502>(std::make_index_sequence<256>());
+
+const std::array<FusedHandler, 256> fusedHandlerTable65C02 = makeFusedHandlerTable<WDC65C02>(std::make_index_sequence<256>());
+
+const std::array<FusedHandler, 256> fusedHandlerTable2A03 = makeFusedHandlerTable<Ricoh2A03>(std::make_index_sequence<256>());
+
+const std::array<PredecodedHandler, 256> predecodedHandlerTable = makePredecodedHandlerTable(std::make_index_sequence<256>());
+
+const std::array<PredecodedHandler, 256> flagFreeHandlerTable = makeFlagFreeHandlerTable(std::make_index_sequence<256>());
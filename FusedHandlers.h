@@ -0,0 +1,28 @@
+#ifndef FUSEDHANDLERS_H
+#define FUSEDHANDLERS_H
+
+#include <array>
+#include "InstructionFactory.h"
+
+// One handler per opcode, each instantiated from the (addressing mode,
+// operation) pair in opcodeTable. The static resolve/apply functions are
+// called directly, so every pair is inlined and specialised by the compiler
+// instead of going through two virtual calls.
+extern const std::array<FusedHandler, 256> fusedHandlerTable;
+
+// The same, generated from the 65C02 and 2A03 opcode maps.
+extern const std::array<FusedHandler, 256> fusedHandlerTable65C02;
+extern const std::array<FusedHandler, 256> fusedHandlerTable2A03;
+
+// Same pairs from the NMOS map, for instructions whose operand bytes were
+// extracted at decode time. PC must already point past the instruction when
+// one of these runs.
+typedef void (*PredecodedHandler)(CPU& cpu, uint16_t operand);
+
+extern const std::array<PredecodedHandler, 256> predecodedHandlerTable;
+
+// Predecoded handlers that skip every status flag update, or nullptr where an
+// opcode has no such form. Only valid where the flags written are known dead.
+extern const std::array<PredecodedHandler, 256> flagFreeHandlerTable;
+
+#endif
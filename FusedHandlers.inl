@@ -0,0 +1,224 @@
+#ifndef FUSEDHANDLERS_INL
+#define FUSEDHANDLERS_INL
+
+#include "AddressingMode.inl"
+#include "Operation.inl"
+#include "OpcodeTable.h"
+#include "CPU.h"
+#include <iostream>
+
+// Maps the opcode table's enums onto the classes implementing them, for code
+// that instantiates handlers from opcodeTable.
+template <AddressingModeType Mode> struct AddressingModeOf;
+template <> struct AddressingModeOf<AddressingModeType::Implied> { typedef ImpliedAddressingMode type; };
+template <> struct AddressingModeOf<AddressingModeType::Immediate> { typedef ImmediateAddressingMode type; };
+template <> struct AddressingModeOf<AddressingModeType::Relative> { typedef RelativeAddressingMode type; };
+template <> struct AddressingModeOf<AddressingModeType::ZeroPage> { typedef ZeroPageAddressingMode type; };
+template <> struct AddressingModeOf<AddressingModeType::ZeroPageX> { typedef ZeroPageXAddressingMode type; };
+template <> struct AddressingModeOf<AddressingModeType::ZeroPageY> { typedef ZeroPageYAddressingMode type; };
+template <> struct AddressingModeOf<AddressingModeType::Absolute> { typedef AbsoluteAddressingMode type; };
+template <> struct AddressingModeOf<AddressingModeType::AbsoluteX> { typedef AbsoluteXAddressingMode type; };
+template <> struct AddressingModeOf<AddressingModeType::AbsoluteY> { typedef AbsoluteYAddressingMode type; };
+template <> struct AddressingModeOf<AddressingModeType::Indirect> { typedef IndirectAddressingMode type; };
+template <> struct AddressingModeOf<AddressingModeType::IndexedIndirectX> { typedef IndexedIndirectXAddressingMode type; };
+template <> struct AddressingModeOf<AddressingModeType::IndirectIndexedY> { typedef IndirectIndexedYAddressingMode type; };
+template <> struct AddressingModeOf<AddressingModeType::ZeroPageIndirect> { typedef ZeroPageIndirectAddressingMode type; };
+template <> struct AddressingModeOf<AddressingModeType::IndirectNoWrap> { typedef IndirectNoWrapAddressingMode type; };
+
+template <OperationType Op> struct OperationOf;
+template <> struct OperationOf<OperationType::LDA> { typedef LDAOperation type; };
+template <> struct OperationOf<OperationType::LDX> { typedef LDXOperation type; };
+template <> struct OperationOf<OperationType::LDY> { typedef LDYOperation type; };
+template <> struct OperationOf<OperationType::STA> { typedef STAOperation type; };
+template <> struct OperationOf<OperationType::STX> { typedef STXOperation type; };
+template <> struct OperationOf<OperationType::STY> { typedef STYOperation type; };
+template <> struct OperationOf<OperationType::ADC> { typedef ADCOperation type; };
+template <> struct OperationOf<OperationType::SBC> { typedef SBCOperation type; };
+template <> struct OperationOf<OperationType::CMP> { typedef CMPOperation type; };
+template <> struct OperationOf<OperationType::CPX> { typedef CPXOperation type; };
+template <> struct OperationOf<OperationType::CPY> { typedef CPYOperation type; };
+template <> struct OperationOf<OperationType::AND> { typedef ANDOperation type; };
+template <> struct OperationOf<OperationType::ORA> { typedef ORAOperation type; };
+template <> struct OperationOf<OperationType::EOR> { typedef EOROperation type; };
+template <> struct OperationOf<OperationType::BIT> { typedef BITOperation type; };
+template <> struct OperationOf<OperationType::INC> { typedef INCOperation type; };
+template <> struct OperationOf<OperationType::DEC> { typedef DECOperation type; };
+template <> struct OperationOf<OperationType::INX> { typedef INXOperation type; };
+template <> struct OperationOf<OperationType::INY> { typedef INYOperation type; };
+template <> struct OperationOf<OperationType::DEX> { typedef DEXOperation type; };
+template <> struct OperationOf<OperationType::DEY> { typedef DEYOperation type; };
+template <> struct OperationOf<OperationType::ASL> { typedef ASLOperation type; };
+template <> struct OperationOf<OperationType::LSR> { typedef LSROperation type; };
+template <> struct OperationOf<OperationType::ROR> { typedef ROROperation type; };
+template <> struct OperationOf<OperationType::ROL> { typedef ROLOperation type; };
+template <> struct OperationOf<OperationType::BCC> { typedef BCCOperation type; };
+template <> struct OperationOf<OperationType::BCS> { typedef BCSOperation type; };
+template <> struct OperationOf<OperationType::BEQ> { typedef BEQOperation type; };
+template <> struct OperationOf<OperationType::BNE> { typedef BNEOperation type; };
+template <> struct OperationOf<OperationType::BMI> { typedef BMIOperation type; };
+template <> struct OperationOf<OperationType::BPL> { typedef BPLOperation type; };
+template <> struct OperationOf<OperationType::BVC> { typedef BVCOperation type; };
+template <> struct OperationOf<OperationType::BVS> { typedef BVSOperation type; };
+template <> struct OperationOf<OperationType::CLC> { typedef CLCOperation type; };
+template <> struct OperationOf<OperationType::SEC> { typedef SECOperation type; };
+template <> struct OperationOf<OperationType::CLD> { typedef CLDOperation type; };
+template <> struct OperationOf<OperationType::SED> { typedef SEDOperation type; };
+template <> struct OperationOf<OperationType::CLI> { typedef CLIOperation type; };
+template <> struct OperationOf<OperationType::SEI> { typedef SEIOperation type; };
+template <> struct OperationOf<OperationType::CLV> { typedef CLVOperation type; };
+template <> struct OperationOf<OperationType::JMP> { typedef JMPOperation type; };
+template <> struct OperationOf<OperationType::JSR> { typedef JSROperation type; };
+template <> struct OperationOf<OperationType::RTS> { typedef RTSOperation type; };
+template <> struct OperationOf<OperationType::NOP> { typedef NOPOperation type; };
+template <> struct OperationOf<OperationType::BRK> { typedef BRKOperation type; };
+template <> struct OperationOf<OperationType::RTI> { typedef RTIOperation type; };
+template <> struct OperationOf<OperationType::TAX> { typedef TAXOperation type; };
+template <> struct OperationOf<OperationType::TAY> { typedef TAYOperation type; };
+template <> struct OperationOf<OperationType::TXA> { typedef TXAOperation type; };
+template <> struct OperationOf<OperationType::TYA> { typedef TYAOperation type; };
+template <> struct OperationOf<OperationType::TXS> { typedef TXSOperation type; };
+template <> struct OperationOf<OperationType::TSX> { typedef TSXOperation type; };
+template <> struct OperationOf<OperationType::PHA> { typedef PHAOperation type; };
+template <> struct OperationOf<OperationType::PHP> { typedef PHPOperation type; };
+template <> struct OperationOf<OperationType::PLA> { typedef PLAOperation type; };
+template <> struct OperationOf<OperationType::PLP> { typedef PLPOperation type; };
+template <> struct OperationOf<OperationType::BRA> { typedef BRAOperation type; };
+template <> struct OperationOf<OperationType::STZ> { typedef STZOperation type; };
+template <> struct OperationOf<OperationType::PHX> { typedef PHXOperation type; };
+template <> struct OperationOf<OperationType::PHY> { typedef PHYOperation type; };
+template <> struct OperationOf<OperationType::PLX> { typedef PLXOperation type; };
+template <> struct OperationOf<OperationType::PLY> { typedef PLYOperation type; };
+template <> struct OperationOf<OperationType::TRB> { typedef TRBOperation type; };
+template <> struct OperationOf<OperationType::TSB> { typedef TSBOperation type; };
+
+// Effective address of an instruction whose operand was extracted at decode
+// time, charging the page-crossing cycle where the opcode has one.
+template <uint8_t Opcode>
+inline uint16_t predecodedAddress(CPU& cpu, uint16_t operand) {
+    constexpr OpcodeInfo info = opcodeTable[Opcode];
+    typedef typename AddressingModeOf<info.addressingMode>::type Mode;
+
+    if constexpr (hasPageCrossPenalty(info)) {
+        return Mode::fromOperandForRead(cpu, operand);
+    } else {
+        return Mode::fromOperand(cpu, operand);
+    }
+}
+
+// Executes one instruction whose operand was extracted at decode time. PC
+// must already point past the instruction. The instruction's base cycles
+// are left to the caller, which charges a whole block at once.
+template <uint8_t Opcode>
+inline void predecodedHandler(CPU& cpu, uint16_t operand) {
+    constexpr OpcodeInfo info = opcodeTable[Opcode];
+
+    if constexpr (!info.valid) {
+        std::cout << "Invalid opcode: " << std::hex << (int)Opcode << std::dec << std::endl;
+    } else if constexpr (info.addressingMode == AddressingModeType::Accumulator) {
+        OperationOf<info.operation>::type::applyAccumulator(cpu);
+    } else {
+        typedef typename OperationOf<info.operation>::type Op;
+        Op::apply(cpu, predecodedAddress<Opcode>(cpu, operand));
+    }
+}
+
+// Forms of operations with every flag update left out, for decoded code that
+// has proved those flags dead. Compares and BIT keep only their operand
+// read, so reads with side effects still happen.
+template <OperationType Op> struct WithoutFlags { static const bool available = false; };
+
+template <> struct WithoutFlags<OperationType::LDA> {
+    static const bool available = true;
+    static void apply(CPU& cpu, uint16_t address) { cpu.setAccumulator(cpu.read(address)); }
+};
+template <> struct WithoutFlags<OperationType::LDX> {
+    static const bool available = true;
+    static void apply(CPU& cpu, uint16_t address) { cpu.setX(cpu.read(address)); }
+};
+template <> struct WithoutFlags<OperationType::LDY> {
+    static const bool available = true;
+    static void apply(CPU& cpu, uint16_t address) { cpu.setY(cpu.read(address)); }
+};
+template <> struct WithoutFlags<OperationType::AND> {
+    static const bool available = true;
+    static void apply(CPU& cpu, uint16_t address) { cpu.setAccumulator(cpu.getAccumulator() & cpu.read(address)); }
+};
+template <> struct WithoutFlags<OperationType::ORA> {
+    static const bool available = true;
+    static void apply(CPU& cpu, uint16_t address) { cpu.setAccumulator(cpu.getAccumulator() | cpu.read(address)); }
+};
+template <> struct WithoutFlags<OperationType::EOR> {
+    static const bool available = true;
+    static void apply(CPU& cpu, uint16_t address) { cpu.setAccumulator(cpu.getAccumulator() ^ cpu.read(address)); }
+};
+template <> struct WithoutFlags<OperationType::INX> {
+    static const bool available = true;
+    static void apply(CPU& cpu, uint16_t) { cpu.setX(cpu.getX() + 1); }
+};
+template <> struct WithoutFlags<OperationType::INY> {
+    static const bool available = true;
+    static void apply(CPU& cpu, uint16_t) { cpu.setY(cpu.getY() + 1); }
+};
+template <> struct WithoutFlags<OperationType::DEX> {
+    static const bool available = true;
+    static void apply(CPU& cpu, uint16_t) { cpu.setX(cpu.getX() - 1); }
+};
+template <> struct WithoutFlags<OperationType::DEY> {
+    static const bool available = true;
+    static void apply(CPU& cpu, uint16_t) { cpu.setY(cpu.getY() - 1); }
+};
+template <> struct WithoutFlags<OperationType::TAX> {
+    static const bool available = true;
+    static void apply(CPU& cpu, uint16_t) { cpu.setX(cpu.getAccumulator()); }
+};
+template <> struct WithoutFlags<OperationType::TAY> {
+    static const bool available = true;
+    static void apply(CPU& cpu, uint16_t) { cpu.setY(cpu.getAccumulator()); }
+};
+template <> struct WithoutFlags<OperationType::TXA> {
+    static const bool available = true;
+    static void apply(CPU& cpu, uint16_t) { cpu.setAccumulator(cpu.getX()); }
+};
+template <> struct WithoutFlags<OperationType::TYA> {
+    static const bool available = true;
+    static void apply(CPU& cpu, uint16_t) { cpu.setAccumulator(cpu.getY()); }
+};
+template <> struct WithoutFlags<OperationType::CMP> {
+    static const bool available = true;
+    static void apply(CPU& cpu, uint16_t address) { cpu.read(address); }
+};
+template <> struct WithoutFlags<OperationType::CPX> {
+    static const bool available = true;
+    static void apply(CPU& cpu, uint16_t address) { cpu.read(address); }
+};
+template <> struct WithoutFlags<OperationType::CPY> {
+    static const bool available = true;
+    static void apply(CPU& cpu, uint16_t address) { cpu.read(address); }
+};
+template <> struct WithoutFlags<OperationType::BIT> {
+    static const bool available = true;
+    static void apply(CPU& cpu, uint16_t address) { cpu.read(address); }
+};
+template <> struct WithoutFlags<OperationType::INC> {
+    static const bool available = true;
+    static void apply(CPU& cpu, uint16_t address) { cpu.write(address, cpu.read(address) + 1); }
+};
+template <> struct WithoutFlags<OperationType::DEC> {
+    static const bool available = true;
+    static void apply(CPU& cpu, uint16_t address) { cpu.write(address, cpu.read(address) - 1); }
+};
+
+// Flag-free counterpart of predecodedHandler, for opcodes with a WithoutFlags form.
+template <uint8_t Opcode>
+inline void flagFreeHandler(CPU& cpu, uint16_t operand) {
+    constexpr OpcodeInfo info = opcodeTable[Opcode];
+    WithoutFlags<info.operation>::apply(cpu, predecodedAddress<Opcode>(cpu, operand));
+}
+
+template <uint8_t Opcode>
+constexpr bool hasFlagFreeHandler() {
+    constexpr OpcodeInfo info = opcodeTable[Opcode];
+    return info.valid && info.addressingMode != AddressingModeType::Accumulator && WithoutFlags<info.operation>::available;
+}
+
+#endif
@@ -1,9 +1,26 @@
 #ifndef INSTRUCTIONFACTORY_H
 #define INSTRUCTIONFACTORY_H
 
-#include <unordered_map>
 #include <cstdint>
 #include "Instruction.h"
+#include "OpcodeTable.h"
+
+class CPU;
+
+typedef void (*FusedHandler)(CPU& cpu);
+
+// Resolved decode for one opcode. accumulatorOperation is only set for the
+// accumulator forms of ASL/LSR/ROL/ROR; an entry with no operation is invalid.
+// handler is the fused fast path and is set for every opcode, including the
+// invalid ones, which report themselves. handler charges the base cycles
+// itself; callers of the virtual objects add cycles on their own.
+struct DispatchEntry {
+    FusedHandler handler;
+    AddressingMode* addressingMode;
+    Operation* operation;
+    AccumulatorOperation* accumulatorOperation;
+    uint8_t cycles;
+};
 
 class InstructionFactory {
 private:
@@ -19,6 +36,8 @@ private:
     IndexedIndirectXAddressingMode indexedIndirectX;
     IndirectIndexedYAddressingMode indirectIndexedY;
     RelativeAddressingMode relative;
+    ZeroPageIndirectAddressingMode zeroPageIndirect;
+    IndirectNoWrapAddressingMode indirectNoWrap;
 
     LDAOperation lda;
     LDXOperation ldx;
@@ -76,38 +95,29 @@ private:
     PHPOperation php;
     PLAOperation pla;
     PLPOperation plp;
-
-    enum class AddressingModeType {
-    Implied, Immediate, Relative,
-    ZeroPage, ZeroPageX, ZeroPageY,
-    Absolute, AbsoluteX, AbsoluteY,
-    Indirect, IndexedIndirectX, IndirectIndexedY,
-    Accumulator
-    };
-
-    enum class OperationType {
-    LDA, LDX, LDY, STA, STX, STY,
-    ADC, SBC, CMP, CPX, CPY,
-    AND, ORA, EOR, BIT,
-    INC, DEC, INX, INY, DEX, DEY,
-    ASL, LSR, ROR, ROL,
-    BCC, BCS, BEQ, BNE, BMI, BPL, BVC, BVS,
-    CLC, SEC, CLD, SED, CLI, SEI, CLV,
-    JMP, JSR, RTS,
-    NOP, BRK, RTI,
-    TAX, TAY, TXA, TYA,
-    TXS, TSX, PHA, PHP, PLA, PLP
-    };
+    BRAOperation bra;
+    STZOperation stz;
+    PHXOperation phx;
+    PHYOperation phy;
+    PLXOperation plx;
+    PLYOperation ply;
+    TRBOperation trb;
+    TSBOperation tsb;
 
     static InstructionFactory* instance;
 
-    std::unordered_map<uint8_t, std::pair<AddressingModeType, OperationType>> instructionMap;
+    // One table per CpuVariant, indexed by its enum value.
+    DispatchEntry dispatchTables[3][256];
     AddressingMode* getAddressingMode(AddressingModeType addressingModeType);
     Operation* getOperation(OperationType operationType);
+    template <typename Variant>
+    void buildDispatchTable(const std::array<FusedHandler, 256>& handlers);
     InstructionFactory();
 
 public:
+    // Decodes with the NMOS opcode map.
     Instruction* createInstruction(uint8_t opcode);
+    const DispatchEntry* getDispatchTable(CpuVariant variant = CpuVariant::NMOS6502) const;
     static InstructionFactory* getInstance();
     ~InstructionFactory();
 };
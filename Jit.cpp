@@ -0,0 +1,1029 @@
+#include "Jit.h"
+#include "CPU.h"
+#include "OpcodeTable.h"
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#if defined(__x86_64__) && (defined(__linux__) || defined(__APPLE__))
+#define JIT_X86_64 1
+#include <sys/mman.h>
+#endif
+
+#ifdef JIT_X86_64
+
+namespace {
+
+enum HostRegister : uint8_t {
+    RAX = 0, RCX = 1, RDX = 2, RBX = 3, RSP = 4, RBP = 5, RSI = 6, RDI = 7,
+    R12 = 12, R13 = 13, R14 = 14, R15 = 15
+};
+
+// Pinned for the lifetime of native code: rbx holds the JitContext, rbp the
+// N/Z lookup table, and A, X, Y and P live in the callee-saved r12-r15 so
+// they survive calls back into C++.
+const uint8_t REG_A = R12;
+const uint8_t REG_X = R13;
+const uint8_t REG_Y = R14;
+const uint8_t REG_P = R15;
+
+const uint8_t CC_OVERFLOW = 0x0;
+const uint8_t CC_CARRY = 0x2;
+const uint8_t CC_NOT_CARRY = 0x3;
+const uint8_t CC_ZERO = 0x4;
+const uint8_t CC_NOT_ZERO = 0x5;
+
+const uint8_t ALU_OR = 1, ALU_AND = 4;
+const uint8_t OP_OR = 0x08, OP_ADC = 0x10, OP_SBB = 0x18, OP_AND = 0x20, OP_SUB = 0x28, OP_XOR = 0x30, OP_TEST = 0x84, OP_MOV = 0x88;
+const uint8_t SHIFT_RCL = 2, SHIFT_RCR = 3, SHIFT_SHL = 4, SHIFT_SHR = 5;
+
+const uint8_t CTX_REMAINING = offsetof(JitContext, remaining);
+const uint8_t CTX_CYCLES = offsetof(JitContext, cycles);
+const uint8_t CTX_A = offsetof(JitContext, A);
+const uint8_t CTX_X = offsetof(JitContext, X);
+const uint8_t CTX_Y = offsetof(JitContext, Y);
+const uint8_t CTX_P = offsetof(JitContext, P);
+const uint8_t CTX_PC = offsetof(JitContext, PC);
+const uint8_t CTX_INVALIDATED = offsetof(JitContext, invalidated);
+const uint8_t CTX_WATCH_LOOPS = offsetof(JitContext, watchLoops);
+
+// N and Z as they appear in the status register, indexed by result byte.
+struct NZTable {
+    uint8_t flags[256];
+    NZTable() {
+        for (int value = 0; value < 256; value++) {
+            flags[value] = (value == 0 ? 0x02 : 0) | (value & 0x80);
+        }
+    }
+};
+const NZTable nzTable;
+
+uint8_t jitRead(JitContext* context, uint32_t address) {
+    return context->cpu->read(address);
+}
+
+// A store that hits a write trigger leaves the block after it, as a store
+// that retires a block does.
+void jitWrite(JitContext* context, uint32_t address, uint32_t value) {
+    context->cpu->write(address, value);
+    context->invalidated |= context->cpu->isStopRequested();
+}
+
+void jitPush(JitContext* context, uint32_t value) {
+    context->cpu->pushStack(value);
+    context->invalidated |= context->cpu->isStopRequested();
+}
+
+uint8_t jitPull(JitContext* context) {
+    return context->cpu->pullStack();
+}
+
+// Whether a jump at jump back to start may close a halt or a loop
+// StopMonitor could find idle: a jump to itself, or a straight run of valid
+// instructions without stores from start to the jump. Device reads are
+// left to StopMonitor.
+bool mayCloseLoop(Bus& bus, uint16_t start, uint16_t jump) {
+    if (start == jump) {
+        return true;
+    }
+    uint32_t address = start;
+    while (true) {
+        const OpcodeInfo& info = opcodeTable[bus.readMemory(address)];
+        if (!info.valid || writesMemory(info)) {
+            return false;
+        }
+        if (address == jump) {
+            return true;
+        }
+        if (changesControlFlow(info.operation)) {
+            return false;
+        }
+        address += 1 + operandLength(info.addressingMode);
+        if (address > jump) {
+            return false;
+        }
+    }
+}
+
+// A jump just taken from jump back to start while loops are watched.
+// Returns whether native code has to leave for the run loop to see it.
+uint8_t jitLoopBack(JitContext* context, uint32_t startAndJump) {
+    uint16_t start = startAndJump & 0xFFFF;
+    uint16_t jump = startAndJump >> 16;
+    if (!mayCloseLoop(context->cpu->getBus(), start, jump)) {
+        context->skippedLoop = 1;
+        return 0;
+    }
+    context->loopJump = jump;
+    context->leftAtLoop = 1;
+    return 1;
+}
+
+// A computed jump just taken from address to the context's PC.
+void noteJump(JitContext* context, uint16_t address) {
+    if (context->watchLoops && context->PC <= address) {
+        jitLoopBack(context, context->PC | (address << 16));
+    }
+}
+
+// RTS at address: pulls the return address into the context's PC.
+void jitReturn(JitContext* context, uint32_t address) {
+    uint8_t low = context->cpu->pullStack();
+    uint8_t high = context->cpu->pullStack();
+    context->PC = ((high << 8) | low) + 1;
+    noteJump(context, address);
+}
+
+// Runs one instruction the translator does not handle natively through its
+// predecoded handler, with the CPU synchronised around it.
+void jitCallout(JitContext* context, uint32_t opcodeAndNextPC, uint32_t operand) {
+    CPU& cpu = *context->cpu;
+    cpu.setAccumulator(context->A);
+    cpu.setX(context->X);
+    cpu.setY(context->Y);
+    cpu.setStatusRegister(context->P);
+    cpu.setPC(opcodeAndNextPC & 0xFFFF);
+    cpu.setCycles(context->cycles);
+
+    predecodedHandlerTable[opcodeAndNextPC >> 16](cpu, operand);
+
+    context->cycles = cpu.getCycles();
+    context->A = cpu.getAccumulator();
+    context->X = cpu.getX();
+    context->Y = cpu.getY();
+    context->P = cpu.getStatusRegister();
+    context->PC = cpu.getPC();
+    context->invalidated |= cpu.isStopRequested();
+
+    const OpcodeInfo& info = opcodeTable[opcodeAndNextPC >> 16];
+    if (info.valid && changesControlFlow(info.operation)) {
+        noteJump(context, (opcodeAndNextPC & 0xFFFF) - 1 - operandLength(info.addressingMode));
+    }
+}
+
+// ADC (or SBC, with bit 8 of operand set) in decimal mode, through the CPU's
+// decimal tables. Native code handles the binary mode itself.
+void jitDecimal(JitContext* context, uint32_t operand) {
+    const AluTables& alu = context->cpu->getAluTables();
+    const AluResult* table = (operand & 0x100) ? alu.sbc[1] : alu.adc[1];
+    const AluResult& result = table[aluIndex(context->P & FLAG_C, context->A, operand & 0xFF)];
+    context->A = result.value;
+    context->P = (context->P & ~(FLAG_C | FLAG_Z | FLAG_V | FLAG_N)) | result.flags;
+}
+
+// Resolves a computed jump target (RTS, RTI, BRK, JMP indirect) without
+// leaving native code when a translated block already exists there, unless
+// the jump went back under watchLoops or the target is a boundary.
+const uint8_t* jitDispatch(JitContext* context) {
+    Block* block = context->cache->find(context->PC);
+    if (block && block->nativeCode && !context->leftAtLoop && !context->cache->isBoundary(context->PC)) {
+        return static_cast<const uint8_t*>(block->nativeCode);
+    }
+    return context->exitCode;
+}
+
+// Minimal x86-64 encoder covering exactly the forms the translator uses.
+// Byte registers are limited to al, cl, dl and r12b-r15b, so no encoding
+// ever needs a bare REX prefix to reach spl/bpl/sil/dil.
+class Emitter {
+public:
+    uint8_t* p;
+
+    explicit Emitter(uint8_t* at) : p(at) {}
+
+    void byte(uint8_t value) { *p++ = value; }
+    void dword(uint32_t value) { std::memcpy(p, &value, 4); p += 4; }
+    void qword(uint64_t value) { std::memcpy(p, &value, 8); p += 8; }
+
+    void rex(bool wide, uint8_t reg, uint8_t rm) {
+        uint8_t prefix = 0x40 | (wide ? 0x08 : 0) | ((reg & 8) ? 0x04 : 0) | ((rm & 8) ? 0x01 : 0);
+        if (prefix != 0x40) {
+            byte(prefix);
+        }
+    }
+    void modrm(uint8_t mod, uint8_t reg, uint8_t rm) { byte((mod << 6) | ((reg & 7) << 3) | (rm & 7)); }
+
+    // op r/m8, r8
+    void alu8(uint8_t opcode, uint8_t dst, uint8_t src) { rex(false, src, dst); byte(opcode); modrm(3, src, dst); }
+    // group-1 op r8, imm8
+    void alu8Imm(uint8_t extension, uint8_t reg, uint8_t imm) { rex(false, 0, reg); byte(0x80); modrm(3, extension, reg); byte(imm); }
+    void movImm8(uint8_t reg, uint8_t imm) { rex(false, 0, reg); byte(0xB0 | (reg & 7)); byte(imm); }
+    void movImm32(uint8_t reg, uint32_t imm) { rex(false, 0, reg); byte(0xB8 | (reg & 7)); dword(imm); }
+    void movImm64(uint8_t reg, uint64_t imm) { rex(true, 0, reg); byte(0xB8 | (reg & 7)); qword(imm); }
+    void movzx8(uint8_t dst, uint8_t src) { rex(false, dst, src); byte(0x0F); byte(0xB6); modrm(3, dst, src); }
+    void shift1(uint8_t extension, uint8_t reg) { rex(false, 0, reg); byte(0xD0); modrm(3, extension, reg); }
+    void inc8(uint8_t reg) { rex(false, 0, reg); byte(0xFE); modrm(3, 0, reg); }
+    void dec8(uint8_t reg) { rex(false, 0, reg); byte(0xFE); modrm(3, 1, reg); }
+    void setcc(uint8_t condition, uint8_t reg) { rex(false, 0, reg); byte(0x0F); byte(0x90 | condition); modrm(3, 0, reg); }
+    void test8(uint8_t reg, uint8_t imm) { rex(false, 0, reg); byte(0xF6); modrm(3, 0, reg); byte(imm); }
+    void shlImm8(uint8_t reg, uint8_t count) { rex(false, 0, reg); byte(0xC0); modrm(3, 4, reg); byte(count); }
+    void add32Imm(uint8_t reg, uint32_t imm) { rex(false, 0, reg); byte(0x81); modrm(3, 0, reg); dword(imm); }
+    void shr32Imm(uint8_t reg, uint8_t count) { rex(false, 0, reg); byte(0xC1); modrm(3, 5, reg); byte(count); }
+    void cmc() { byte(0xF5); }
+    // bt r15d, 0: copies the 6502 carry into CF
+    void carryIn() { rex(false, 0, REG_P); byte(0x0F); byte(0xBA); modrm(3, 4, REG_P); byte(0); }
+
+    void addEsi(uint32_t imm) { byte(0x81); modrm(3, 0, RSI); dword(imm); }
+    void andEsi(uint32_t imm) { byte(0x81); modrm(3, 4, RSI); dword(imm); }
+    void saveEsi() { byte(0x89); byte(0x74); byte(0x24); byte(0x00); }
+    void restoreEsi() { byte(0x8B); byte(0x74); byte(0x24); byte(0x00); }
+
+    // mov r8, [rbx + disp8] / mov [rbx + disp8], r8
+    void loadContext(uint8_t reg, uint8_t disp) { rex(false, reg, RBX); byte(0x8A); modrm(1, reg, RBX); byte(disp); }
+    void storeContext(uint8_t disp, uint8_t reg) { rex(false, reg, RBX); byte(0x88); modrm(1, reg, RBX); byte(disp); }
+    void storeContextPC() { byte(0x66); byte(0x89); modrm(1, RAX, RBX); byte(CTX_PC); }
+    void loadContextPC() { byte(0x0F); byte(0xB7); modrm(1, RAX, RBX); byte(CTX_PC); }
+    // cmp dword [reg], 0
+    void cmpDwordZero(uint8_t reg) { rex(false, 0, reg); byte(0x83); modrm(0, 7, reg); byte(0); }
+    void cmpInvalidated() { byte(0x80); modrm(1, 7, RBX); byte(CTX_INVALIDATED); byte(0); }
+    void cmpWatchLoops() { byte(0x80); modrm(1, 7, RBX); byte(CTX_WATCH_LOOPS); byte(0); }
+    void cmpRemaining(uint8_t count) { rex(true, 0, RBX); byte(0x83); modrm(1, 7, RBX); byte(CTX_REMAINING); byte(count); }
+    void subRemaining(uint8_t count) { rex(true, 0, RBX); byte(0x83); modrm(1, 5, RBX); byte(CTX_REMAINING); byte(count); }
+    void addRemaining(uint8_t count) { rex(true, 0, RBX); byte(0x83); modrm(1, 0, RBX); byte(CTX_REMAINING); byte(count); }
+    void addCycles(uint32_t count) { rex(true, 0, RBX); byte(0x81); modrm(1, 0, RBX); byte(CTX_CYCLES); dword(count); }
+    void subCycles(uint32_t count) { rex(true, 0, RBX); byte(0x81); modrm(1, 5, RBX); byte(CTX_CYCLES); dword(count); }
+    // add [rbx + cycles], reg64
+    void addCyclesFrom(uint8_t reg) { rex(true, reg, RBX); byte(0x01); modrm(1, reg, RBX); byte(CTX_CYCLES); }
+
+    // or r15b, [rbp + index]: merges N and Z for the byte in the index register
+    void orNZ(uint8_t index) { rex(false, REG_P, 0); byte(0x0A); modrm(1, REG_P, 4); byte(((index & 7) << 3) | RBP); byte(0); }
+
+    void call(const void* target) {
+        movImm64(RAX, reinterpret_cast<uint64_t>(target));
+        byte(0xFF);
+        modrm(3, 2, RAX);
+    }
+
+    void jmp(const uint8_t* target) { byte(0xE9); rel32(target); }
+    uint8_t* jccForward(uint8_t condition) { byte(0x0F); byte(0x80 | condition); dword(0); return p; }
+    uint8_t* jmpForward() { byte(0xE9); dword(0); return p; }
+    void rel32(const uint8_t* target) { dword(static_cast<uint32_t>(target - (p + 4))); }
+
+    static void bind(uint8_t* afterJump, const uint8_t* target) {
+        uint32_t offset = static_cast<uint32_t>(target - afterJump);
+        std::memcpy(afterJump - 4, &offset, 4);
+    }
+};
+
+// Writes "jmp target" over the first five bytes of a chain slot.
+void patchJump(uint8_t* slot, const uint8_t* target) {
+    Emitter emitter(slot);
+    emitter.jmp(target);
+}
+
+bool translatesNatively(const OpcodeInfo& info) {
+    if (!info.valid) {
+        return false;
+    }
+    switch (info.addressingMode) {
+        case AddressingModeType::Indirect:
+        case AddressingModeType::IndexedIndirectX:
+        case AddressingModeType::IndirectIndexedY:
+            return false;
+        default:
+            break;
+    }
+    switch (info.operation) {
+        case OperationType::RTI: case OperationType::BRK:
+        case OperationType::TXS: case OperationType::TSX:
+            return false;
+        default:
+            return true;
+    }
+}
+
+uint8_t branchMask(OperationType operation) {
+    switch (operation) {
+        case OperationType::BCC: case OperationType::BCS: return 0x01;
+        case OperationType::BEQ: case OperationType::BNE: return 0x02;
+        case OperationType::BVC: case OperationType::BVS: return 0x40;
+        default: return 0x80;
+    }
+}
+
+bool branchOnSet(OperationType operation) {
+    return operation == OperationType::BCS || operation == OperationType::BEQ ||
+           operation == OperationType::BVS || operation == OperationType::BMI;
+}
+
+// Emits the translation of one block. Kept separate from Jit so the
+// per-instruction helpers can share the emitter and block bookkeeping.
+class Translator {
+public:
+    Emitter e;
+    const uint8_t* exitCode;
+    uint8_t blockSize;
+    std::vector<std::pair<uint8_t*, uint16_t>> slots;
+    // Base cycles of the block from each instruction to its end. The block
+    // charges all of them on entry and hands back the rest on an early exit.
+    std::vector<uint32_t> tailCycles;
+    bool flagsDead;
+
+    Translator(uint8_t* at, const uint8_t* exit, const Block* block)
+        : e(at), exitCode(exit), blockSize(block->instructions.size()), tailCycles(blockSize + 1, 0), flagsDead(false) {
+        for (int i = blockSize - 1; i >= 0; i--) {
+            tailCycles[i] = tailCycles[i + 1] + cycleTable[block->instructions[i].opcode];
+        }
+    }
+
+    void setNZ(uint8_t reg) {
+        if (flagsDead) {
+            return;
+        }
+        e.alu8Imm(ALU_AND, REG_P, 0x7D);
+        e.movzx8(RAX, reg);
+        e.orNZ(RAX);
+    }
+
+    // Calls helper(context, esi, edx).
+    void callContext(const void* helper) {
+        e.byte(0x48); e.byte(0x89); e.modrm(3, RBX, RDI);  // mov rdi, rbx
+        e.call(helper);
+    }
+
+    void read() { callContext(reinterpret_cast<const void*>(&jitRead)); }
+    void write() { callContext(reinterpret_cast<const void*>(&jitWrite)); }
+
+    void push(uint8_t reg, uint8_t unexecuted, uint16_t nextPC) {
+        e.movzx8(RSI, reg);
+        callContext(reinterpret_cast<const void*>(&jitPush));
+        exitIfInvalidated(unexecuted, nextPC);
+    }
+
+    // Continues at the PC stored in the context: straight into its native
+    // block when one exists, otherwise through the exit stub.
+    void dispatchComputed() {
+        callContext(reinterpret_cast<const void*>(&jitDispatch));
+        e.byte(0x48); e.byte(0x89); e.modrm(3, RAX, RCX);  // mov rcx, rax
+        e.loadContextPC();
+        e.byte(0xFF); e.modrm(3, 4, RCX);                  // jmp rcx
+    }
+
+    void spill() {
+        e.storeContext(CTX_A, REG_A);
+        e.storeContext(CTX_X, REG_X);
+        e.storeContext(CTX_Y, REG_Y);
+        e.storeContext(CTX_P, REG_P);
+    }
+
+    void reload() {
+        e.loadContext(REG_A, CTX_A);
+        e.loadContext(REG_X, CTX_X);
+        e.loadContext(REG_Y, CTX_Y);
+        e.loadContext(REG_P, CTX_P);
+    }
+
+    // Leaves the block with PC = nextPC if the last store retired any block,
+    // handing the unexecuted instructions back to the budget.
+    void exitIfInvalidated(uint8_t unexecuted, uint16_t nextPC) {
+        e.cmpInvalidated();
+        uint8_t* skip = e.jccForward(CC_ZERO);
+        if (unexecuted) {
+            e.addRemaining(unexecuted);
+            e.subCycles(tailCycles[blockSize - unexecuted]);
+        }
+        e.movImm32(RAX, nextPC);
+        e.jmp(exitCode);
+        Emitter::bind(skip, e.p);
+    }
+
+    // mov eax, pc; jmp exit -- later patched into a direct jump once a
+    // translated block exists at pc.
+    void chainSlot(uint16_t pc) {
+        slots.push_back(std::make_pair(e.p, pc));
+        e.movImm32(RAX, pc);
+        e.jmp(exitCode);
+    }
+
+    // chainSlot() for the instruction at jump going on to pc, leaving
+    // first if that goes back while loops are watched and jitLoopBack()
+    // finds it may close one. That is decided on every pass, since the
+    // loop can start in code outside this block.
+    void chainFrom(uint16_t jump, uint16_t pc) {
+        if (pc <= jump) {
+            e.cmpWatchLoops();
+            uint8_t* unwatched = e.jccForward(CC_ZERO);
+            e.movImm32(RSI, pc | (jump << 16));
+            callContext(reinterpret_cast<const void*>(&jitLoopBack));
+            e.alu8(OP_TEST, RAX, RAX);
+            uint8_t* stay = e.jccForward(CC_ZERO);
+            e.movImm32(RAX, pc);
+            e.jmp(exitCode);
+            Emitter::bind(unwatched, e.p);
+            Emitter::bind(stay, e.p);
+        }
+        chainSlot(pc);
+    }
+
+    void address(AddressingModeType mode, uint16_t operand) {
+        switch (mode) {
+            case AddressingModeType::ZeroPage:
+                e.movImm32(RSI, operand & 0xFF);
+                break;
+            case AddressingModeType::Absolute:
+                e.movImm32(RSI, operand);
+                break;
+            case AddressingModeType::ZeroPageX:
+            case AddressingModeType::ZeroPageY:
+                e.movzx8(RSI, mode == AddressingModeType::ZeroPageX ? REG_X : REG_Y);
+                e.addEsi(operand & 0xFF);
+                e.andEsi(0xFF);
+                break;
+            case AddressingModeType::AbsoluteX:
+            case AddressingModeType::AbsoluteY:
+                e.movzx8(RSI, mode == AddressingModeType::AbsoluteX ? REG_X : REG_Y);
+                e.addEsi(operand);
+                e.andEsi(0xFFFF);
+                break;
+            default:
+                break;
+        }
+    }
+
+    // Leaves the operand value in al.
+    void load(AddressingModeType mode, uint16_t operand) {
+        if (mode == AddressingModeType::Immediate) {
+            e.movImm8(RAX, operand & 0xFF);
+            return;
+        }
+        address(mode, operand);
+        if (mode == AddressingModeType::AbsoluteX || mode == AddressingModeType::AbsoluteY) {
+            // One more cycle when indexing carries into the high byte.
+            e.movzx8(RCX, mode == AddressingModeType::AbsoluteX ? REG_X : REG_Y);
+            e.add32Imm(RCX, operand & 0xFF);
+            e.shr32Imm(RCX, 8);
+            e.addCyclesFrom(RCX);
+        }
+        read();
+    }
+
+    void compare(uint8_t reg) {
+        if (flagsDead) {
+            return;
+        }
+        e.alu8(OP_MOV, RDX, reg);
+        e.alu8(OP_SUB, RDX, RAX);
+        e.setcc(CC_NOT_CARRY, RCX);
+        e.alu8Imm(ALU_AND, REG_P, 0x7C);
+        e.alu8(OP_OR, REG_P, RCX);
+        e.movzx8(RAX, RDX);
+        e.orNZ(RAX);
+    }
+
+    // Shared tail of ADC and SBC: cl holds the 6502 carry, dl the overflow.
+    void arithmeticFlags() {
+        e.setcc(CC_OVERFLOW, RDX);
+        e.alu8Imm(ALU_AND, REG_P, 0x3C);
+        e.alu8(OP_OR, REG_P, RCX);
+        e.shlImm8(RDX, 6);
+        e.alu8(OP_OR, REG_P, RDX);
+        e.movzx8(RAX, REG_A);
+        e.orNZ(RAX);
+    }
+
+    // ADC or SBC of al: native for binary mode, through jitDecimal with D set.
+    void arithmetic(bool subtract) {
+        e.test8(REG_P, FLAG_D);
+        uint8_t* decimal = e.jccForward(CC_NOT_ZERO);
+        e.carryIn();
+        if (subtract) {
+            e.cmc();
+            e.alu8(OP_SBB, REG_A, RAX);
+            e.setcc(CC_NOT_CARRY, RCX);
+        } else {
+            e.alu8(OP_ADC, REG_A, RAX);
+            e.setcc(CC_CARRY, RCX);
+        }
+        arithmeticFlags();
+        uint8_t* done = e.jmpForward();
+
+        Emitter::bind(decimal, e.p);
+        e.movzx8(RSI, RAX);
+        if (subtract) {
+            e.addEsi(0x100);
+        }
+        e.storeContext(CTX_A, REG_A);
+        e.storeContext(CTX_P, REG_P);
+        callContext(reinterpret_cast<const void*>(&jitDecimal));
+        e.loadContext(REG_A, CTX_A);
+        e.loadContext(REG_P, CTX_P);
+        Emitter::bind(done, e.p);
+    }
+
+    uint8_t shiftExtension(OperationType operation) {
+        switch (operation) {
+            case OperationType::ASL: return SHIFT_SHL;
+            case OperationType::LSR: return SHIFT_SHR;
+            case OperationType::ROL: return SHIFT_RCL;
+            default: return SHIFT_RCR;
+        }
+    }
+
+    void shift(OperationType operation, uint8_t reg) {
+        if (operation == OperationType::ROL || operation == OperationType::ROR) {
+            e.carryIn();
+        }
+        e.shift1(shiftExtension(operation), reg);
+        e.setcc(CC_CARRY, RCX);
+    }
+
+    void readModifyWrite(const OpcodeInfo& info, uint16_t operand, uint8_t unexecuted, uint16_t nextPC) {
+        address(info.addressingMode, operand);
+        e.saveEsi();
+        read();
+        if (info.operation == OperationType::INC || info.operation == OperationType::DEC) {
+            if (info.operation == OperationType::INC) {
+                e.inc8(RAX);
+            } else {
+                e.dec8(RAX);
+            }
+            if (!flagsDead) {
+                e.movzx8(RDX, RAX);
+                e.alu8Imm(ALU_AND, REG_P, 0x7D);
+                e.orNZ(RDX);
+            }
+        } else {
+            shift(info.operation, RAX);
+            e.movzx8(RDX, RAX);
+            e.alu8Imm(ALU_AND, REG_P, 0x7C);
+            e.alu8(OP_OR, REG_P, RCX);
+            e.orNZ(RDX);
+        }
+        e.restoreEsi();
+        write();
+        exitIfInvalidated(unexecuted, nextPC);
+    }
+
+    void store(uint8_t reg, const OpcodeInfo& info, uint16_t operand, uint8_t unexecuted, uint16_t nextPC) {
+        address(info.addressingMode, operand);
+        e.movzx8(RDX, reg);
+        write();
+        exitIfInvalidated(unexecuted, nextPC);
+    }
+
+    void transfer(uint8_t dst, uint8_t src) {
+        e.alu8(OP_MOV, dst, src);
+        setNZ(dst);
+    }
+
+    void callout(const DecodedInstruction& instruction, const OpcodeInfo& info, uint8_t unexecuted) {
+        spill();
+        e.movImm32(RSI, instruction.nextPC | (instruction.opcode << 16));
+        e.movImm32(RDX, instruction.operand);
+        callContext(reinterpret_cast<const void*>(&jitCallout));
+        reload();
+        if (info.valid && changesControlFlow(info.operation)) {
+            e.cmpInvalidated();
+            uint8_t* invalidated = e.jccForward(CC_NOT_ZERO);
+            dispatchComputed();
+            Emitter::bind(invalidated, e.p);
+            e.loadContextPC();
+            e.jmp(exitCode);
+        } else {
+            exitIfInvalidated(unexecuted, instruction.nextPC);
+        }
+    }
+
+    void branch(const DecodedInstruction& instruction, OperationType operation) {
+        uint16_t target = instruction.nextPC + static_cast<int8_t>(instruction.operand);
+        e.test8(REG_P, branchMask(operation));
+        uint8_t* taken = e.jccForward(branchOnSet(operation) ? CC_NOT_ZERO : CC_ZERO);
+        chainFrom(instruction.nextPC - 2, instruction.nextPC);
+        Emitter::bind(taken, e.p);
+        e.addCycles(1 + (((instruction.nextPC ^ target) >> 8) != 0));
+        chainFrom(instruction.nextPC - 2, target);
+    }
+
+    void instruction(const DecodedInstruction& instruction, uint8_t index) {
+        const OpcodeInfo& info = opcodeTable[instruction.opcode];
+        uint8_t unexecuted = blockSize - index - 1;
+        uint16_t operand = instruction.operand;
+        AddressingModeType mode = info.addressingMode;
+        // The block cache's liveness pass left a flag-free handler here.
+        flagsDead = instruction.handler != predecodedHandlerTable[instruction.opcode];
+
+        if (!translatesNatively(info)) {
+            callout(instruction, info, unexecuted);
+            return;
+        }
+
+        switch (info.operation) {
+            case OperationType::LDA: load(mode, operand); transfer(REG_A, RAX); break;
+            case OperationType::LDX: load(mode, operand); transfer(REG_X, RAX); break;
+            case OperationType::LDY: load(mode, operand); transfer(REG_Y, RAX); break;
+            case OperationType::STA: store(REG_A, info, operand, unexecuted, instruction.nextPC); break;
+            case OperationType::STX: store(REG_X, info, operand, unexecuted, instruction.nextPC); break;
+            case OperationType::STY: store(REG_Y, info, operand, unexecuted, instruction.nextPC); break;
+            case OperationType::AND: load(mode, operand); e.alu8(OP_AND, REG_A, RAX); setNZ(REG_A); break;
+            case OperationType::ORA: load(mode, operand); e.alu8(OP_OR, REG_A, RAX); setNZ(REG_A); break;
+            case OperationType::EOR: load(mode, operand); e.alu8(OP_XOR, REG_A, RAX); setNZ(REG_A); break;
+            case OperationType::ADC:
+            case OperationType::SBC:
+                load(mode, operand);
+                arithmetic(info.operation == OperationType::SBC);
+                break;
+            case OperationType::CMP: load(mode, operand); compare(REG_A); break;
+            case OperationType::CPX: load(mode, operand); compare(REG_X); break;
+            case OperationType::CPY: load(mode, operand); compare(REG_Y); break;
+            case OperationType::BIT:
+                load(mode, operand);
+                if (flagsDead) {
+                    break;
+                }
+                e.alu8Imm(ALU_AND, REG_P, 0x3D);
+                e.alu8(OP_MOV, RCX, RAX);
+                e.alu8Imm(ALU_AND, RCX, 0xC0);
+                e.alu8(OP_OR, REG_P, RCX);
+                e.alu8(OP_TEST, REG_A, RAX);
+                e.setcc(CC_ZERO, RCX);
+                e.shift1(SHIFT_SHL, RCX);
+                e.alu8(OP_OR, REG_P, RCX);
+                break;
+            case OperationType::INC:
+            case OperationType::DEC:
+                readModifyWrite(info, operand, unexecuted, instruction.nextPC);
+                break;
+            case OperationType::ASL:
+            case OperationType::LSR:
+            case OperationType::ROL:
+            case OperationType::ROR:
+                if (mode == AddressingModeType::Accumulator) {
+                    shift(info.operation, REG_A);
+                    e.alu8Imm(ALU_AND, REG_P, 0x7C);
+                    e.alu8(OP_OR, REG_P, RCX);
+                    e.movzx8(RAX, REG_A);
+                    e.orNZ(RAX);
+                } else {
+                    readModifyWrite(info, operand, unexecuted, instruction.nextPC);
+                }
+                break;
+            case OperationType::INX: e.inc8(REG_X); setNZ(REG_X); break;
+            case OperationType::INY: e.inc8(REG_Y); setNZ(REG_Y); break;
+            case OperationType::DEX: e.dec8(REG_X); setNZ(REG_X); break;
+            case OperationType::DEY: e.dec8(REG_Y); setNZ(REG_Y); break;
+            case OperationType::TAX: transfer(REG_X, REG_A); break;
+            case OperationType::TAY: transfer(REG_Y, REG_A); break;
+            case OperationType::TXA: transfer(REG_A, REG_X); break;
+            case OperationType::TYA: transfer(REG_A, REG_Y); break;
+            case OperationType::CLC: e.alu8Imm(ALU_AND, REG_P, 0xFE); break;
+            case OperationType::SEC: e.alu8Imm(ALU_OR, REG_P, 0x01); break;
+            case OperationType::CLI: e.alu8Imm(ALU_AND, REG_P, 0xFB); break;
+            case OperationType::SEI: e.alu8Imm(ALU_OR, REG_P, 0x04); break;
+            case OperationType::CLD: e.alu8Imm(ALU_AND, REG_P, 0xF7); break;
+            case OperationType::SED: e.alu8Imm(ALU_OR, REG_P, 0x08); break;
+            case OperationType::CLV: e.alu8Imm(ALU_AND, REG_P, 0xBF); break;
+            case OperationType::NOP: break;
+            case OperationType::JMP: chainFrom(instruction.nextPC - 3, operand); break;
+            case OperationType::JSR:
+                e.movImm32(RSI, ((instruction.nextPC - 1) >> 8) & 0xFF);
+                callContext(reinterpret_cast<const void*>(&jitPush));
+                e.movImm32(RSI, (instruction.nextPC - 1) & 0xFF);
+                callContext(reinterpret_cast<const void*>(&jitPush));
+                exitIfInvalidated(0, operand);
+                chainFrom(instruction.nextPC - 3, operand);
+                break;
+            case OperationType::RTS:
+                e.movImm32(RSI, static_cast<uint16_t>(instruction.nextPC - 1));
+                callContext(reinterpret_cast<const void*>(&jitReturn));
+                dispatchComputed();
+                break;
+            case OperationType::PHA: push(REG_A, unexecuted, instruction.nextPC); break;
+            case OperationType::PHP:
+                e.alu8Imm(ALU_OR, REG_P, 0x30);
+                push(REG_P, unexecuted, instruction.nextPC);
+                break;
+            case OperationType::PLA:
+                callContext(reinterpret_cast<const void*>(&jitPull));
+                transfer(REG_A, RAX);
+                break;
+            case OperationType::PLP:
+                callContext(reinterpret_cast<const void*>(&jitPull));
+                e.alu8(OP_MOV, REG_P, RAX);
+                e.alu8Imm(ALU_AND, REG_P, 0xCF);
+                break;
+            case OperationType::BCC: case OperationType::BCS:
+            case OperationType::BEQ: case OperationType::BNE:
+            case OperationType::BMI: case OperationType::BPL:
+            case OperationType::BVC: case OperationType::BVS:
+                branch(instruction, info.operation);
+                break;
+            default:
+                break;
+        }
+    }
+};
+
+}
+
+bool Jit::isSupported() {
+    return true;
+}
+
+Jit::Jit(CPU& cpu, BlockCache& cache)
+    : cpu(cpu), cache(cache), context{}, stats{}, hotThreshold(32), code(nullptr), codeCursor(nullptr),
+      enterCode(nullptr), exitCode(nullptr), codeWritable(true), inNativeCode(false) {
+    void* memory = mmap(nullptr, CODE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory != MAP_FAILED) {
+        code = static_cast<uint8_t*>(memory);
+        emitTrampolines();
+        protectCode();
+    }
+    context.cpu = &cpu;
+    context.cache = &cache;
+    cache.setRetireListener(this);
+}
+
+Jit::~Jit() {
+    cache.setRetireListener(nullptr);
+    if (code) {
+        munmap(code, CODE_SIZE);
+    }
+}
+
+// Translation and patching make the buffer writable and leave it so, and
+// enter() makes it executable again, so a burst of retired blocks or a
+// flush costs two mprotect() calls rather than two per block. Only a block
+// retired from inside native code, by a store to a page it was translated
+// from, has to put it back straight away. mprotect() only fails here when
+// the kernel cannot split the mapping, and neither state can be left
+// safely then.
+void Jit::unprotectCode() {
+    if (!codeWritable) {
+        if (mprotect(code, CODE_SIZE, PROT_READ | PROT_WRITE) != 0) {
+            std::cerr << "JIT: cannot make the code buffer writable" << std::endl;
+            std::abort();
+        }
+        codeWritable = true;
+    }
+}
+
+void Jit::protectCode() {
+    if (codeWritable) {
+        if (mprotect(code, CODE_SIZE, PROT_READ | PROT_EXEC) != 0) {
+            std::cerr << "JIT: cannot make the code buffer executable" << std::endl;
+            std::abort();
+        }
+        codeWritable = false;
+    }
+}
+
+void Jit::emitTrampolines() {
+    Emitter e(code);
+
+    // exit: eax holds the 6502 PC to resume at.
+    exitCode = e.p;
+    context.exitCode = exitCode;
+    e.storeContext(CTX_A, REG_A);
+    e.storeContext(CTX_X, REG_X);
+    e.storeContext(CTX_Y, REG_Y);
+    e.storeContext(CTX_P, REG_P);
+    e.storeContextPC();
+    e.byte(0x48); e.byte(0x83); e.byte(0xC4); e.byte(0x18);  // add rsp, 24
+    e.byte(0x41); e.byte(0x5F);                               // pop r15
+    e.byte(0x41); e.byte(0x5E);                               // pop r14
+    e.byte(0x41); e.byte(0x5D);                               // pop r13
+    e.byte(0x41); e.byte(0x5C);                               // pop r12
+    e.byte(0x5D);                                             // pop rbp
+    e.byte(0x5B);                                             // pop rbx
+    e.byte(0xC3);                                             // ret
+
+    // enter(JitContext* context, void* block)
+    enterCode = e.p;
+    e.byte(0x53);                                             // push rbx
+    e.byte(0x55);                                             // push rbp
+    e.byte(0x41); e.byte(0x54);                               // push r12
+    e.byte(0x41); e.byte(0x55);                               // push r13
+    e.byte(0x41); e.byte(0x56);                               // push r14
+    e.byte(0x41); e.byte(0x57);                               // push r15
+    e.byte(0x48); e.byte(0x83); e.byte(0xEC); e.byte(0x18);  // sub rsp, 24 (keeps calls 16-byte aligned)
+    e.byte(0x48); e.byte(0x89); e.modrm(3, RDI, RBX);         // mov rbx, rdi
+    e.movImm64(RBP, reinterpret_cast<uint64_t>(nzTable.flags));
+    e.loadContext(REG_A, CTX_A);
+    e.loadContext(REG_X, CTX_X);
+    e.loadContext(REG_Y, CTX_Y);
+    e.loadContext(REG_P, CTX_P);
+    e.byte(0xFF); e.modrm(3, 4, RSI);                         // jmp rsi
+
+    codeCursor = e.p;
+}
+
+void Jit::translate(Block* block) {
+    unprotectCode();
+    uint8_t size = block->instructions.size();
+    Translator translator(codeCursor, exitCode, block);
+    Emitter& e = translator.e;
+
+    // The budget check doubles as the patch area used to unlink the block
+    // when it is retired, so it must stay at least ten bytes long.
+    uint8_t* entry = e.p;
+    e.cmpRemaining(size);
+    uint8_t* overBudget = e.jccForward(CC_CARRY);
+    // A pending interrupt also leaves through the dispatcher, which takes it.
+    e.movImm64(RAX, reinterpret_cast<uint64_t>(&cpu.getPendingInterrupts()));
+    e.cmpDwordZero(RAX);
+    uint8_t* interrupted = e.jccForward(CC_NOT_ZERO);
+    e.subRemaining(size);
+    e.addCycles(block->cycles);
+
+    for (uint8_t i = 0; i < size; i++) {
+        translator.instruction(block->instructions[i], i);
+        stats.instructionsTranslated++;
+        if (!translatesNatively(opcodeTable[block->instructions[i].opcode])) {
+            stats.interpreterCallouts++;
+        }
+    }
+
+    // Blocks that end on the instruction limit rather than a jump fall through.
+    const DecodedInstruction& last = block->instructions.back();
+    const OpcodeInfo& lastInfo = opcodeTable[last.opcode];
+    if (!lastInfo.valid || !changesControlFlow(lastInfo.operation)) {
+        translator.chainFrom(last.nextPC - 1 - operandLength(lastInfo.addressingMode), last.nextPC);
+    }
+
+    Emitter::bind(overBudget, e.p);
+    Emitter::bind(interrupted, e.p);
+    e.movImm32(RAX, block->startPC);
+    e.jmp(exitCode);
+
+    codeCursor = e.p;
+    block->nativeCode = entry;
+    stats.blocksTranslated++;
+
+    // Blocks at boundaries (breakpoints) are only entered from the run
+    // loop, which checks for them.
+    for (const auto& slot : translator.slots) {
+        chainSlots[slot.second].push_back(slot.first);
+        Block* target = cache.find(slot.second);
+        if (target && target->nativeCode && !cache.isBoundary(slot.second)) {
+            patchJump(slot.first, static_cast<uint8_t*>(target->nativeCode));
+        }
+    }
+    if (!cache.isBoundary(block->startPC)) {
+        for (uint8_t* slot : chainSlots[block->startPC]) {
+            patchJump(slot, entry);
+        }
+    }
+}
+
+void Jit::onBlockRetired(Block* block) {
+    context.invalidated = 1;
+    if (!block->nativeCode) {
+        return;
+    }
+
+    // Anything still chained to this block now falls out to the dispatcher.
+    unprotectCode();
+    Emitter e(static_cast<uint8_t*>(block->nativeCode));
+    e.movImm32(RAX, block->startPC);
+    e.jmp(exitCode);
+    block->nativeCode = nullptr;
+    if (inNativeCode) {
+        protectCode();
+    }
+}
+
+void Jit::flushCode() {
+    unprotectCode();
+    cache.flush();
+    chainSlots.clear();
+    codeCursor = code;
+    emitTrampolines();
+    stats.codeFlushes++;
+}
+
+uint64_t Jit::enter(Block* block, uint64_t count, bool watchLoops) {
+    context.remaining = count;
+    context.watchLoops = watchLoops;
+    context.leftAtLoop = 0;
+    context.skippedLoop = 0;
+    context.cycles = cpu.getCycles();
+    context.A = cpu.getAccumulator();
+    context.X = cpu.getX();
+    context.Y = cpu.getY();
+    context.P = cpu.getStatusRegister();
+    context.invalidated = 0;
+
+    typedef void (*EnterFunction)(JitContext* context, void* block);
+    protectCode();
+    inNativeCode = true;
+    reinterpret_cast<EnterFunction>(enterCode)(&context, block->nativeCode);
+    inNativeCode = false;
+    stats.nativeEntries++;
+
+    cpu.setAccumulator(context.A);
+    cpu.setX(context.X);
+    cpu.setY(context.Y);
+    cpu.setStatusRegister(context.P);
+    cpu.setPC(context.PC);
+    cpu.setCycles(context.cycles);
+    return context.remaining;
+}
+
+Block* Jit::lookup(uint16_t pc) {
+    if (code && static_cast<size_t>(code + CODE_SIZE - codeCursor) < MAX_BLOCK_CODE) {
+        flushCode();
+    }
+    Block* block = cache.lookup(pc);
+    if (code && !block->nativeCode && ++block->entryCount >= hotThreshold) {
+        translate(block);
+    }
+    return block;
+}
+
+void Jit::run(uint64_t count) {
+    while (count > 0) {
+        if (cpu.hasPendingInterrupts()) {
+            cpu.serviceInterrupts();
+        }
+        Block* block = lookup(cpu.getPC());
+
+        // Native code would exit straight away while an interrupt is pending,
+        // masked IRQ included, so such blocks run interpreted.
+        if (block->nativeCode && count >= block->instructions.size() && !cpu.hasPendingInterrupts()) {
+            count = enter(block, count, false);
+        } else {
+            stats.interpretedBlocks++;
+            count = cpu.executeBlock(block, count);
+        }
+    }
+}
+
+bool Jit::canRunNative(const Block* block, uint64_t count) const {
+    return block->nativeCode && count >= block->instructions.size() && !cpu.hasPendingInterrupts();
+}
+
+uint64_t Jit::runNative(Block* block, uint64_t count, bool watchLoops) {
+    return enter(block, count, watchLoops);
+}
+
+int32_t Jit::getLoopJump() const {
+    return context.leftAtLoop ? context.loopJump : -1;
+}
+
+bool Jit::skippedLoops() const {
+    return context.skippedLoop;
+}
+
+#else
+
+// Without an x86-64 host the JIT is never instantiated: CPU falls back to
+// the block cache engine.
+bool Jit::isSupported() {
+    return false;
+}
+
+Jit::Jit(CPU& cpu, BlockCache& cache)
+    : cpu(cpu), cache(cache), context{}, stats{}, hotThreshold(32), code(nullptr), codeCursor(nullptr),
+      enterCode(nullptr), exitCode(nullptr), codeWritable(false), inNativeCode(false) {}
+
+Jit::~Jit() {}
+
+Block* Jit::lookup(uint16_t pc) {
+    return cache.lookup(pc);
+}
+
+void Jit::run(uint64_t count) {
+    while (count > 0) {
+        if (cpu.hasPendingInterrupts()) {
+            cpu.serviceInterrupts();
+        }
+        count = cpu.executeBlock(lookup(cpu.getPC()), count);
+    }
+}
+
+bool Jit::canRunNative(const Block* block, uint64_t count) const {
+    return false;
+}
+
+uint64_t Jit::runNative(Block* block, uint64_t count, bool watchLoops) {
+    return cpu.executeBlock(block, count);
+}
+
+int32_t Jit::getLoopJump() const {
+    return -1;
+}
+
+bool Jit::skippedLoops() const {
+    return false;
+}
+
+void Jit::onBlockRetired(Block* block) {}
+
+#endif
+
+void Jit::setHotThreshold(uint32_t threshold) {
+    hotThreshold = threshold ? threshold : 1;
+}
+
+const JitStats& Jit::getStats() const {
+    return stats;
+}
+
+void Jit::printStats() const {
+    std::cout << std::dec;
+    std::cout << "Blocks translated: " << stats.blocksTranslated << " (" << stats.instructionsTranslated
+              << " instructions, " << stats.interpreterCallouts << " via interpreter)" << std::endl;
+    std::cout << "Native entries: " << stats.nativeEntries << ", interpreted blocks: " << stats.interpretedBlocks << std::endl;
+    std::cout << "Code cache flushes: " << stats.codeFlushes << std::endl;
+}
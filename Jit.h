@@ -0,0 +1,111 @@
+#ifndef JIT_H
+#define JIT_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "BlockCache.h"
+
+class CPU;
+
+// State shared with translated code. Native blocks keep A, X, Y and the status
+// byte in host registers and only spill them here at exits and around calls
+// back into the interpreter. SP is left in the CPU, since every instruction
+// that touches the stack runs through the interpreter. With watchLoops set,
+// a taken jump to or behind its own address that may close a halt or idle
+// loop leaves native code, setting leftAtLoop and loopJump to the jump's
+// address; any other sets skippedLoop.
+struct JitContext {
+    uint64_t remaining;
+    uint64_t cycles;
+    CPU* cpu;
+    BlockCache* cache;
+    const uint8_t* exitCode;
+    uint8_t A;
+    uint8_t X;
+    uint8_t Y;
+    uint8_t P;
+    uint16_t PC;
+    uint8_t invalidated;
+    uint16_t loopJump;
+    uint8_t watchLoops;
+    uint8_t leftAtLoop;
+    uint8_t skippedLoop;
+};
+
+struct JitStats {
+    uint64_t blocksTranslated;
+    uint64_t instructionsTranslated;
+    uint64_t interpreterCallouts;
+    uint64_t nativeEntries;
+    uint64_t interpretedBlocks;
+    uint64_t codeFlushes;
+};
+
+// x86-64 translator for hot blocks of the block cache. Blocks are profiled by
+// entry count and translated once they reach the hot threshold. Translated
+// blocks jump straight into each other once the successor exists. Every
+// memory access still goes through the CPU, so bus watches (and with them
+// self-modifying code detection) behave exactly as in the interpreter.
+class Jit : public BlockRetireListener {
+private:
+    static const size_t CODE_SIZE = 16 * 1024 * 1024;
+    static const size_t MAX_BLOCK_CODE = 64 * 1024;
+
+    CPU& cpu;
+    BlockCache& cache;
+    JitContext context;
+    JitStats stats;
+    uint32_t hotThreshold;
+
+    // The code buffer is never writable and executable at once. Writers
+    // make it writable, and it goes back to executable before native code
+    // runs again; see unprotectCode().
+    uint8_t* code;
+    uint8_t* codeCursor;
+    uint8_t* enterCode;
+    uint8_t* exitCode;
+    bool codeWritable;
+    bool inNativeCode;
+
+    // Chain slots waiting for (or already patched to) a block at each PC.
+    std::unordered_map<uint16_t, std::vector<uint8_t*>> chainSlots;
+
+    void unprotectCode();
+    void protectCode();
+    void emitTrampolines();
+    void translate(Block* block);
+    void flushCode();
+    uint64_t enter(Block* block, uint64_t count, bool watchLoops);
+
+public:
+    static bool isSupported();
+
+    Jit(CPU& cpu, BlockCache& cache);
+    ~Jit() override;
+
+    void run(uint64_t count);
+    // The block at pc, translated once it is hot. Flushes the code buffer
+    // first when it is nearly full, which drops every block in the cache.
+    Block* lookup(uint16_t pc);
+    // For runs that check stop conditions between blocks: whether block can
+    // be entered natively with count instructions left, and running it and
+    // the blocks chained to it. Native code never enters a block at a
+    // block cache boundary, and with watchLoops set it leaves after a jump
+    // to or behind itself that may close a halt or idle loop, which
+    // getLoopJump() then returns. Returns what is left of count.
+    bool canRunNative(const Block* block, uint64_t count) const;
+    uint64_t runNative(Block* block, uint64_t count, bool watchLoops);
+    // The jump the last runNative() left at, or -1 if it left anywhere else.
+    int32_t getLoopJump() const;
+    // Whether the last runNative() took any other jump back, which the
+    // run loop never saw.
+    bool skippedLoops() const;
+    void setHotThreshold(uint32_t threshold);
+    void onBlockRetired(Block* block) override;
+
+    const JitStats& getStats() const;
+    void printStats() const;
+};
+
+#endif
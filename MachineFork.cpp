@@ -0,0 +1,147 @@
+#include "MachineFork.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// Plain RAM, which forks copy on write; the rest is read-only memory.
+bool isPrivateRam(const Page& page) {
+    return !(page.flags & PAGE_READ_ONLY);
+}
+
+}
+
+MachineSnapshot::MachineSnapshot() : ownPageCount(0), pages{}, registers{} {}
+
+const CpuRegisters& MachineSnapshot::getRegisters() const {
+    return registers;
+}
+
+uint8_t MachineSnapshot::read(uint16_t address) const {
+    const uint8_t* data = pages[address >> 8];
+    if (!data) {
+        data = (*layout)[address >> 8].data;
+    }
+    return data[address & 0xFF];
+}
+
+size_t MachineSnapshot::getOwnPageCount() const {
+    return ownPageCount;
+}
+
+size_t MachineSnapshot::getFootprint() const {
+    return sizeof(MachineSnapshot) + ownPageCount * 256;
+}
+
+// A ForkedMachine's own RAM pages are trapped, so it is forked rather than
+// captured. Every page is copied, ROM included, so the handle depends on
+// nothing the source machine owns.
+SnapshotHandle captureMachine(CPU& cpu) {
+    Bus& bus = cpu.getBus();
+    for (int page = 0; page < 256; page++) {
+        if (bus.getPage(page).device) {
+            return SnapshotHandle();
+        }
+    }
+
+    std::shared_ptr<MachineSnapshot> snapshot(new MachineSnapshot());
+    std::shared_ptr<std::array<Page, 256>> layout = std::make_shared<std::array<Page, 256>>();
+    snapshot->ownPages.reset(new uint8_t[256 * 256]);
+    snapshot->ownPageCount = 256;
+    for (int page = 0; page < 256; page++) {
+        const Page& mapped = bus.getPage(page);
+        uint8_t* copy = snapshot->ownPages.get() + page * 256;
+        std::memcpy(copy, mapped.data, 256);
+        (*layout)[page] = Page{copy, nullptr, mapped.flags};
+        if (isPrivateRam(mapped)) {
+            snapshot->pages[page] = copy;
+        }
+    }
+    snapshot->layout = layout;
+    snapshot->registers = cpu.getRegisters();
+    return snapshot;
+}
+
+ForkedMachine::ForkedMachine(SnapshotHandle snapshot, CpuVariant variant)
+    : bus(memory), cpu(bus, variant), privatePage{}, privateCount(0) {
+    restore(snapshot);
+}
+
+CPU& ForkedMachine::getCpu() {
+    return cpu;
+}
+
+Bus& ForkedMachine::getBus() {
+    return bus;
+}
+
+int ForkedMachine::getPrivatePageCount() const {
+    return privateCount;
+}
+
+// Maps page as the current snapshot has it, unless it already is; a
+// remapped page tells the engines caching code from it.
+void ForkedMachine::mapShared(uint8_t page) {
+    Page target = (*snapshot->layout)[page];
+    if (const uint8_t* data = snapshot->pages[page]) {
+        target = Page{const_cast<uint8_t*>(data), this, PAGE_READ_ONLY | PAGE_WRITE_TRAP};
+    }
+    const Page& current = bus.getPage(page);
+    if (current.data == target.data && current.device == target.device && current.flags == target.flags) {
+        return;
+    }
+    bus.mapMemory(page, 1, target.data, target.flags, target.device);
+}
+
+SnapshotHandle ForkedMachine::fork() {
+    std::shared_ptr<MachineSnapshot> child(new MachineSnapshot());
+    child->parent = snapshot;
+    child->layout = snapshot->layout;
+    std::copy(snapshot->pages, snapshot->pages + 256, child->pages);
+    child->ownPages.reset(new uint8_t[privateCount * 256]);
+    child->ownPageCount = privateCount;
+    for (int i = 0; i < privateCount; i++) {
+        uint8_t page = privateList[i];
+        uint8_t* copy = child->ownPages.get() + i * 256;
+        std::memcpy(copy, &memory[page << 8], 256);
+        child->pages[page] = copy;
+    }
+    child->registers = cpu.getRegisters();
+
+    // Carries on from the new snapshot, sharing what it just handed over.
+    snapshot = child;
+    for (int i = 0; i < privateCount; i++) {
+        privatePage[privateList[i]] = false;
+        mapShared(privateList[i]);
+    }
+    privateCount = 0;
+    return child;
+}
+
+void ForkedMachine::restore(SnapshotHandle target) {
+    snapshot = target;
+    for (int page = 0; page < 256; page++) {
+        mapShared(page);
+    }
+    std::fill(privatePage, privatePage + 256, false);
+    privateCount = 0;
+    cpu.setRegisters(snapshot->registers);
+}
+
+uint8_t ForkedMachine::read(uint16_t address) {
+    return 0xFF;
+}
+
+// The page goes private before the write lands, so the snapshot it came
+// from never changes.
+void ForkedMachine::write(uint16_t address, uint8_t data) {
+    uint8_t page = address >> 8;
+    if (privatePage[page]) {
+        return;
+    }
+    std::memcpy(&memory[page << 8], bus.getPage(page).data, 256);
+    bus.unmap(page, 1);
+    privatePage[page] = true;
+    privateList[privateCount++] = page;
+    memory[address] = data;
+}
@@ -0,0 +1,87 @@
+#ifndef MACHINEFORK_H
+#define MACHINEFORK_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "Bus.h"
+#include "CPU.h"
+#include "Memory.h"
+
+class MachineSnapshot;
+typedef std::shared_ptr<const MachineSnapshot> SnapshotHandle;
+
+// A frozen machine state, shared by handle. RAM pages are 256-byte blocks
+// owned by the snapshot that last wrote them and shared with everything
+// forked from it, so a snapshot owns only the pages written since its
+// parent and keeps the parent alive for the rest. ROM pages are copied
+// once into the root and shared read-only by every fork.
+class MachineSnapshot {
+private:
+    friend class ForkedMachine;
+    friend SnapshotHandle captureMachine(CPU& cpu);
+
+    SnapshotHandle parent;
+    // Each page as the root maps it, onto the root's copies.
+    std::shared_ptr<const std::array<Page, 256>> layout;
+    std::unique_ptr<uint8_t[]> ownPages;
+    size_t ownPageCount;
+    // Contents of each RAM page, nullptr for the pages the layout maps.
+    const uint8_t* pages[256];
+    CpuRegisters registers;
+
+    MachineSnapshot();
+
+public:
+    const CpuRegisters& getRegisters() const;
+    uint8_t read(uint16_t address) const;
+    // Pages this snapshot holds itself, rather than sharing.
+    size_t getOwnPageCount() const;
+    // Host memory the handle keeps alive on its own account.
+    size_t getFootprint() const;
+};
+
+// Freezes a running machine as the root of a tree of forks. The one
+// capture copies every page; everything forked from it after copies only
+// what it writes. Devices are not forked, and a fork sharing one with its
+// parent would switch the parent's banks or poke its I/O, so a machine
+// with device or trapped pages is refused with an empty handle.
+SnapshotHandle captureMachine(CPU& cpu);
+
+// A live machine running on a snapshot's pages. RAM pages start out mapped
+// read-only onto the snapshot with a write trap; the first write to one
+// copies it into this machine's own Memory and maps it there, so running
+// costs a 256-byte copy per page touched. fork() freezes the state into a
+// new handle, copying only the private pages, and restore() switches to
+// any handle by repointing the page table entries that differ.
+class ForkedMachine : public Device {
+private:
+    Memory memory;
+    Bus bus;
+    CPU cpu;
+    SnapshotHandle snapshot;
+    bool privatePage[256];
+    uint8_t privateList[256];
+    int privateCount;
+
+    void mapShared(uint8_t page);
+
+public:
+    explicit ForkedMachine(SnapshotHandle snapshot, CpuVariant variant = CpuVariant::NMOS6502);
+    ForkedMachine(const ForkedMachine&) = delete;
+    ForkedMachine& operator=(const ForkedMachine&) = delete;
+
+    CPU& getCpu();
+    Bus& getBus();
+    // Between instructions only.
+    SnapshotHandle fork();
+    void restore(SnapshotHandle target);
+    int getPrivatePageCount() const;
+
+    // The copy-on-write trap; reads never get here.
+    uint8_t read(uint16_t address) override;
+    void write(uint16_t address, uint8_t data) override;
+};
+
+#endif
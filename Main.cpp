@@ -1,38 +1,284 @@
 #include <iostream>
 #include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
+#include "BankMapper.h"
+#include "Benchmark.h"
 #include "Bus.h"
 #include "CPU.h"
 #include "Memory.h"
+#include "ProgramLoader.h"
+#include "Recompiler.h"
+#include "RomImage.h"
+#include "SaveState.h"
+#include "TrapRoutines.h"
+#include "Traps.h"
+
+namespace {
+
+// --engine= names. Every engine runs on the page-table Bus this sets up;
+// only threaded also has versions instantiated on the MappedBus fixed maps,
+// for machines built on one of those.
+const std::pair<const char*, ExecutionEngine> engineNames[] = {
+    {"fused", ExecutionEngine::Fused}, {"threaded", ExecutionEngine::Threaded}, {"cached", ExecutionEngine::Cached},
+    {"jit", ExecutionEngine::Jit}, {"cycle", ExecutionEngine::Cycle}, {"static", ExecutionEngine::Static},
+};
+
+const char* engineName(ExecutionEngine engine) {
+    for (const auto& entry : engineNames) {
+        if (entry.second == engine) {
+            return entry.first;
+        }
+    }
+    return "unknown";
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    std::string programPath = "6502_functional_test.bin";
+    // Where a raw image is loaded, and where to start when the program file
+    // does not say; the defaults suit the functional test. A load address
+    // given for an o65 file relocates its text there.
+    uint16_t loadAddress = 0x000a;
+    bool loadGiven = false;
+    uint16_t startPC = 0x400;
+    bool startGiven = false;
+    bool formatGiven = false;
+    ProgramFormat format = ProgramFormat::Raw;
+    bool benchmark = false;
+    bool verify = false;
+    std::string recompilePath;
+    std::string fixturePath;
+    std::string romPath;
+    std::string banksPath;
+    std::string loadStatePath;
+    std::string saveStatePath;
+    bool compressState = false;
+    std::vector<std::pair<const TrapRoutine*, uint16_t>> trapRoutines;
+    bool verifyTrapCalls = false;
+    ExecutionEngine engine = ExecutionEngine::Fused;
+    CpuVariant variant = CpuVariant::NMOS6502;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--bench") == 0) {
+            benchmark = true;
+        } else if (std::strcmp(argv[i], "--verify") == 0) {
+            verify = true;
+        } else if (std::strncmp(argv[i], "--engine=", 9) == 0) {
+            bool known = false;
+            for (const auto& entry : engineNames) {
+                if (std::strcmp(entry.first, argv[i] + 9) == 0) {
+                    engine = entry.second;
+                    known = true;
+                }
+            }
+            if (!known) {
+                std::cerr << "Unknown engine " << argv[i] + 9 << "; --engine= takes";
+                for (const auto& entry : engineNames) {
+                    std::cerr << " " << entry.first;
+                }
+                std::cerr << " (only threaded decodes MappedBus fixed maps at compile time)" << std::endl;
+                return 1;
+            }
+        } else if (std::strncmp(argv[i], "--banks=", 8) == 0) {
+            banksPath = argv[i] + 8;
+        } else if (std::strncmp(argv[i], "--load-state=", 13) == 0) {
+            loadStatePath = argv[i] + 13;
+        } else if (std::strncmp(argv[i], "--save-state=", 13) == 0) {
+            saveStatePath = argv[i] + 13;
+        } else if (std::strcmp(argv[i], "--compress-state") == 0) {
+            compressState = true;
+        } else if (std::strncmp(argv[i], "--trap=", 7) == 0) {
+            // --trap=<routine>@<address>: the program has that routine
+            // there, called the way TrapRoutines.h describes.
+            const char* at = std::strchr(argv[i] + 7, '@');
+            const TrapRoutine* routine = at ? findTrapRoutine(std::string(argv[i] + 7, at - (argv[i] + 7))) : nullptr;
+            if (!routine) {
+                std::cerr << "Expected --trap=memcpy@<address> or --trap=multiply@<address>" << std::endl;
+                return 1;
+            }
+            trapRoutines.push_back(std::make_pair(routine, static_cast<uint16_t>(std::strtoul(at + 1, nullptr, 0))));
+        } else if (std::strcmp(argv[i], "--verify-traps") == 0) {
+            verifyTrapCalls = true;
+        } else if (std::strncmp(argv[i], "--rom=", 6) == 0) {
+            romPath = argv[i] + 6;
+        } else if (std::strncmp(argv[i], "--load=", 7) == 0) {
+            loadAddress = static_cast<uint16_t>(std::strtoul(argv[i] + 7, nullptr, 0));
+            loadGiven = true;
+        } else if (std::strncmp(argv[i], "--start=", 8) == 0) {
+            startPC = static_cast<uint16_t>(std::strtoul(argv[i] + 8, nullptr, 0));
+            startGiven = true;
+        } else if (std::strncmp(argv[i], "--format=", 9) == 0) {
+            if (!parseProgramFormat(argv[i] + 9, format)) {
+                std::cerr << "Unknown program format " << argv[i] + 9 << std::endl;
+                return 1;
+            }
+            formatGiven = true;
+        } else if (std::strncmp(argv[i], "--recompile=", 12) == 0) {
+            recompilePath = argv[i] + 12;
+        } else if (std::strncmp(argv[i], "--recompile-fixture=", 20) == 0) {
+            fixturePath = argv[i] + 20;
+        } else if (std::strcmp(argv[i], "--cpu=65c02") == 0) {
+            variant = CpuVariant::WDC65C02;
+        } else if (std::strcmp(argv[i], "--cpu=2a03") == 0) {
+            variant = CpuVariant::Ricoh2A03;
+        } else if (std::strcmp(argv[i], "--cpu=6502") == 0) {
+            variant = CpuVariant::NMOS6502;
+        } else {
+            programPath = argv[i];
+        }
+    }
+
+    if (benchmark) {
+        benchmarkDispatch(BenchmarkConfig{programPath, loadAddress, startPC, 50000000});
+        return 0;
+    }
+    if (verify) {
+        int differences = verifyEngines(500, 20000) + verifyDecimalMode() + verifyTraps(2000) +
+                          verifyStaticEngine(2000) + verifyMemoryMaps(200000, 50, 20000);
+        return differences == 0 ? 0 : 1;
+    }
+    // Regenerates StaticFixture.cpp, which --verify runs the Static engine on.
+    if (!fixturePath.empty()) {
+        std::ofstream out(fixturePath);
+        emitStaticFixture(out);
+        return 0;
+    }
 
-int main() {
     Memory memory;
     Bus bus(memory);
-    CPU cpu(bus);
+    CPU cpu(bus, variant);
 
-    std::string programPath = "C:\\Users\\impm7\\Desktop\\6502\\6502_functional_test.bin";
+    ProgramLoader loader(memory);
+    if (loadGiven) {
+        loader.relocateO65(loadAddress);
+    }
+    bool loaded = formatGiven ? loader.load(programPath, format, loadAddress) : loader.load(programPath, loadAddress);
+    if (!loaded) {
+        std::cerr << "Cannot load " << programPath << ": " << loader.getError() << std::endl;
+        return 1;
+    }
+    printLoadedProgram(std::cout, programPath, loader.getProgram());
+    if (!startGiven && loader.getProgram().hasEntry) {
+        startPC = loader.getProgram().entry;
+    }
 
-    memory.loadProgram(programPath, 0x000a);
-    cpu.reset();
-    cpu.setPC(0x400);
+    // A ROM image is mapped over the top of the address space, where the
+    // vectors are, and stays open for the whole run. It has to be whole
+    // pages, so that its last bytes land on $FFFA-$FFFF.
+    RomImage rom;
+    if (!romPath.empty()) {
+        if (!rom.open(romPath) || rom.getSize() > 0x10000) {
+            std::cerr << "Cannot map ROM image " << romPath << std::endl;
+            return 1;
+        }
+        if (rom.getSize() & 0xFF) {
+            std::cerr << "ROM image " << romPath << " is not a multiple of 256 bytes" << std::endl;
+            return 1;
+        }
+        rom.attach(bus, (0x10000 - rom.getSize()) & 0xFF00);
+        printImageStats(std::cout, romPath, rom.getStats());
+    }
 
-    bool running = true;
+    // A banked ROM image larger than the address space shows 16K banks at
+    // $8000, switched by writing the bank number there, and its last bank
+    // fixed at $C000 for the vectors.
+    RomImage banks;
+    std::unique_ptr<BankMapper> mapper;
+    if (!banksPath.empty()) {
+        if (!banks.open(banksPath) || banks.getSize() < 0x4000) {
+            std::cerr << "Cannot map banked image " << banksPath << std::endl;
+            return 1;
+        }
+        mapper.reset(new BankMapper(bus, banks.getData(), banks.getSize(), 0x4000, RegionType::Rom));
+        mapper->addWindow(0x8000, 0);
+        mapper->addWindow(0xC000, mapper->getBankCount() - 1, false);
+        printImageStats(std::cout, banksPath, banks.getStats());
+    }
 
-    while (running) {
-        try {
-            cpu.execute();
-            
-            if (cpu.getPC() > 0xFFFF) {
-                std::cerr << "Error: Program counter out of bounds (0x" << std::hex << cpu.getPC() << ")." << std::endl;
-            }
-        } catch (const std::exception& e) {
-            std::cerr << "Error: Exception caught during execution - " << e.what() << std::endl;
+    // Writes C++ for the program to compile and link in for --engine=static.
+    if (!recompilePath.empty()) {
+        Recompiler recompiler(bus);
+        recompiler.addEntry(bus.readMemory(0xFFFC) | (bus.readMemory(0xFFFD) << 8));
+        recompiler.addEntry(startPC);
+        recompiler.walk();
+        std::ofstream out(recompilePath);
+        recompiler.emit(out, programPath);
+        std::cout << "Recompiled " << recompiler.getInstructionCount() << " instructions in "
+                  << recompiler.getBlockCount() << " blocks to " << recompilePath << std::endl;
+        return 0;
+    }
+
+    // Traps go in once the program is loaded, since loading over one
+    // removes it. They run on the fused engine.
+    TrapRegistry traps(bus);
+    for (const auto& trap : trapRoutines) {
+        if (!traps.install(trap.second, trap.first->name, trap.first->native)) {
+            std::cerr << "Cannot install trap " << trap.first->name << " at 0x" << std::hex << trap.second << std::endl;
+            return 1;
         }
-        
     }
+    if (!trapRoutines.empty()) {
+        traps.setVerify(verifyTrapCalls);
+        cpu.setTrapRegistry(&traps);
+    }
+
+    cpu.reset();
+    cpu.setPC(startPC);
+    cpu.setExecutionEngine(engine);
+    // The CPU falls back to another engine where the one asked for cannot
+    // run: the block cache without JIT support, and the fused engine for
+    // other variants, with traps, or for static without a recompiled
+    // program linked in.
+    if (cpu.getExecutionEngine() != engine) {
+        std::cerr << "The " << engineName(engine) << " engine cannot run this, using the "
+                  << engineName(cpu.getExecutionEngine()) << " engine" << std::endl;
+    }
+
+    // A saved state picks up where it left off, over the program just
+    // loaded; uncompressed files are mapped rather than read.
+    SaveState loadedState;
+    if (!loadStatePath.empty() && !(loadedState.load(loadStatePath) && loadedState.attach(cpu))) {
+        std::cerr << "Cannot load state " << loadStatePath << ": " << loadedState.getError() << std::endl;
+        return 1;
+    }
+
+    // The functional test traps in a JMP * or branch-to-self loop when it
+    // finishes, on success or failure alike; other programs end up polling
+    // for an interrupt that never comes.
+    StopConditions conditions;
+    conditions.stopOnHalt = true;
+    conditions.idleAction = IdleAction::Stop;
+
+    RunResult result;
+    uint64_t executed = 0;
+    do {
+        result = cpu.run(1 << 16, conditions);
+        executed += result.instructions;
+    } while (result.reason == StopReason::Budget);
+
+    std::cout << "Stopped on " << stopReasonName(result.reason) << " at 0x" << std::hex << result.address
+              << std::dec << " after " << executed << " instructions, " << cpu.getCycles() << " cycles" << std::endl;
     std::cout << "\nFinal CPU State:" << std::endl;
     cpu.printState();
+    if (!trapRoutines.empty()) {
+        traps.printStats();
+    }
+
+    if (!saveStatePath.empty()) {
+        SaveState state;
+        state.capture(cpu, compressState);
+        if (!state.save(saveStatePath)) {
+            std::cerr << "Cannot write state " << saveStatePath << std::endl;
+            return 1;
+        }
+        std::cout << "Saved state to " << saveStatePath << ", " << std::dec << state.getSize() << " bytes" << std::endl;
+    }
     return 0;
 }
-
-
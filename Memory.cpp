@@ -1,5 +1,6 @@
 
 #include "Memory.h"
+#include <algorithm>
 #include <cstring> 
 #include <fstream>
 #include <iostream>
@@ -8,40 +9,26 @@ Memory::Memory() {
     std::memset(memory, 0, sizeof(memory));
 }
 
-uint8_t Memory::read(uint16_t address) {
-    if (address < sizeof(memory)) {
-        return memory[address];
-    }
-    return 0;
-}
-
-void Memory::write(uint16_t address, uint8_t data) {
-    if (address < sizeof(memory)) {
-        memory[address] = data;
-    }
-}
-
-void Memory::loadProgram(const std::string& filepath, uint16_t startAddress) {
-    std::ifstream file(filepath, std::ios::binary);
+size_t Memory::loadProgram(const std::string& filepath, uint16_t startAddress) {
+    std::ifstream file(filepath, std::ios::binary | std::ios::ate);
     if (!file) {
         std::cerr << "Error opening file: " << filepath << std::endl;
-        return;
+        return 0;
     }
 
-    uint8_t byte;
-    uint16_t address = startAddress;
-
-    while (file.read(reinterpret_cast<char*>(&byte), sizeof(byte))) {
-        if (address >= sizeof(memory)) {
-            std::cerr << "Attempt to write past memory bounds at address " << std::hex << address << std::endl;
-            break;
-        }
-        write(address++, byte);  
+    size_t size = file.tellg();
+    size_t space = sizeof(memory) - startAddress;
+    if (size > space) {
+        std::cerr << "Attempt to write past memory bounds at address " << std::hex << sizeof(memory) << std::dec << std::endl;
+        size = space;
     }
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(memory + startAddress), size);
+    return file.gcount();
+}
 
-    std::cout << "Program loaded into memory starting at address " << std::hex << startAddress;
-    std::cout << " & ending at " << std::hex << address - 1 <<std::endl;
-    file.close();
+void Memory::writeBlock(uint16_t address, const uint8_t* data, size_t length) {
+    std::memcpy(memory + address, data, std::min(length, sizeof(memory) - address));
 }
 
 uint8_t& Memory::operator[](uint16_t address) {
@@ -49,4 +36,4 @@ uint8_t& Memory::operator[](uint16_t address) {
         throw std::out_of_range("Address is out of bounds");
     }
     return memory[address];
-}
\ No newline at end of file
+}
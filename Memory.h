@@ -2,6 +2,7 @@
 #ifndef MEMORY_H
 #define MEMORY_H
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
 
@@ -13,8 +14,22 @@ public:
     Memory();
     uint8_t read(uint16_t address);
     void write(uint16_t address, uint8_t data);
-    void loadProgram(const std::string& filepath, uint16_t startAddress);
+    // Copies the file in from startAddress in one read, as far as the end
+    // of memory. Returns the bytes loaded.
+    size_t loadProgram(const std::string& filepath, uint16_t startAddress);
+    // Copies length bytes in from address, as far as the end of memory.
+    void writeBlock(uint16_t address, const uint8_t* data, size_t length);
     uint8_t& operator[](uint16_t address);//debugging
 };
 
-#endif 
+// A uint16_t address is always in range.
+inline uint8_t Memory::read(uint16_t address) {
+    return memory[address];
+}
+
+inline void Memory::write(uint16_t address, uint8_t data) {
+    memory[address] = data;
+}
+
+#endif
+
@@ -0,0 +1,19 @@
+#include "MemoryMap.h"
+
+constexpr MemoryRegion FlatRamMap::regions[];
+constexpr MemoryRegion MonitorRomMap::regions[];
+
+// Device regions stay on the Memory until a device is mapped there.
+void mapRegions(Bus& bus, Memory& memory, const MemoryRegion* regions, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        const MemoryRegion& region = regions[i];
+        if (region.type == RegionType::Device) {
+            continue;
+        }
+        uint8_t flags = region.type == RegionType::Rom ? PAGE_READ_ONLY : 0;
+        for (unsigned page = region.start >> 8; page <= static_cast<unsigned>(region.end >> 8); page++) {
+            uint16_t address = region.start + (((page << 8) - region.start) & (region.size - 1));
+            bus.mapMemory(page, 1, &memory[address], flags);
+        }
+    }
+}
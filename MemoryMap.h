@@ -0,0 +1,160 @@
+#ifndef MEMORYMAP_H
+#define MEMORYMAP_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include "Bus.h"
+
+enum class RegionType : uint8_t {
+    Ram,
+    Rom,        // writes are dropped
+    Device      // goes to the device attached with MappedBus::attachDevice()
+};
+
+// A page-aligned span of the address space, start to end inclusive. RAM and
+// ROM are backed by the Memory: size bytes from start, mirrored through the
+// rest of the span when it is larger. size must be a power of two.
+struct MemoryRegion {
+    uint16_t start;
+    uint16_t end;
+    RegionType type;
+    uint32_t size;
+};
+
+// Maps regions onto bus's page table, for ad-hoc machines described the same
+// way as the fixed maps below. Device regions are left as they are.
+void mapRegions(Bus& bus, Memory& memory, const MemoryRegion* regions, size_t count);
+
+// Fixed machine configurations. Each lists its regions in the order
+// MappedBus tests addresses against them, so the busiest goes first, and
+// has to cover the whole address space.
+
+// The whole address space as RAM, as Main and Benchmark set it up.
+struct FlatRamMap {
+    static constexpr MachineMap id = MachineMap::FlatRam;
+    static constexpr MemoryRegion regions[] = {
+        {0x0000, 0xFFFF, RegionType::Ram, 0x10000},
+    };
+};
+
+// 52K of RAM, three I/O pages at $D000 and 8K of ROM at the top holding the
+// vectors.
+struct MonitorRomMap {
+    static constexpr MachineMap id = MachineMap::MonitorRom;
+    static constexpr MemoryRegion regions[] = {
+        {0x0000, 0xCFFF, RegionType::Ram, 0x10000},
+        {0xE000, 0xFFFF, RegionType::Rom, 0x2000},
+        {0xD000, 0xD2FF, RegionType::Device, 0x0300},
+        {0xD300, 0xDFFF, RegionType::Ram, 0x10000},
+    };
+};
+
+// A Bus whose decode is fixed at compile time. readMemory() and
+// writeMemory() hide the page-table versions with a chain of constant range
+// checks ending in a direct access to the Memory's array, which folds away
+// entirely for constant addresses such as the stack page. The page table is
+// filled in from the same map, so everything going through the Bus type
+// sees the same machine. mapMemory() and friends refuse to change the
+// pages of its RAM and ROM regions afterwards; Device regions stay open to
+// mapping, since both paths reach them through the page table. Engines that
+// know the map instantiate themselves on it, see ThreadedEngine.
+template <typename Map>
+class MappedBus : public Bus {
+private:
+    static constexpr size_t regionCount = sizeof(Map::regions) / sizeof(MemoryRegion);
+    uint8_t* const base;
+
+    // Index into the Memory of an address inside a RAM or ROM region.
+    template <size_t Index>
+    static uint16_t offset(uint16_t address) {
+        constexpr MemoryRegion region = Map::regions[Index];
+        return region.start + ((address - region.start) & (region.size - 1));
+    }
+
+    template <size_t Index>
+    uint8_t readRegion(uint16_t address);
+    template <size_t Index>
+    void writeRegion(uint16_t address, uint8_t data);
+
+public:
+    explicit MappedBus(Memory& mem);
+
+    uint8_t readMemory(uint16_t address);
+    void writeMemory(uint16_t address, uint8_t data);
+    // Attaches device to every page of the map's Device regions.
+    void attachDevice(Device* device);
+};
+
+template <typename Map>
+MappedBus<Map>::MappedBus(Memory& mem) : Bus(mem), base(&mem[0]) {
+    machineMap = Map::id;
+    mapRegions(*this, mem, Map::regions, regionCount);
+    for (const MemoryRegion& region : Map::regions) {
+        if (region.type != RegionType::Device) {
+            std::fill(fixedPages + (region.start >> 8), fixedPages + (region.end >> 8) + 1, true);
+        }
+    }
+}
+
+template <typename Map>
+template <size_t Index>
+inline uint8_t MappedBus<Map>::readRegion(uint16_t address) {
+    if constexpr (Index == regionCount) {
+        return readPaged(address);
+    } else {
+        constexpr MemoryRegion region = Map::regions[Index];
+        if (address < region.start || address > region.end) {
+            return readRegion<Index + 1>(address);
+        }
+        if constexpr (region.type == RegionType::Device) {
+            return readPaged(address);
+        } else {
+            return base[offset<Index>(address)];
+        }
+    }
+}
+
+// RAM stores directly, leaving only the watched-page check; ROM and devices
+// go out of line through the page table, which knows their flags and
+// handlers.
+template <typename Map>
+template <size_t Index>
+inline void MappedBus<Map>::writeRegion(uint16_t address, uint8_t data) {
+    if constexpr (Index == regionCount) {
+        writePaged(address, data);
+    } else {
+        constexpr MemoryRegion region = Map::regions[Index];
+        if (address < region.start || address > region.end) {
+            writeRegion<Index + 1>(address, data);
+        } else if constexpr (region.type == RegionType::Ram) {
+            base[offset<Index>(address)] = data;
+            if (watchedPages[address >> 8]) {
+                notifyWatchers(address);
+            }
+        } else {
+            writePaged(address, data);
+        }
+    }
+}
+
+template <typename Map>
+inline uint8_t MappedBus<Map>::readMemory(uint16_t address) {
+    return readRegion<0>(address);
+}
+
+template <typename Map>
+inline void MappedBus<Map>::writeMemory(uint16_t address, uint8_t data) {
+    writeRegion<0>(address, data);
+}
+
+template <typename Map>
+void MappedBus<Map>::attachDevice(Device* device) {
+    for (const MemoryRegion& region : Map::regions) {
+        if (region.type == RegionType::Device) {
+            mapDevice(region.start >> 8, ((region.end - region.start) >> 8) + 1, device);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,543 @@
+#ifndef OPCODETABLE_H
+#define OPCODETABLE_H
+
+#include <array>
+#include <cstdint>
+
+enum class AddressingModeType {
+    Implied, Immediate, Relative,
+    ZeroPage, ZeroPageX, ZeroPageY,
+    Absolute, AbsoluteX, AbsoluteY,
+    Indirect, IndexedIndirectX, IndirectIndexedY,
+    Accumulator,
+    // 65C02 only: (zp), and JMP (abs) reading its pointer across a page
+    // boundary where the NMOS Indirect mode wraps within the page.
+    ZeroPageIndirect, IndirectNoWrap
+};
+
+enum class OperationType {
+    LDA, LDX, LDY, STA, STX, STY,
+    ADC, SBC, CMP, CPX, CPY,
+    AND, ORA, EOR, BIT,
+    INC, DEC, INX, INY, DEX, DEY,
+    ASL, LSR, ROR, ROL,
+    BCC, BCS, BEQ, BNE, BMI, BPL, BVC, BVS,
+    CLC, SEC, CLD, SED, CLI, SEI, CLV,
+    JMP, JSR, RTS,
+    NOP, BRK, RTI,
+    TAX, TAY, TXA, TYA,
+    TXS, TSX, PHA, PHP, PLA, PLP,
+    // 65C02 only
+    BRA, STZ, PHX, PHY, PLX, PLY, TRB, TSB
+};
+
+// Instruction set variants. Each one is a compile-time policy: it selects
+// the opcode map the fused handlers and dispatch table are generated from,
+// so a CPU pays nothing at run time for the variant it was built as.
+enum class CpuVariant {
+    NMOS6502,   // the original 6502
+    WDC65C02,   // CMOS 65C02, with its extra instructions and fixed JMP (abs)
+    Ricoh2A03   // NES CPU: the NMOS instruction set without decimal mode
+};
+
+struct NMOS6502 {
+    static constexpr CpuVariant variant = CpuVariant::NMOS6502;
+    static constexpr bool cmosInstructions = false;
+    static constexpr bool decimalMode = true;
+};
+
+struct WDC65C02 {
+    static constexpr CpuVariant variant = CpuVariant::WDC65C02;
+    static constexpr bool cmosInstructions = true;
+    static constexpr bool decimalMode = true;
+};
+
+struct Ricoh2A03 {
+    static constexpr CpuVariant variant = CpuVariant::Ricoh2A03;
+    static constexpr bool cmosInstructions = false;
+    static constexpr bool decimalMode = false;
+};
+
+// Number of operand bytes that follow the opcode.
+constexpr uint8_t operandLength(AddressingModeType mode) {
+    switch (mode) {
+        case AddressingModeType::Implied:
+        case AddressingModeType::Accumulator:
+            return 0;
+        case AddressingModeType::Absolute:
+        case AddressingModeType::AbsoluteX:
+        case AddressingModeType::AbsoluteY:
+        case AddressingModeType::Indirect:
+        case AddressingModeType::IndirectNoWrap:
+            return 2;
+        default:
+            return 1;
+    }
+}
+
+// Operations that may leave PC somewhere other than the next instruction.
+constexpr bool changesControlFlow(OperationType operation) {
+    switch (operation) {
+        case OperationType::BCC: case OperationType::BCS:
+        case OperationType::BEQ: case OperationType::BNE:
+        case OperationType::BMI: case OperationType::BPL:
+        case OperationType::BVC: case OperationType::BVS:
+        case OperationType::JMP: case OperationType::JSR:
+        case OperationType::RTS: case OperationType::RTI:
+        case OperationType::BRK: case OperationType::BRA:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Status register bits, in the order of CPU's StatusRegister bitfield.
+enum StatusFlag : uint8_t {
+    FLAG_C = 0x01, FLAG_Z = 0x02, FLAG_I = 0x04, FLAG_D = 0x08,
+    FLAG_B = 0x10, FLAG_U = 0x20, FLAG_V = 0x40, FLAG_N = 0x80,
+    FLAG_ALL = 0xFF
+};
+
+// Status bits an operation's result depends on.
+constexpr uint8_t flagsRead(OperationType operation) {
+    switch (operation) {
+        case OperationType::ADC: case OperationType::SBC:
+            return FLAG_C | FLAG_D;
+        case OperationType::ROL: case OperationType::ROR:
+        case OperationType::BCC: case OperationType::BCS:
+            return FLAG_C;
+        case OperationType::BEQ: case OperationType::BNE:
+            return FLAG_Z;
+        case OperationType::BMI: case OperationType::BPL:
+            return FLAG_N;
+        case OperationType::BVC: case OperationType::BVS:
+            return FLAG_V;
+        case OperationType::PHP: case OperationType::BRK:
+            return FLAG_ALL;
+        default:
+            return 0;
+    }
+}
+
+// Status bits an operation overwrites.
+constexpr uint8_t flagsWritten(OperationType operation) {
+    switch (operation) {
+        case OperationType::LDA: case OperationType::LDX: case OperationType::LDY:
+        case OperationType::AND: case OperationType::ORA: case OperationType::EOR:
+        case OperationType::INC: case OperationType::DEC:
+        case OperationType::INX: case OperationType::INY:
+        case OperationType::DEX: case OperationType::DEY:
+        case OperationType::TAX: case OperationType::TAY:
+        case OperationType::TXA: case OperationType::TYA:
+        case OperationType::TSX: case OperationType::PLA:
+        case OperationType::PLX: case OperationType::PLY:
+            return FLAG_N | FLAG_Z;
+        case OperationType::CMP: case OperationType::CPX: case OperationType::CPY:
+        case OperationType::ASL: case OperationType::LSR:
+        case OperationType::ROL: case OperationType::ROR:
+            return FLAG_N | FLAG_Z | FLAG_C;
+        case OperationType::ADC: case OperationType::SBC:
+            return FLAG_N | FLAG_Z | FLAG_C | FLAG_V;
+        case OperationType::BIT:
+            return FLAG_N | FLAG_Z | FLAG_V;
+        case OperationType::CLC: case OperationType::SEC:
+            return FLAG_C;
+        case OperationType::CLI: case OperationType::SEI:
+            return FLAG_I;
+        case OperationType::CLD: case OperationType::SED:
+            return FLAG_D;
+        case OperationType::CLV:
+            return FLAG_V;
+        case OperationType::TRB: case OperationType::TSB:
+            return FLAG_Z;
+        case OperationType::PHP:
+            return FLAG_B | FLAG_U;
+        case OperationType::BRK:
+            return FLAG_B | FLAG_U | FLAG_I;
+        case OperationType::PLP: case OperationType::RTI:
+            return FLAG_ALL;
+        default:
+            return 0;
+    }
+}
+
+struct OpcodeInfo {
+    AddressingModeType addressingMode;
+    OperationType operation;
+    bool valid;
+};
+
+// Instructions that store to memory, including the stack.
+constexpr bool writesMemory(const OpcodeInfo& info) {
+    switch (info.operation) {
+        case OperationType::STA: case OperationType::STX: case OperationType::STY:
+        case OperationType::PHA: case OperationType::PHP:
+        case OperationType::JSR: case OperationType::BRK:
+        case OperationType::INC: case OperationType::DEC:
+        case OperationType::STZ: case OperationType::PHX: case OperationType::PHY:
+        case OperationType::TRB: case OperationType::TSB:
+            return true;
+        case OperationType::ASL: case OperationType::LSR:
+        case OperationType::ROL: case OperationType::ROR:
+            return info.addressingMode != AddressingModeType::Accumulator;
+        default:
+            return false;
+    }
+}
+
+// The opcode map is built at compile time so that both the runtime dispatch
+// table and the template-generated fused handlers are derived from it.
+template <typename Variant>
+constexpr std::array<OpcodeInfo, 256> buildOpcodeTable() {
+    std::array<OpcodeInfo, 256> table{};
+    for (auto& entry : table) {
+        entry = OpcodeInfo{AddressingModeType::Implied, OperationType::NOP, false};
+    }
+
+    //Load & Store Operations
+    // LDA - Load Accumulator
+    table[0xA9] = OpcodeInfo{AddressingModeType::Immediate, OperationType::LDA, true};   // LDA Immediate
+    table[0xA5] = OpcodeInfo{AddressingModeType::ZeroPage, OperationType::LDA, true};   // LDA ZeroPage
+    table[0xA1] = OpcodeInfo{AddressingModeType::IndexedIndirectX, OperationType::LDA, true};  // LDA (Indirect,X)
+    table[0xAD] = OpcodeInfo{AddressingModeType::Absolute, OperationType::LDA, true};  // LDA Absolute
+    table[0xB5] = OpcodeInfo{AddressingModeType::ZeroPageX, OperationType::LDA, true}; // LDA ZeroPage,X
+    table[0xB1] = OpcodeInfo{AddressingModeType::IndirectIndexedY, OperationType::LDA, true}; // LDA (Indirect),Y
+    table[0xBD] = OpcodeInfo{AddressingModeType::AbsoluteX, OperationType::LDA, true};  // LDA Absolute,X
+    table[0xB9] = OpcodeInfo{AddressingModeType::AbsoluteY, OperationType::LDA, true};  // LDA Absolute,Y
+
+    // LDX - Load X Register
+    table[0xA2] = OpcodeInfo{AddressingModeType::Immediate, OperationType::LDX, true};  // LDX Immediate
+    table[0xA6] = OpcodeInfo{AddressingModeType::ZeroPage, OperationType::LDX, true};   // LDX ZeroPage
+    table[0xAE] = OpcodeInfo{AddressingModeType::Absolute, OperationType::LDX, true};   // LDX Absolute
+    table[0xB6] = OpcodeInfo{AddressingModeType::ZeroPageY, OperationType::LDX, true};  // LDX ZeroPage,Y
+    table[0xBE] = OpcodeInfo{AddressingModeType::AbsoluteY, OperationType::LDX, true};  // LDX Absolute,Y
+
+    // LDY - Load Y Register
+    table[0xA0] = OpcodeInfo{AddressingModeType::Immediate, OperationType::LDY, true};  // LDY Immediate
+    table[0xA4] = OpcodeInfo{AddressingModeType::ZeroPage, OperationType::LDY, true};   // LDY ZeroPage
+    table[0xAC] = OpcodeInfo{AddressingModeType::Absolute, OperationType::LDY, true};   // LDY Absolute
+    table[0xB4] = OpcodeInfo{AddressingModeType::ZeroPageX, OperationType::LDY, true};  // LDY ZeroPage,X
+    table[0xBC] = OpcodeInfo{AddressingModeType::AbsoluteX, OperationType::LDY, true};  // LDY Absolute,X
+
+    // STA - Store Accumulator
+    table[0x8D] = OpcodeInfo{AddressingModeType::Absolute, OperationType::STA, true};    // STA Absolute
+    table[0x85] = OpcodeInfo{AddressingModeType::ZeroPage, OperationType::STA, true};    // STA ZeroPage
+    table[0x81] = OpcodeInfo{AddressingModeType::IndexedIndirectX, OperationType::STA, true}; // STA (Indirect,X)
+    table[0x95] = OpcodeInfo{AddressingModeType::ZeroPageX, OperationType::STA, true};   // STA ZeroPage,X
+    table[0x91] = OpcodeInfo{AddressingModeType::IndirectIndexedY, OperationType::STA, true}; // STA (Indirect),Y
+    table[0x99] = OpcodeInfo{AddressingModeType::AbsoluteY, OperationType::STA, true};   // STA Absolute,Y
+    table[0x9D] = OpcodeInfo{AddressingModeType::AbsoluteX, OperationType::STA, true};   // STA Absolute,X
+
+    // STX - Store X Register
+    table[0x8E] = OpcodeInfo{AddressingModeType::Absolute, OperationType::STX, true};    // STX Absolute
+    table[0x86] = OpcodeInfo{AddressingModeType::ZeroPage, OperationType::STX, true};    // STX ZeroPage
+    table[0x96] = OpcodeInfo{AddressingModeType::ZeroPageY, OperationType::STX, true};   // STX ZeroPage,Y
+
+    // STY - Store Y Register
+    table[0x8C] = OpcodeInfo{AddressingModeType::Absolute, OperationType::STY, true};    // STY Absolute
+    table[0x84] = OpcodeInfo{AddressingModeType::ZeroPage, OperationType::STY, true};    // STY ZeroPage
+    table[0x94] = OpcodeInfo{AddressingModeType::ZeroPageX, OperationType::STY, true};   // STY ZeroPage,X
+
+    // Transfer Operations
+    table[0xAA] = OpcodeInfo{AddressingModeType::Implied, OperationType::TAX, true};  // TAX
+    table[0xA8] = OpcodeInfo{AddressingModeType::Implied, OperationType::TAY, true};  // TAY
+    table[0x8A] = OpcodeInfo{AddressingModeType::Implied, OperationType::TXA, true};  // TXA
+    table[0x98] = OpcodeInfo{AddressingModeType::Implied, OperationType::TYA, true};  // TYA
+
+    // Stack Operations
+    table[0xBA] = OpcodeInfo{AddressingModeType::Implied, OperationType::TSX, true};  // TSX
+    table[0x9A] = OpcodeInfo{AddressingModeType::Implied, OperationType::TXS, true};  // TXS
+    table[0x48] = OpcodeInfo{AddressingModeType::Implied, OperationType::PHA, true};  // PHA
+    table[0x08] = OpcodeInfo{AddressingModeType::Implied, OperationType::PHP, true};  // PHP
+    table[0x68] = OpcodeInfo{AddressingModeType::Implied, OperationType::PLA, true};  // PLA
+    table[0x28] = OpcodeInfo{AddressingModeType::Implied, OperationType::PLP, true};  // PLP
+
+
+    // Logical Instructions
+    // AND - Logical AND
+    table[0x29] = OpcodeInfo{AddressingModeType::Immediate, OperationType::AND, true};  // AND Immediate
+    table[0x25] = OpcodeInfo{AddressingModeType::ZeroPage, OperationType::AND, true};  // AND ZeroPage
+    table[0x21] = OpcodeInfo{AddressingModeType::IndexedIndirectX, OperationType::AND, true};  // AND (Indirect,X)
+    table[0x2D] = OpcodeInfo{AddressingModeType::Absolute, OperationType::AND, true};  // AND Absolute
+    table[0x35] = OpcodeInfo{AddressingModeType::ZeroPageX, OperationType::AND, true};  // AND ZeroPage,X
+    table[0x31] = OpcodeInfo{AddressingModeType::IndirectIndexedY, OperationType::AND, true};  // AND (Indirect),Y
+    table[0x3D] = OpcodeInfo{AddressingModeType::AbsoluteX, OperationType::AND, true};  // AND Absolute,X
+    table[0x39] = OpcodeInfo{AddressingModeType::AbsoluteY, OperationType::AND, true};  // AND Absolute,Y
+
+    // EOR - Exclusive OR
+    table[0x49] = OpcodeInfo{AddressingModeType::Immediate, OperationType::EOR, true};  // EOR Immediate
+    table[0x45] = OpcodeInfo{AddressingModeType::ZeroPage, OperationType::EOR, true};  // EOR ZeroPage
+    table[0x41] = OpcodeInfo{AddressingModeType::IndexedIndirectX, OperationType::EOR, true};  // EOR (Indirect,X)
+    table[0x4D] = OpcodeInfo{AddressingModeType::Absolute, OperationType::EOR, true};  // EOR Absolute
+    table[0x55] = OpcodeInfo{AddressingModeType::ZeroPageX, OperationType::EOR, true};  // EOR ZeroPage,X
+    table[0x51] = OpcodeInfo{AddressingModeType::IndirectIndexedY, OperationType::EOR, true};  // EOR (Indirect),Y
+    table[0x5D] = OpcodeInfo{AddressingModeType::AbsoluteX, OperationType::EOR, true};  // EOR Absolute,X
+    table[0x59] = OpcodeInfo{AddressingModeType::AbsoluteY, OperationType::EOR, true};  // EOR Absolute,Y
+
+    // ORA - Logical OR
+    table[0x09] = OpcodeInfo{AddressingModeType::Immediate, OperationType::ORA, true};  // ORA Immediate
+    table[0x05] = OpcodeInfo{AddressingModeType::ZeroPage, OperationType::ORA, true};  // ORA ZeroPage
+    table[0x01] = OpcodeInfo{AddressingModeType::IndexedIndirectX, OperationType::ORA, true};  // ORA (Indirect,X)
+    table[0x0D] = OpcodeInfo{AddressingModeType::Absolute, OperationType::ORA, true};  // ORA Absolute
+    table[0x15] = OpcodeInfo{AddressingModeType::ZeroPageX, OperationType::ORA, true};  // ORA ZeroPage,X
+    table[0x11] = OpcodeInfo{AddressingModeType::IndirectIndexedY, OperationType::ORA, true};  // ORA (Indirect),Y
+    table[0x1D] = OpcodeInfo{AddressingModeType::AbsoluteX, OperationType::ORA, true};  // ORA Absolute,X
+    table[0x19] = OpcodeInfo{AddressingModeType::AbsoluteY, OperationType::ORA, true};  // ORA Absolute,Y
+
+    // BIT - Bit Test
+    table[0x24] = OpcodeInfo{AddressingModeType::ZeroPage, OperationType::BIT, true};  // BIT ZeroPage
+    table[0x2C] = OpcodeInfo{AddressingModeType::Absolute, OperationType::BIT, true};  // BIT Absolute
+
+    // Arithmetic Operations
+    // ADC - Add with Carry
+    table[0x69] = OpcodeInfo{AddressingModeType::Immediate, OperationType::ADC, true};  // ADC Immediate
+    table[0x65] = OpcodeInfo{AddressingModeType::ZeroPage, OperationType::ADC, true};  // ADC ZeroPage
+    table[0x75] = OpcodeInfo{AddressingModeType::ZeroPageX, OperationType::ADC, true};  // ADC ZeroPage,X
+    table[0x6D] = OpcodeInfo{AddressingModeType::Absolute, OperationType::ADC, true};  // ADC Absolute
+    table[0x7D] = OpcodeInfo{AddressingModeType::AbsoluteX, OperationType::ADC, true};  // ADC Absolute,X
+    table[0x79] = OpcodeInfo{AddressingModeType::AbsoluteY, OperationType::ADC, true};  // ADC Absolute,Y
+    table[0x61] = OpcodeInfo{AddressingModeType::IndexedIndirectX, OperationType::ADC, true};  // ADC (Indirect,X)
+    table[0x71] = OpcodeInfo{AddressingModeType::IndirectIndexedY, OperationType::ADC, true};  // ADC (Indirect),Y
+
+    // SBC - Subtract with Carry
+    table[0xE9] = OpcodeInfo{AddressingModeType::Immediate, OperationType::SBC, true};  // SBC Immediate
+    table[0xE5] = OpcodeInfo{AddressingModeType::ZeroPage, OperationType::SBC, true};  // SBC ZeroPage
+    table[0xF5] = OpcodeInfo{AddressingModeType::ZeroPageX, OperationType::SBC, true};  // SBC ZeroPage,X
+    table[0xED] = OpcodeInfo{AddressingModeType::Absolute, OperationType::SBC, true};  // SBC Absolute
+    table[0xFD] = OpcodeInfo{AddressingModeType::AbsoluteX, OperationType::SBC, true};  // SBC Absolute,X
+    table[0xF9] = OpcodeInfo{AddressingModeType::AbsoluteY, OperationType::SBC, true};  // SBC Absolute,Y
+    table[0xE1] = OpcodeInfo{AddressingModeType::IndexedIndirectX, OperationType::SBC, true};  // SBC (Indirect,X)
+    table[0xF1] = OpcodeInfo{AddressingModeType::IndirectIndexedY, OperationType::SBC, true};  // SBC (Indirect),Y
+
+    // CMP - Compare Accumulator
+    table[0xC9] = OpcodeInfo{AddressingModeType::Immediate, OperationType::CMP, true};  // CMP Immediate
+    table[0xC5] = OpcodeInfo{AddressingModeType::ZeroPage, OperationType::CMP, true};  // CMP ZeroPage
+    table[0xD5] = OpcodeInfo{AddressingModeType::ZeroPageX, OperationType::CMP, true};  // CMP ZeroPage,X
+    table[0xCD] = OpcodeInfo{AddressingModeType::Absolute, OperationType::CMP, true};  // CMP Absolute
+    table[0xDD] = OpcodeInfo{AddressingModeType::AbsoluteX, OperationType::CMP, true};  // CMP Absolute,X
+    table[0xD9] = OpcodeInfo{AddressingModeType::AbsoluteY, OperationType::CMP, true};  // CMP Absolute,Y
+    table[0xC1] = OpcodeInfo{AddressingModeType::IndexedIndirectX, OperationType::CMP, true};  // CMP (Indirect,X)
+    table[0xD1] = OpcodeInfo{AddressingModeType::IndirectIndexedY, OperationType::CMP, true};  // CMP (Indirect),Y
+
+    // CPX - Compare X Register
+    table[0xE0] = OpcodeInfo{AddressingModeType::Immediate, OperationType::CPX, true};  // CPX Immediate
+    table[0xE4] = OpcodeInfo{AddressingModeType::ZeroPage, OperationType::CPX, true};  // CPX ZeroPage
+    table[0xEC] = OpcodeInfo{AddressingModeType::Absolute, OperationType::CPX, true};  // CPX Absolute
+
+    // CPY - Compare Y Register
+    table[0xC0] = OpcodeInfo{AddressingModeType::Immediate, OperationType::CPY, true};  // CPY Immediate
+    table[0xC4] = OpcodeInfo{AddressingModeType::ZeroPage, OperationType::CPY, true};  // CPY ZeroPage
+    table[0xCC] = OpcodeInfo{AddressingModeType::Absolute, OperationType::CPY, true};  // CPY Absolute
+
+    // Increment and Decrement Operations
+    // INC - Increment a memory location
+    table[0xE6] = OpcodeInfo{AddressingModeType::ZeroPage, OperationType::INC, true};  // INC ZeroPage
+    table[0xF6] = OpcodeInfo{AddressingModeType::ZeroPageX, OperationType::INC, true};  // INC ZeroPage,X
+    table[0xEE] = OpcodeInfo{AddressingModeType::Absolute, OperationType::INC, true};  // INC Absolute
+    table[0xFE] = OpcodeInfo{AddressingModeType::AbsoluteX, OperationType::INC, true};  // INC Absolute,X
+
+    // INX - Increment the X register
+    table[0xE8] = OpcodeInfo{AddressingModeType::Implied, OperationType::INX, true};  // INX
+
+    // INY - Increment the Y register
+    table[0xC8] = OpcodeInfo{AddressingModeType::Implied, OperationType::INY, true};  // INY
+
+    // DEC - Decrement a memory location
+    table[0xC6] = OpcodeInfo{AddressingModeType::ZeroPage, OperationType::DEC, true};  // DEC ZeroPage
+    table[0xD6] = OpcodeInfo{AddressingModeType::ZeroPageX, OperationType::DEC, true};  // DEC ZeroPage,X
+    table[0xCE] = OpcodeInfo{AddressingModeType::Absolute, OperationType::DEC, true};  // DEC Absolute
+    table[0xDE] = OpcodeInfo{AddressingModeType::AbsoluteX, OperationType::DEC, true};  // DEC Absolute,X
+
+    // DEX - Decrement the X register
+    table[0xCA] = OpcodeInfo{AddressingModeType::Implied, OperationType::DEX, true};  // DEX
+
+    // DEY - Decrement the Y register
+    table[0x88] = OpcodeInfo{AddressingModeType::Implied, OperationType::DEY, true};  // DEY
+
+    // Shift and Rotate Operations
+    // ASL - Arithmetic Shift Left
+    table[0x0A] = OpcodeInfo{AddressingModeType::Accumulator, OperationType::ASL, true};  // ASL Accumulator
+    table[0x06] = OpcodeInfo{AddressingModeType::ZeroPage, OperationType::ASL, true};  // ASL ZeroPage
+    table[0x16] = OpcodeInfo{AddressingModeType::ZeroPageX, OperationType::ASL, true};  // ASL ZeroPage,X
+    table[0x0E] = OpcodeInfo{AddressingModeType::Absolute, OperationType::ASL, true};  // ASL Absolute
+    table[0x1E] = OpcodeInfo{AddressingModeType::AbsoluteX, OperationType::ASL, true};  // ASL Absolute,X
+
+    // LSR - Logical Shift Right
+    table[0x4A] = OpcodeInfo{AddressingModeType::Accumulator, OperationType::LSR, true};  // LSR Accumulator
+    table[0x46] = OpcodeInfo{AddressingModeType::ZeroPage, OperationType::LSR, true};  // LSR ZeroPage
+    table[0x56] = OpcodeInfo{AddressingModeType::ZeroPageX, OperationType::LSR, true};  // LSR ZeroPage,X
+    table[0x4E] = OpcodeInfo{AddressingModeType::Absolute, OperationType::LSR, true};  // LSR Absolute
+    table[0x5E] = OpcodeInfo{AddressingModeType::AbsoluteX, OperationType::LSR, true};  // LSR Absolute,X
+
+    // ROL - Rotate Left
+    table[0x2A] = OpcodeInfo{AddressingModeType::Accumulator, OperationType::ROL, true};  // ROL Accumulator
+    table[0x26] = OpcodeInfo{AddressingModeType::ZeroPage, OperationType::ROL, true};  // ROL ZeroPage
+    table[0x36] = OpcodeInfo{AddressingModeType::ZeroPageX, OperationType::ROL, true};  // ROL ZeroPage,X
+    table[0x2E] = OpcodeInfo{AddressingModeType::Absolute, OperationType::ROL, true};  // ROL Absolute
+    table[0x3E] = OpcodeInfo{AddressingModeType::AbsoluteX, OperationType::ROL, true};  // ROL Absolute,X
+
+    // ROR - Rotate Right
+    table[0x6A] = OpcodeInfo{AddressingModeType::Accumulator, OperationType::ROR, true};  // ROR Accumulator
+    table[0x66] = OpcodeInfo{AddressingModeType::ZeroPage, OperationType::ROR, true};  // ROR ZeroPage
+    table[0x76] = OpcodeInfo{AddressingModeType::ZeroPageX, OperationType::ROR, true};  // ROR ZeroPage,X
+    table[0x6E] = OpcodeInfo{AddressingModeType::Absolute, OperationType::ROR, true};  // ROR Absolute
+    table[0x7E] = OpcodeInfo{AddressingModeType::AbsoluteX, OperationType::ROR, true};  // ROR Absolute,X
+
+    // Jump and Subroutine Operations
+    // JMP - Jump to another location
+    table[0x4C] = OpcodeInfo{AddressingModeType::Absolute, OperationType::JMP, true};  // JMP Absolute
+    table[0x6C] = OpcodeInfo{AddressingModeType::Indirect, OperationType::JMP, true};  // JMP Indirect
+
+    // JSR - Jump to a subroutine
+    table[0x20] = OpcodeInfo{AddressingModeType::Absolute, OperationType::JSR, true};  // JSR Absolute
+
+    // RTS - Return from subroutine
+    table[0x60] = OpcodeInfo{AddressingModeType::Implied, OperationType::RTS, true};  // RTS
+
+    // Branches
+    table[0x90] = OpcodeInfo{AddressingModeType::Relative, OperationType::BCC, true};  // BCC - Branch if carry flag clear
+    table[0xB0] = OpcodeInfo{AddressingModeType::Relative, OperationType::BCS, true};  // BCS - Branch if carry flag set
+    table[0xF0] = OpcodeInfo{AddressingModeType::Relative, OperationType::BEQ, true};  // BEQ - Branch if zero flag set
+    table[0x30] = OpcodeInfo{AddressingModeType::Relative, OperationType::BMI, true};  // BMI - Branch if negative flag set
+    table[0xD0] = OpcodeInfo{AddressingModeType::Relative, OperationType::BNE, true};  // BNE - Branch if zero flag clear
+    table[0x10] = OpcodeInfo{AddressingModeType::Relative, OperationType::BPL, true};  // BPL - Branch if negative flag clear
+    table[0x50] = OpcodeInfo{AddressingModeType::Relative, OperationType::BVC, true};  // BVC - Branch if overflow flag clear
+    table[0x70] = OpcodeInfo{AddressingModeType::Relative, OperationType::BVS, true};  // BVS - Branch if overflow flag set
+
+    // Status Flag Changes
+    table[0x18] = OpcodeInfo{AddressingModeType::Implied, OperationType::CLC, true};  // CLC - Clear carry flag
+    table[0xD8] = OpcodeInfo{AddressingModeType::Implied, OperationType::CLD, true};  // CLD - Clear decimal mode flag
+    table[0x58] = OpcodeInfo{AddressingModeType::Implied, OperationType::CLI, true};  // CLI - Clear interrupt disable flag
+    table[0xB8] = OpcodeInfo{AddressingModeType::Implied, OperationType::CLV, true};  // CLV - Clear overflow flag
+    table[0x38] = OpcodeInfo{AddressingModeType::Implied, OperationType::SEC, true};  // SEC - Set carry flag
+    table[0xF8] = OpcodeInfo{AddressingModeType::Implied, OperationType::SED, true};  // SED - Set decimal mode flag
+    table[0x78] = OpcodeInfo{AddressingModeType::Implied, OperationType::SEI, true};  // SEI - Set interrupt disable flag
+
+    // System Functions
+    table[0x00] = OpcodeInfo{AddressingModeType::Implied, OperationType::BRK, true};  // BRK - Force an interrupt
+    table[0xEA] = OpcodeInfo{AddressingModeType::Implied, OperationType::NOP, true};  // NOP - No operation
+    table[0x40] = OpcodeInfo{AddressingModeType::Implied, OperationType::RTI, true};  // RTI - Return from interrupt
+
+    if constexpr (Variant::cmosInstructions) {
+        // 65C02 additions, all in slots the NMOS map leaves invalid
+        table[0x80] = OpcodeInfo{AddressingModeType::Relative, OperationType::BRA, true};  // BRA - Branch always
+
+        table[0x64] = OpcodeInfo{AddressingModeType::ZeroPage, OperationType::STZ, true};  // STZ ZeroPage
+        table[0x74] = OpcodeInfo{AddressingModeType::ZeroPageX, OperationType::STZ, true};  // STZ ZeroPage,X
+        table[0x9C] = OpcodeInfo{AddressingModeType::Absolute, OperationType::STZ, true};  // STZ Absolute
+        table[0x9E] = OpcodeInfo{AddressingModeType::AbsoluteX, OperationType::STZ, true};  // STZ Absolute,X
+
+        table[0xDA] = OpcodeInfo{AddressingModeType::Implied, OperationType::PHX, true};  // PHX
+        table[0x5A] = OpcodeInfo{AddressingModeType::Implied, OperationType::PHY, true};  // PHY
+        table[0xFA] = OpcodeInfo{AddressingModeType::Implied, OperationType::PLX, true};  // PLX
+        table[0x7A] = OpcodeInfo{AddressingModeType::Implied, OperationType::PLY, true};  // PLY
+
+        table[0x14] = OpcodeInfo{AddressingModeType::ZeroPage, OperationType::TRB, true};  // TRB ZeroPage
+        table[0x1C] = OpcodeInfo{AddressingModeType::Absolute, OperationType::TRB, true};  // TRB Absolute
+        table[0x04] = OpcodeInfo{AddressingModeType::ZeroPage, OperationType::TSB, true};  // TSB ZeroPage
+        table[0x0C] = OpcodeInfo{AddressingModeType::Absolute, OperationType::TSB, true};  // TSB Absolute
+
+        table[0x12] = OpcodeInfo{AddressingModeType::ZeroPageIndirect, OperationType::ORA, true};  // ORA (ZeroPage)
+        table[0x32] = OpcodeInfo{AddressingModeType::ZeroPageIndirect, OperationType::AND, true};  // AND (ZeroPage)
+        table[0x52] = OpcodeInfo{AddressingModeType::ZeroPageIndirect, OperationType::EOR, true};  // EOR (ZeroPage)
+        table[0x72] = OpcodeInfo{AddressingModeType::ZeroPageIndirect, OperationType::ADC, true};  // ADC (ZeroPage)
+        table[0x92] = OpcodeInfo{AddressingModeType::ZeroPageIndirect, OperationType::STA, true};  // STA (ZeroPage)
+        table[0xB2] = OpcodeInfo{AddressingModeType::ZeroPageIndirect, OperationType::LDA, true};  // LDA (ZeroPage)
+        table[0xD2] = OpcodeInfo{AddressingModeType::ZeroPageIndirect, OperationType::CMP, true};  // CMP (ZeroPage)
+        table[0xF2] = OpcodeInfo{AddressingModeType::ZeroPageIndirect, OperationType::SBC, true};  // SBC (ZeroPage)
+
+        table[0x6C] = OpcodeInfo{AddressingModeType::IndirectNoWrap, OperationType::JMP, true};  // JMP Indirect, without the page wrap
+    }
+
+    return table;
+}
+
+template <typename Variant>
+inline constexpr std::array<OpcodeInfo, 256> variantOpcodeTable = buildOpcodeTable<Variant>();
+
+// The NMOS map. The threaded core, the block cache and the JIT only
+// implement this one; see CPU::setExecutionEngine().
+inline constexpr const std::array<OpcodeInfo, 256>& opcodeTable = variantOpcodeTable<NMOS6502>;
+
+// Cycles an instruction takes before page-crossing and branch penalties.
+// Invalid opcodes are skipped as one-byte, two-cycle NOPs.
+constexpr uint8_t baseCycles(const OpcodeInfo& info) {
+    if (!info.valid) {
+        return 2;
+    }
+    switch (info.operation) {
+        case OperationType::BRK:
+            return 7;
+        case OperationType::JSR: case OperationType::RTS: case OperationType::RTI:
+            return 6;
+        case OperationType::PHA: case OperationType::PHP:
+        case OperationType::PHX: case OperationType::PHY:
+            return 3;
+        case OperationType::PLA: case OperationType::PLP:
+        case OperationType::PLX: case OperationType::PLY:
+            return 4;
+        case OperationType::JMP:
+            switch (info.addressingMode) {
+                case AddressingModeType::Indirect: return 5;
+                case AddressingModeType::IndirectNoWrap: return 6;
+                default: return 3;
+            }
+        default:
+            break;
+    }
+
+    bool store = info.operation == OperationType::STA || info.operation == OperationType::STX ||
+                 info.operation == OperationType::STY || info.operation == OperationType::STZ;
+    bool readModifyWrite = writesMemory(info) && !store;
+    switch (info.addressingMode) {
+        case AddressingModeType::ZeroPage:
+            return readModifyWrite ? 5 : 3;
+        case AddressingModeType::ZeroPageX:
+        case AddressingModeType::ZeroPageY:
+        case AddressingModeType::Absolute:
+            return readModifyWrite ? 6 : 4;
+        case AddressingModeType::AbsoluteX:
+        case AddressingModeType::AbsoluteY:
+            return readModifyWrite ? 7 : store ? 5 : 4;
+        case AddressingModeType::Indirect:
+        case AddressingModeType::ZeroPageIndirect:
+            return 5;
+        case AddressingModeType::IndexedIndirectX:
+            return 6;
+        case AddressingModeType::IndirectIndexedY:
+            return store ? 6 : 5;
+        default:
+            return 2;
+    }
+}
+
+// Indexed reads take a cycle more when the index carries into the high
+// byte of the address. Stores and read-modify-write always take it.
+constexpr bool hasPageCrossPenalty(const OpcodeInfo& info) {
+    switch (info.addressingMode) {
+        case AddressingModeType::AbsoluteX:
+        case AddressingModeType::AbsoluteY:
+        case AddressingModeType::IndirectIndexedY:
+            return info.valid && !writesMemory(info);
+        default:
+            return false;
+    }
+}
+
+// Timing beyond the 65C02's new instructions and its JMP (abs) is the NMOS
+// timing for every variant.
+template <typename Variant>
+constexpr std::array<uint8_t, 256> buildCycleTable() {
+    std::array<uint8_t, 256> table{};
+    for (int opcode = 0; opcode < 256; opcode++) {
+        table[opcode] = baseCycles(variantOpcodeTable<Variant>[opcode]);
+    }
+    return table;
+}
+
+template <typename Variant>
+inline constexpr std::array<uint8_t, 256> variantCycleTable = buildCycleTable<Variant>();
+
+inline constexpr const std::array<uint8_t, 256>& cycleTable = variantCycleTable<NMOS6502>;
+
+#endif
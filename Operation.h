@@ -23,36 +23,42 @@ class LDAOperation : public Operation {
 public:
     LDAOperation() { mnemonic = "LDA"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 class LDXOperation : public Operation {
 public:
     LDXOperation() { mnemonic = "LDX"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 class LDYOperation : public Operation {
 public:
     LDYOperation() { mnemonic = "LDY"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 class STAOperation : public Operation {
 public:
     STAOperation() { mnemonic = "STA"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 class STXOperation : public Operation {
 public:
     STXOperation() { mnemonic = "STX"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 class STYOperation : public Operation {
 public:
     STYOperation() { mnemonic = "STY"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 // Arithmetic Operations
@@ -60,30 +66,35 @@ class ADCOperation : public Operation {
 public:
     ADCOperation() { mnemonic = "ADC"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 class SBCOperation : public Operation {
 public:
     SBCOperation() { mnemonic = "SBC"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 class CMPOperation : public Operation {
 public:
     CMPOperation() { mnemonic = "CMP"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 class CPXOperation : public Operation {
 public:
     CPXOperation() { mnemonic = "CPX"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 class CPYOperation : public Operation {
 public:
     CPYOperation() { mnemonic = "CPY"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 // Logical Operations
@@ -91,24 +102,28 @@ class ANDOperation : public Operation {
 public:
     ANDOperation() { mnemonic = "AND"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 class ORAOperation : public Operation {
 public:
     ORAOperation() { mnemonic = "ORA"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 class EOROperation : public Operation {
 public:
     EOROperation() { mnemonic = "EOR"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 class BITOperation : public Operation {
 public:
     BITOperation() { mnemonic = "BIT"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 
@@ -117,36 +132,42 @@ class INCOperation : public Operation {
 public:
     INCOperation() { mnemonic = "INC"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 class DECOperation : public Operation {
 public:
     DECOperation() { mnemonic = "DEC"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 class INXOperation : public Operation {
 public:
     INXOperation() { mnemonic = "INX"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 class INYOperation : public Operation {
 public:
     INYOperation() { mnemonic = "INY"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 class DEXOperation : public Operation {
 public:
     DEXOperation() { mnemonic = "DEX"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 class DEYOperation : public Operation {
 public:
     DEYOperation() { mnemonic = "DEY"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 // Arithmetic Shift and Rotate Operations
@@ -154,28 +175,36 @@ class ASLOperation : public AccumulatorOperation {
 public:
     ASLOperation() { mnemonic = "ASL"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
     void operator()(CPU& cpu) const override;
+    static void applyAccumulator(CPU& cpu);
 };
 
 class LSROperation : public AccumulatorOperation {
 public:
     LSROperation() { mnemonic = "LSR"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
     void operator()(CPU& cpu) const override;
+    static void applyAccumulator(CPU& cpu);
 };
 
 class ROROperation : public AccumulatorOperation {
 public:
     ROROperation() { mnemonic = "ROR"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
     void operator()(CPU& cpu) const override;
+    static void applyAccumulator(CPU& cpu);
 };
 
 class ROLOperation : public AccumulatorOperation {
 public:
     ROLOperation() { mnemonic = "ROL"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
     void operator()(CPU& cpu) const override;
+    static void applyAccumulator(CPU& cpu);
 };
 
 // Branching Operations
@@ -183,48 +212,56 @@ class BCCOperation : public Operation {
 public:
     BCCOperation() { mnemonic = "BCC"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 class BCSOperation : public Operation {
 public:
     BCSOperation() { mnemonic = "BCS"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 class BEQOperation : public Operation {
 public:
     BEQOperation() { mnemonic = "BEQ"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 class BNEOperation : public Operation {
 public:
     BNEOperation() { mnemonic = "BNE"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 class BMIOperation : public Operation {
 public:
     BMIOperation() { mnemonic = "BMI"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 class BPLOperation : public Operation {
 public:
     BPLOperation() { mnemonic = "BPL"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 class BVCOperation : public Operation {
 public:
     BVCOperation() { mnemonic = "BVC"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 class BVSOperation : public Operation {
 public:
     BVSOperation() { mnemonic = "BVS"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 // Status Flag Operations
@@ -232,42 +269,49 @@ class CLCOperation : public Operation {
 public:
     CLCOperation() { mnemonic = "CLC"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 class SECOperation : public Operation {
 public:
     SECOperation() { mnemonic = "SEC"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 class CLDOperation : public Operation {
 public:
     CLDOperation() { mnemonic = "CLD"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 class SEDOperation : public Operation {
 public:
     SEDOperation() { mnemonic = "SED"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 class CLIOperation : public Operation {
 public:
     CLIOperation() { mnemonic = "CLI"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 class SEIOperation : public Operation {
 public:
     SEIOperation() { mnemonic = "SEI"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 class CLVOperation : public Operation {
 public:
     CLVOperation() { mnemonic = "CLV"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 // Jumps & Calls
@@ -275,18 +319,21 @@ class JMPOperation : public Operation {
 public:
     JMPOperation() { mnemonic = "JMP"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 class JSROperation : public Operation {
 public:
     JSROperation() { mnemonic = "JSR"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 class RTSOperation : public Operation {
 public:
     RTSOperation() { mnemonic = "RTS"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 // No Operation and Break
@@ -294,18 +341,21 @@ class NOPOperation : public Operation {
 public:
     NOPOperation() { mnemonic = "NOP"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 class BRKOperation : public Operation {
 public:
     BRKOperation() { mnemonic = "BRK"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 class RTIOperation : public Operation {
 public:
     RTIOperation() { mnemonic = "RTI"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 // Transfer Operations
@@ -313,24 +363,28 @@ class TAXOperation : public Operation {
 public:
     TAXOperation() { mnemonic = "TAX"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 class TAYOperation : public Operation {
 public:
     TAYOperation() { mnemonic = "TAY"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 class TXAOperation : public Operation {
 public:
     TXAOperation() { mnemonic = "TXA"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 class TYAOperation : public Operation {
 public:
     TYAOperation() { mnemonic = "TYA"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 // Stack Operations
@@ -338,36 +392,99 @@ class TXSOperation : public Operation {
 public:
     TXSOperation() { mnemonic = "TXS"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 class TSXOperation : public Operation {
 public:
     TSXOperation() { mnemonic = "TSX"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 class PHAOperation : public Operation {
 public:
     PHAOperation() { mnemonic = "PHA"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 class PHPOperation : public Operation {
 public:
     PHPOperation() { mnemonic = "PHP"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 class PLAOperation : public Operation {
 public:
     PLAOperation() { mnemonic = "PLA"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 class PLPOperation : public Operation {
 public:
     PLPOperation() { mnemonic = "PLP"; }
     void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
+};
+
+// 65C02 Operations
+class BRAOperation : public Operation {
+public:
+    BRAOperation() { mnemonic = "BRA"; }
+    void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
+};
+
+class STZOperation : public Operation {
+public:
+    STZOperation() { mnemonic = "STZ"; }
+    void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
+};
+
+class PHXOperation : public Operation {
+public:
+    PHXOperation() { mnemonic = "PHX"; }
+    void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
+};
+
+class PHYOperation : public Operation {
+public:
+    PHYOperation() { mnemonic = "PHY"; }
+    void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
+};
+
+class PLXOperation : public Operation {
+public:
+    PLXOperation() { mnemonic = "PLX"; }
+    void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
+};
+
+class PLYOperation : public Operation {
+public:
+    PLYOperation() { mnemonic = "PLY"; }
+    void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
+};
+
+class TRBOperation : public Operation {
+public:
+    TRBOperation() { mnemonic = "TRB"; }
+    void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
+};
+
+class TSBOperation : public Operation {
+public:
+    TSBOperation() { mnemonic = "TSB"; }
+    void operator()(CPU& cpu, uint16_t effectiveAddress) const override;
+    static void apply(CPU& cpu, uint16_t effectiveAddress);
 };
 
 #endif
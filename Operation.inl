@@ -0,0 +1,415 @@
+#ifndef OPERATION_INL
+#define OPERATION_INL
+
+// Operation logic shared by the virtual classes and the fused handlers.
+// Include only where CPU is a complete type.
+
+#include "Operation.h"
+#include "CPU.h"
+
+inline void LDAOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    uint8_t value = cpu.read(effectiveAddress);
+    cpu.setAccumulator(value);
+    cpu.setNZ(value);
+}
+
+inline void LDXOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    uint8_t value = cpu.read(effectiveAddress);
+    cpu.setX(value);
+    cpu.setNZ(value);
+}
+
+inline void LDYOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    uint8_t value = cpu.read(effectiveAddress);
+    cpu.setY(value);
+    cpu.setNZ(value);
+}
+
+inline void STAOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    cpu.write(effectiveAddress, cpu.getAccumulator());
+}
+
+inline void STXOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    cpu.write(effectiveAddress, cpu.getX());
+}
+
+inline void STYOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    cpu.write(effectiveAddress, cpu.getY());
+}
+
+inline void ANDOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    uint8_t value = cpu.read(effectiveAddress);
+    uint8_t result = cpu.getAccumulator() & value;
+    cpu.setAccumulator(result);
+    cpu.setNZ(result);
+}
+
+inline void ORAOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    uint8_t value = cpu.read(effectiveAddress);
+    uint8_t result = cpu.getAccumulator() | value;
+    cpu.setAccumulator(result);
+    cpu.setNZ(result);
+}
+
+inline void EOROperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    uint8_t value = cpu.read(effectiveAddress);
+    uint8_t result = cpu.getAccumulator() ^ value;
+    cpu.setAccumulator(result);
+    cpu.setNZ(result);
+}
+
+inline void BITOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    uint8_t value = cpu.read(effectiveAddress);
+    cpu.setZeroFlag((cpu.getAccumulator() & value) == 0);
+    cpu.setNegativeFlag(value & 0x80);
+    cpu.setOverflowFlag(value & 0x40);
+}
+
+inline void ADCOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    uint8_t value = cpu.read(effectiveAddress);
+    cpu.setAluResult(cpu.getAluTables().adc[cpu.getDecimalFlag()][aluIndex(cpu.getCarryFlag(), cpu.getAccumulator(), value)]);
+}
+
+inline void SBCOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    uint8_t value = cpu.read(effectiveAddress);
+    cpu.setAluResult(cpu.getAluTables().sbc[cpu.getDecimalFlag()][aluIndex(cpu.getCarryFlag(), cpu.getAccumulator(), value)]);
+}
+
+inline void CMPOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    uint8_t value = cpu.read(effectiveAddress);
+    uint16_t result = cpu.getAccumulator() - value;
+    cpu.setCarryFlag(cpu.getAccumulator() >= value);  // Carry flag set if A >= Operand
+    cpu.setNZ(result & 0xFF);  // Zero and Negative flags from the low byte of A - Operand
+}
+
+inline void CPXOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    uint8_t value = cpu.read(effectiveAddress);
+    uint16_t result = cpu.getX() - value;
+    cpu.setCarryFlag(cpu.getX() >= value);  // Carry flag set if X >= Operand
+    cpu.setNZ(result & 0xFF);  // Zero and Negative flags from the low byte of X - Operand
+}
+
+inline void CPYOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    uint8_t value = cpu.read(effectiveAddress);
+    uint16_t result = cpu.getY() - value;
+    cpu.setCarryFlag(cpu.getY() >= value);  // Carry flag set if Y >= Operand
+    cpu.setNZ(result & 0xFF);  // Zero and Negative flags from the low byte of Y - Operand
+}
+
+inline void INCOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    uint8_t value = cpu.read(effectiveAddress) + 1;
+    cpu.write(effectiveAddress, value);
+    cpu.setNZ(value);
+}
+
+inline void DECOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    uint8_t value = cpu.read(effectiveAddress) - 1;
+    cpu.write(effectiveAddress, value);
+    cpu.setNZ(value);
+}
+
+inline void INXOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    uint8_t value = cpu.getX() + 1;
+    cpu.setX(value);
+    cpu.setNZ(value);
+}
+
+inline void INYOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    uint8_t value = cpu.getY() + 1;
+    cpu.setY(value);
+    cpu.setNZ(value);
+}
+
+inline void DEXOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    uint8_t value = cpu.getX() - 1;
+    cpu.setX(value);
+    cpu.setNZ(value);
+}
+
+inline void DEYOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    uint8_t value = cpu.getY() - 1;
+    cpu.setY(value);
+    cpu.setNZ(value);
+}
+
+inline void ASLOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    uint8_t value = cpu.read(effectiveAddress);
+    bool carry = (value >> 7) & 1;
+    uint8_t result = value << 1;
+    cpu.write(effectiveAddress, result);
+    cpu.setCarryFlag(carry);
+    cpu.setNZ(result);
+}
+
+inline void ASLOperation::applyAccumulator(CPU& cpu) {
+    uint8_t value = cpu.getAccumulator();
+    bool carry = (value >> 7) & 1;
+    uint8_t result = value << 1;
+    cpu.setAccumulator(result);
+    cpu.setCarryFlag(carry);
+    cpu.setNZ(result);
+}
+
+inline void LSROperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    uint8_t value = cpu.read(effectiveAddress);
+    bool carry = value & 1;
+    uint8_t result = value >> 1;
+    cpu.write(effectiveAddress, result);
+    cpu.setCarryFlag(carry);
+    cpu.setNZ(result);
+}
+
+inline void LSROperation::applyAccumulator(CPU& cpu) {
+    uint8_t value = cpu.getAccumulator();
+    bool carry = value & 1;
+    uint8_t result = value >> 1;
+    cpu.setAccumulator(result);
+    cpu.setCarryFlag(carry);
+    cpu.setNZ(result);
+}
+
+inline void ROROperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    uint8_t value = cpu.read(effectiveAddress);
+    bool carry = (value & 1);
+    uint8_t result = (cpu.getCarryFlag() << 7) | (value >> 1);
+    cpu.write(effectiveAddress, result);
+    cpu.setCarryFlag(carry);
+    cpu.setNZ(result);
+}
+
+inline void ROROperation::applyAccumulator(CPU& cpu) {
+    uint8_t value = cpu.getAccumulator();
+    bool carry = value & 1;
+    uint8_t result = (cpu.getCarryFlag() << 7) | (value >> 1);
+    cpu.setAccumulator(result);
+    cpu.setCarryFlag(carry);
+    cpu.setNZ(result);
+}
+
+inline void ROLOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    uint8_t value = cpu.read(effectiveAddress);
+    bool carry = (value >> 7) & 1;
+    uint8_t result = (value << 1) | (cpu.getCarryFlag());
+    cpu.write(effectiveAddress, result);
+    cpu.setCarryFlag(carry);
+    cpu.setNZ(result);
+}
+
+inline void ROLOperation::applyAccumulator(CPU& cpu) {
+    uint8_t value = cpu.getAccumulator();
+    bool carry = (value >> 7) & 1;
+    uint8_t result = (value << 1) | (cpu.getCarryFlag());
+    cpu.setAccumulator(result);
+    cpu.setCarryFlag(carry);
+    cpu.setNZ(result);
+}
+
+inline void BCCOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    if (!cpu.getCarryFlag()) {
+        cpu.takeBranch(effectiveAddress);
+    }
+}
+
+inline void BCSOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    if (cpu.getCarryFlag()) {
+        cpu.takeBranch(effectiveAddress);
+    }
+}
+
+inline void BEQOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    if (cpu.getZeroFlag()) {
+        cpu.takeBranch(effectiveAddress);
+    }
+}
+
+inline void BNEOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    if (!cpu.getZeroFlag()) {
+        cpu.takeBranch(effectiveAddress);
+    }
+}
+
+inline void BMIOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    if (cpu.getNegativeFlag()) {
+        cpu.takeBranch(effectiveAddress);
+    }
+}
+
+inline void BPLOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    if (!cpu.getNegativeFlag()) {
+        cpu.takeBranch(effectiveAddress);
+    }
+}
+
+inline void BVCOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    if (!cpu.getOverflowFlag()) {
+        cpu.takeBranch(effectiveAddress);
+    }
+}
+
+inline void BVSOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    if (cpu.getOverflowFlag()) {
+        cpu.takeBranch(effectiveAddress);
+    }
+}
+
+inline void JMPOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    cpu.setPC(effectiveAddress);
+}
+
+inline void JSROperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    auto PCValue = cpu.getPC()-1;
+    cpu.pushStack((PCValue >> 8) & 0xFF);
+    cpu.pushStack(PCValue & 0xFF);
+    cpu.setPC(effectiveAddress);
+}
+
+inline void RTSOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    uint8_t low = cpu.pullStack();
+    uint8_t high = cpu.pullStack();
+    auto PCValue = ((high << 8) | low) + 1;
+    cpu.setPC(PCValue);
+}
+
+inline void CLCOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    cpu.setCarryFlag(false);
+}
+
+inline void SECOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    cpu.setCarryFlag(true);
+}
+
+inline void CLDOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    cpu.setDecimalFlag(false);
+}
+
+inline void SEDOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    cpu.setDecimalFlag(true);
+}
+
+inline void CLIOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    cpu.setInterruptDisableFlag(false);
+}
+
+inline void SEIOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    cpu.setInterruptDisableFlag(true);
+}
+
+inline void CLVOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    cpu.setOverflowFlag(false);
+}
+
+inline void TAXOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    cpu.setX(cpu.getAccumulator());
+    cpu.setNZ(cpu.getX());
+}
+
+inline void TAYOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    cpu.setY(cpu.getAccumulator());
+    cpu.setNZ(cpu.getY());
+}
+
+inline void TXAOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    cpu.setAccumulator(cpu.getX());
+    cpu.setNZ(cpu.getAccumulator());
+}
+
+inline void TYAOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    cpu.setAccumulator(cpu.getY());
+    cpu.setNZ(cpu.getAccumulator());
+}
+
+inline void TXSOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    cpu.setSP(cpu.getX());
+}
+
+inline void TSXOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    cpu.setX(cpu.getSP());
+    cpu.setNZ(cpu.getX());
+}
+
+inline void PHAOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    cpu.pushStack(cpu.getAccumulator());
+}
+
+inline void PHPOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    cpu.setBreakFlag(true);
+    cpu.setUnusedFlag(true);
+    cpu.pushStack(cpu.getStatusRegister() );
+}
+
+inline void PLAOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    cpu.setAccumulator(cpu.pullStack());
+    cpu.setNZ(cpu.getAccumulator());
+}
+
+inline void PLPOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    cpu.setStatusRegister(cpu.pullStack());
+    cpu.setBreakFlag(false);
+    cpu.setUnusedFlag(false);
+}
+
+inline void BRKOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    auto PCValue = cpu.getPC() + 1;
+    cpu.pushStack((PCValue>> 8) & 0xFF);
+    cpu.pushStack(PCValue& 0xFF);
+    cpu.setBreakFlag(true);
+    cpu.setUnusedFlag(true);
+    cpu.pushStack(cpu.getStatusRegister());
+    cpu.setInterruptDisableFlag(true);
+    cpu.setPC(cpu.read(0xFFFE) | (cpu.read(0xFFFF) << 8));
+}
+
+inline void RTIOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    uint8_t status = cpu.pullStack();
+    cpu.setStatusRegister(status);
+    uint8_t low = cpu.pullStack();
+    uint8_t high = cpu.pullStack();
+    cpu.setPC((high << 8) | low);
+}
+
+inline void NOPOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    // No operation performed
+}
+
+// 65C02 Operations
+inline void BRAOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    cpu.takeBranch(effectiveAddress);
+}
+
+inline void STZOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    cpu.write(effectiveAddress, 0);
+}
+
+inline void PHXOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    cpu.pushStack(cpu.getX());
+}
+
+inline void PHYOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    cpu.pushStack(cpu.getY());
+}
+
+inline void PLXOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    cpu.setX(cpu.pullStack());
+    cpu.setNZ(cpu.getX());
+}
+
+inline void PLYOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    cpu.setY(cpu.pullStack());
+    cpu.setNZ(cpu.getY());
+}
+
+// TRB and TSB set Z like BIT, from A AND memory, then clear or set the
+// accumulator's bits in memory.
+inline void TRBOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    uint8_t value = cpu.read(effectiveAddress);
+    cpu.setZeroFlag((cpu.getAccumulator() & value) == 0);
+    cpu.write(effectiveAddress, value & ~cpu.getAccumulator());
+}
+
+inline void TSBOperation::apply(CPU& cpu, uint16_t effectiveAddress) {
+    uint8_t value = cpu.read(effectiveAddress);
+    cpu.setZeroFlag((cpu.getAccumulator() & value) == 0);
+    cpu.write(effectiveAddress, value | cpu.getAccumulator());
+}
+
+#endif
@@ -0,0 +1,538 @@
+#include "ProgramLoader.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const size_t CHUNK_SIZE = 1 << 16;
+const uint32_t ADDRESS_SPACE = 0x10000;
+// A HEX record holds up to 255 data bytes, an S-record 255 bytes in all.
+const size_t MAX_RECORD = 260;
+
+// Value of each character as a hex digit, -1 for the rest.
+struct HexDigits {
+    int8_t value[256];
+
+    HexDigits() {
+        std::memset(value, -1, sizeof(value));
+        for (int i = 0; i < 10; i++) {
+            value['0' + i] = i;
+        }
+        for (int i = 0; i < 6; i++) {
+            value['A' + i] = 10 + i;
+            value['a' + i] = 10 + i;
+        }
+    }
+};
+
+const HexDigits hexDigits;
+
+bool isHex(char c) {
+    return hexDigits.value[static_cast<uint8_t>(c)] >= 0;
+}
+
+// Decodes count bytes from 2 * count hex digits.
+bool decodeHex(const char* text, size_t count, uint8_t* out) {
+    for (size_t i = 0; i < count; i++) {
+        int high = hexDigits.value[static_cast<uint8_t>(text[2 * i])];
+        int low = hexDigits.value[static_cast<uint8_t>(text[2 * i + 1])];
+        if ((high | low) < 0) {
+            return false;
+        }
+        out[i] = static_cast<uint8_t>(high << 4 | low);
+    }
+    return true;
+}
+
+uint32_t bigEndian(const uint8_t* bytes, size_t count) {
+    uint32_t value = 0;
+    for (size_t i = 0; i < count; i++) {
+        value = value << 8 | bytes[i];
+    }
+    return value;
+}
+
+uint16_t littleEndian(const uint8_t* bytes) {
+    return bytes[0] | (bytes[1] << 8);
+}
+
+bool hasExtension(const std::string& path, const char* extension) {
+    size_t length = std::strlen(extension);
+    if (path.size() < length) {
+        return false;
+    }
+    for (size_t i = 0; i < length; i++) {
+        if (std::tolower(static_cast<unsigned char>(path[path.size() - length + i])) != extension[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+const char* programFormatName(ProgramFormat format) {
+    switch (format) {
+        case ProgramFormat::Raw: return "raw";
+        case ProgramFormat::IntelHex: return "Intel HEX";
+        case ProgramFormat::SRecord: return "S-record";
+        case ProgramFormat::Prg: return "PRG";
+        case ProgramFormat::O65: return "o65";
+    }
+    return "unknown";
+}
+
+bool parseProgramFormat(const char* name, ProgramFormat& format) {
+    static const struct {
+        const char* name;
+        ProgramFormat format;
+    } names[] = {
+        {"raw", ProgramFormat::Raw},
+        {"hex", ProgramFormat::IntelHex},
+        {"srec", ProgramFormat::SRecord},
+        {"prg", ProgramFormat::Prg},
+        {"o65", ProgramFormat::O65},
+    };
+    for (const auto& entry : names) {
+        if (std::strcmp(name, entry.name) == 0) {
+            format = entry.format;
+            return true;
+        }
+    }
+    return false;
+}
+
+// A raw image could start with a colon or an S too, so the text formats
+// need a full record prefix of hex digits to be recognised.
+ProgramFormat detectProgramFormat(const std::string& path, const uint8_t* head, size_t length) {
+    static const uint8_t o65Magic[] = {0x01, 0x00, 'o', '6', '5'};
+    auto hexRun = [&](size_t from, size_t to) {
+        return length >= to && std::all_of(head + from, head + to, [](uint8_t c) { return isHex(c); });
+    };
+    if (length >= sizeof(o65Magic) && std::memcmp(head, o65Magic, sizeof(o65Magic)) == 0) {
+        return ProgramFormat::O65;
+    }
+    if (length > 0 && head[0] == ':' && hexRun(1, 9)) {
+        return ProgramFormat::IntelHex;
+    }
+    if (length > 1 && head[0] == 'S' && head[1] >= '0' && head[1] <= '9' && hexRun(2, 8)) {
+        return ProgramFormat::SRecord;
+    }
+    if (hasExtension(path, ".prg")) {
+        return ProgramFormat::Prg;
+    }
+    return ProgramFormat::Raw;
+}
+
+void printLoadedProgram(std::ostream& out, const std::string& path, const LoadedProgram& program) {
+    out << path << ": " << programFormatName(program.format) << ", " << std::dec << program.bytes << " bytes in "
+        << program.segments << " segments in " << program.milliseconds << " ms";
+    if (program.hasEntry) {
+        out << ", entry $" << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << program.entry
+            << std::dec << std::nouppercase << std::setfill(' ');
+    }
+    out << std::endl;
+}
+
+ProgramLoader::ProgramLoader(Memory& mem)
+    : memory(mem), segment(new uint8_t[ADDRESS_SPACE]), segmentStart(0), segmentLength(0), addressBase(0),
+      lineNumber(0), finished(false), relocating(false), relocationBase(0), program{} {}
+
+void ProgramLoader::relocateO65(uint16_t base) {
+    relocating = true;
+    relocationBase = base;
+}
+
+const LoadedProgram& ProgramLoader::getProgram() const {
+    return program;
+}
+
+const std::string& ProgramLoader::getError() const {
+    return error;
+}
+
+bool ProgramLoader::fail(const std::string& message) {
+    flush();
+    error = lineNumber ? "line " + std::to_string(lineNumber) + ": " + message : message;
+    return false;
+}
+
+void ProgramLoader::flush() {
+    if (segmentLength) {
+        memory.writeBlock(segmentStart, segment.get(), segmentLength);
+        program.bytes += segmentLength;
+        program.segments++;
+        segmentLength = 0;
+    }
+}
+
+bool ProgramLoader::append(uint32_t address, const uint8_t* data, size_t length) {
+    if (address + length > ADDRESS_SPACE) {
+        return fail("data runs past $FFFF");
+    }
+    if (!segmentLength || address != segmentStart + segmentLength) {
+        flush();
+        segmentStart = address;
+    }
+    std::memcpy(segment.get() + segmentLength, data, length);
+    segmentLength += length;
+    return true;
+}
+
+bool ProgramLoader::setEntry(uint32_t address) {
+    if (address >= ADDRESS_SPACE) {
+        return fail("start address past $FFFF");
+    }
+    program.hasEntry = true;
+    program.entry = static_cast<uint16_t>(address);
+    return true;
+}
+
+// Reads length bytes, or with toEnd whatever is left of the stream up to
+// length, straight into memory.
+bool ProgramLoader::readSegment(std::istream& in, uint32_t address, size_t length, bool toEnd) {
+    size_t space = ADDRESS_SPACE - address;
+    in.read(reinterpret_cast<char*>(&memory[address]), std::min(length, space));
+    size_t read = in.gcount();
+    if (read) {
+        program.bytes += read;
+        program.segments++;
+    }
+    if (!toEnd && read < length) {
+        return fail(read < space ? "file is truncated" : "segment runs past $FFFF");
+    }
+    return true;
+}
+
+bool ProgramLoader::load(const std::string& path, uint16_t rawAddress) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        error = "cannot open " + path;
+        return false;
+    }
+    uint8_t head[9];
+    file.read(reinterpret_cast<char*>(head), sizeof(head));
+    ProgramFormat format = detectProgramFormat(path, head, file.gcount());
+    file.clear();
+    file.seekg(0);
+    return load(file, format, rawAddress);
+}
+
+bool ProgramLoader::load(const std::string& path, ProgramFormat format, uint16_t rawAddress) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        error = "cannot open " + path;
+        return false;
+    }
+    return load(file, format, rawAddress);
+}
+
+bool ProgramLoader::load(std::istream& in, ProgramFormat format, uint16_t rawAddress) {
+    auto start = Clock::now();
+    program = LoadedProgram{format, 0, 0, false, 0, 0};
+    error.clear();
+    segmentLength = 0;
+    addressBase = 0;
+    lineNumber = 0;
+    finished = false;
+
+    bool ok = false;
+    switch (format) {
+        case ProgramFormat::Raw:
+            // Like Memory::loadProgram, an image too big for its address is
+            // cut off at the end of memory.
+            ok = readSegment(in, rawAddress, ADDRESS_SPACE - rawAddress, true);
+            break;
+        case ProgramFormat::IntelHex:
+            ok = loadText<&ProgramLoader::parseHexRecord>(in);
+            break;
+        case ProgramFormat::SRecord:
+            ok = loadText<&ProgramLoader::parseSRecord>(in);
+            break;
+        case ProgramFormat::Prg:
+            ok = loadPrg(in);
+            break;
+        case ProgramFormat::O65:
+            ok = loadO65(in);
+            break;
+    }
+    program.milliseconds = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    return ok;
+}
+
+// Splits the stream into lines without copying them, except for a line that
+// straddles two chunks. Blank lines are skipped, and so is anything after an
+// end record.
+template <bool (ProgramLoader::*ParseRecord)(const char*, size_t)>
+bool ProgramLoader::loadText(std::istream& in) {
+    std::unique_ptr<char[]> chunk(new char[CHUNK_SIZE]);
+    std::string carry;
+    auto line = [&](const char* text, size_t length) {
+        lineNumber++;
+        while (length && std::isspace(static_cast<unsigned char>(text[length - 1]))) {
+            length--;
+        }
+        return !length || finished || (this->*ParseRecord)(text, length);
+    };
+
+    while (in.read(chunk.get(), CHUNK_SIZE) || in.gcount()) {
+        const char* next = chunk.get();
+        const char* end = next + in.gcount();
+        while (next < end) {
+            const char* newline = static_cast<const char*>(std::memchr(next, '\n', end - next));
+            if (!newline) {
+                carry.append(next, end);
+                break;
+            }
+            bool ok;
+            if (carry.empty()) {
+                ok = line(next, newline - next);
+            } else {
+                carry.append(next, newline);
+                ok = line(carry.data(), carry.size());
+                carry.clear();
+            }
+            if (!ok) {
+                return false;
+            }
+            next = newline + 1;
+        }
+    }
+    if (!carry.empty() && !line(carry.data(), carry.size())) {
+        return false;
+    }
+    flush();
+    return true;
+}
+
+// :LLAAAATT, LL data bytes, then a checksum making the record sum to zero.
+bool ProgramLoader::parseHexRecord(const char* text, size_t length) {
+    uint8_t record[MAX_RECORD];
+    size_t count = (length - 1) / 2;
+    if (text[0] != ':' || length % 2 == 0 || count < 5 || count > MAX_RECORD ||
+        !decodeHex(text + 1, count, record) || record[0] != count - 5) {
+        return fail("malformed Intel HEX record");
+    }
+    uint8_t sum = 0;
+    for (size_t i = 0; i < count; i++) {
+        sum += record[i];
+    }
+    if (sum) {
+        return fail("Intel HEX checksum mismatch");
+    }
+
+    const uint8_t* data = record + 4;
+    size_t dataLength = record[0];
+    switch (record[3]) {
+        case 0x00:
+            return append(addressBase + bigEndian(record + 1, 2), data, dataLength);
+        case 0x01:
+            finished = true;
+            return true;
+        case 0x02:
+        case 0x04:
+            if (dataLength != 2) {
+                return fail("malformed extended address record");
+            }
+            addressBase = bigEndian(data, 2) << (record[3] == 0x02 ? 4 : 16);
+            return true;
+        case 0x03:
+            if (dataLength != 4) {
+                return fail("malformed start segment address record");
+            }
+            return setEntry((bigEndian(data, 2) << 4) + bigEndian(data + 2, 2));
+        case 0x05:
+            if (dataLength != 4) {
+                return fail("malformed start linear address record");
+            }
+            return setEntry(bigEndian(data, 4));
+    }
+    return fail("unknown Intel HEX record type");
+}
+
+// Sn, a count of the bytes that follow, an address of two to four bytes,
+// data, then a checksum: the ones' complement of the sum of the rest.
+bool ProgramLoader::parseSRecord(const char* text, size_t length) {
+    static const uint8_t addressBytes[10] = {2, 2, 3, 4, 0, 2, 3, 4, 3, 2};
+    uint8_t record[MAX_RECORD];
+    size_t count = (length - 2) / 2;
+    if (length < 4 || text[0] != 'S' || text[1] < '0' || text[1] > '9' || text[1] == '4' || length % 2 ||
+        count > MAX_RECORD || !decodeHex(text + 2, count, record) || record[0] != count - 1) {
+        return fail("malformed S-record");
+    }
+    int type = text[1] - '0';
+    size_t addressLength = addressBytes[type];
+    if (count < addressLength + 2) {
+        return fail("malformed S-record");
+    }
+    uint8_t sum = 0;
+    for (size_t i = 0; i < count; i++) {
+        sum += record[i];
+    }
+    if (sum != 0xFF) {
+        return fail("S-record checksum mismatch");
+    }
+
+    uint32_t address = bigEndian(record + 1, addressLength);
+    switch (type) {
+        case 1:
+        case 2:
+        case 3:
+            return append(address, record + 1 + addressLength, count - addressLength - 2);
+        case 7:
+        case 8:
+        case 9:
+            finished = true;
+            return setEntry(address);
+    }
+    // S0 headers and S5/S6 record counts.
+    return true;
+}
+
+// The image runs from the load address to the end of the file, and starts
+// there too; a program behind a BASIC stub needs its start given instead.
+bool ProgramLoader::loadPrg(std::istream& in) {
+    uint8_t header[2];
+    if (!in.read(reinterpret_cast<char*>(header), sizeof(header))) {
+        return fail("PRG file has no load address");
+    }
+    uint16_t address = littleEndian(header);
+    if (!readSegment(in, address, ADDRESS_SPACE - address, true)) {
+        return false;
+    }
+    if (in.peek() != std::char_traits<char>::eof()) {
+        return fail("PRG image runs past $FFFF");
+    }
+    return setEntry(address);
+}
+
+// One o65 relocation table, for the segment loaded at start. Each entry
+// is an offset from the last one, starting a byte before the segment, then
+// a byte with the type in its top bits and the segment the address refers
+// to in the bottom four; an offset of 255 only moves on by 254. A HIGH
+// entry is followed by the low byte of the address unless the file
+// relocates by whole pages. Addresses into the text, data and bss segments
+// move by delta, absolute and zero page ones stay.
+bool ProgramLoader::relocate(std::istream& in, uint16_t start, size_t length, int delta, bool pagewise) {
+    enum { SEGMENT_UNDEFINED = 0, SEGMENT_TEXT = 2, SEGMENT_BSS = 4, SEGMENT_ZERO = 5 };
+    enum { TYPE_LOW = 0x20, TYPE_HIGH = 0x40, TYPE_WORD = 0x80 };
+    const char* truncated = "o65 relocation table is truncated";
+    long position = -1;
+    for (int offset; (offset = in.get()) != 0;) {
+        if (offset == std::char_traits<char>::eof()) {
+            return fail(truncated);
+        }
+        position += offset == 255 ? 254 : offset;
+        if (offset == 255) {
+            continue;
+        }
+        int type = in.get();
+        if (type == std::char_traits<char>::eof()) {
+            return fail(truncated);
+        }
+        int target = type & 0x0F;
+        if (target == SEGMENT_UNDEFINED || target > SEGMENT_ZERO) {
+            return fail("o65 relocation refers to an undefined or unknown segment");
+        }
+        int change = target >= SEGMENT_TEXT && target <= SEGMENT_BSS ? delta : 0;
+        long size = (type & 0xE0) == TYPE_WORD ? 2 : 1;
+        if (position < 0 || position + size > static_cast<long>(length)) {
+            return fail("o65 relocation entry lies outside its segment");
+        }
+        uint8_t* at = &memory[static_cast<uint16_t>(start + position)];
+        switch (type & 0xE0) {
+            case TYPE_WORD: {
+                uint16_t value = littleEndian(at) + change;
+                at[0] = value & 0xFF;
+                at[1] = value >> 8;
+                break;
+            }
+            case TYPE_HIGH:
+                if (pagewise) {
+                    at[0] += change / 256;
+                } else {
+                    int low = in.get();
+                    if (low == std::char_traits<char>::eof()) {
+                        return fail(truncated);
+                    }
+                    at[0] = static_cast<uint8_t>(((at[0] << 8 | low) + change) >> 8);
+                }
+                break;
+            case TYPE_LOW:
+                at[0] += change;
+                break;
+            default:
+                return fail("o65 relocation type is not supported");
+        }
+    }
+    return true;
+}
+
+// A header of base addresses and lengths for the text, data, bss and zero
+// page segments, a list of header options, then the text and data segments
+// followed by the undefined reference list and the text and data relocation
+// tables. The tables are only read when relocateO65() moves the file.
+bool ProgramLoader::loadO65(std::istream& in) {
+    enum { MODE = 6, TBASE = 8, TLEN = 10, DBASE = 12, DLEN = 14, BBASE = 16, BLEN = 18, HEADER_SIZE = 26 };
+    const uint16_t MODE_PAGEWISE = 0x4000;
+    const uint16_t MODE_SIZE32 = 0x2000;
+    uint8_t header[HEADER_SIZE];
+    if (!in.read(reinterpret_cast<char*>(header), sizeof(header)) || header[5] != 0) {
+        return fail("not an o65 version 0 file");
+    }
+    uint16_t mode = littleEndian(header + MODE);
+    if (mode & MODE_SIZE32) {
+        return fail("o65 files with 32-bit sizes are not supported");
+    }
+
+    // Each option starts with its length, counting the length byte; a zero
+    // length ends the list.
+    for (int length; (length = in.get()) > 0;) {
+        if (!in.ignore(length - 1)) {
+            break;
+        }
+    }
+    if (!in) {
+        return fail("o65 header options are truncated");
+    }
+
+    int delta = relocating ? relocationBase - littleEndian(header + TBASE) : 0;
+    bool pagewise = mode & MODE_PAGEWISE;
+    if (pagewise && delta % 256) {
+        return fail("o65 file can only be moved by whole pages");
+    }
+    uint16_t tbase = littleEndian(header + TBASE) + delta;
+    int dbase = littleEndian(header + DBASE) + delta;
+    int bbase = littleEndian(header + BBASE) + delta;
+    if (std::min(dbase, bbase) < 0 || std::max(dbase, bbase) >= static_cast<int>(ADDRESS_SPACE)) {
+        return fail("o65 data or bss would leave the address space");
+    }
+    size_t tlen = littleEndian(header + TLEN);
+    size_t dlen = littleEndian(header + DLEN);
+    size_t blen = littleEndian(header + BLEN);
+    if (!readSegment(in, tbase, tlen, false) || !readSegment(in, dbase, dlen, false)) {
+        return false;
+    }
+    if (bbase + blen > ADDRESS_SPACE) {
+        return fail("o65 bss runs past $FFFF");
+    }
+    std::memset(&memory[bbase], 0, blen);
+
+    uint8_t undefined[2];
+    if (!in.read(reinterpret_cast<char*>(undefined), sizeof(undefined))) {
+        return fail("o65 undefined reference list is missing");
+    }
+    if (littleEndian(undefined)) {
+        return fail("o65 file has undefined references");
+    }
+    if (delta && (!relocate(in, tbase, tlen, delta, pagewise) || !relocate(in, dbase, dlen, delta, pagewise))) {
+        return false;
+    }
+    return setEntry(tbase);
+}
@@ -0,0 +1,99 @@
+#ifndef PROGRAMLOADER_H
+#define PROGRAMLOADER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include "Memory.h"
+
+enum class ProgramFormat : uint8_t {
+    Raw,        // a memory image, loaded at an address given by the caller
+    IntelHex,
+    SRecord,    // Motorola S19/S28/S37
+    Prg,        // Commodore: a little-endian load address, then the image
+    O65         // André Fachat's relocatable format, executables only
+};
+
+const char* programFormatName(ProgramFormat format);
+// Accepts raw, hex, srec, prg and o65.
+bool parseProgramFormat(const char* name, ProgramFormat& format);
+// Recognises the text formats and o65 by their first bytes and PRG by its
+// extension; anything else is Raw.
+ProgramFormat detectProgramFormat(const std::string& path, const uint8_t* head, size_t length);
+
+// What a load wrote and where the program says to start.
+struct LoadedProgram {
+    ProgramFormat format;
+    size_t bytes;
+    // Bulk copies into memory: one per contiguous run of records.
+    size_t segments;
+    // Set from a start address record (HEX 03/05, S7/S8/S9), the load
+    // address of a PRG or the text base of an o65.
+    bool hasEntry;
+    uint16_t entry;
+    double milliseconds;
+};
+
+void printLoadedProgram(std::ostream& out, const std::string& path, const LoadedProgram& program);
+
+// Loads program images in one streaming pass. Text formats are read in
+// fixed-size chunks and their records decoded into a 64K staging buffer;
+// a record continuing the one before extends the current segment, anything
+// else flushes it to memory with a single Memory::writeBlock(), so a
+// typical image costs a handful of copies rather than a write per byte.
+// Records are checksummed and must stay inside the 16-bit address space.
+// Raw, PRG and o65 images are read straight into memory. o65 segments are
+// loaded at the addresses they were assembled for unless relocateO65()
+// moves them, and files with undefined references are rejected.
+class ProgramLoader {
+private:
+    Memory& memory;
+    std::unique_ptr<uint8_t[]> segment;
+    uint32_t segmentStart;
+    uint32_t segmentLength;
+    // Extended address from HEX 02/04 records.
+    uint32_t addressBase;
+    size_t lineNumber;
+    bool finished;
+    bool relocating;
+    uint16_t relocationBase;
+    LoadedProgram program;
+    std::string error;
+
+    bool fail(const std::string& message);
+    bool append(uint32_t address, const uint8_t* data, size_t length);
+    void flush();
+    bool setEntry(uint32_t address);
+    bool readSegment(std::istream& in, uint32_t address, size_t length, bool toEnd);
+    bool relocate(std::istream& in, uint16_t start, size_t length, int delta, bool pagewise);
+
+    template <bool (ProgramLoader::*ParseRecord)(const char*, size_t)>
+    bool loadText(std::istream& in);
+    bool parseHexRecord(const char* text, size_t length);
+    bool parseSRecord(const char* text, size_t length);
+    bool loadPrg(std::istream& in);
+    bool loadO65(std::istream& in);
+
+public:
+    explicit ProgramLoader(Memory& mem);
+
+    // Loads the text segment of o65 files at base from now on, with their
+    // data and bss moved by the same distance, and applies the files'
+    // relocation tables to fix up the code.
+    void relocateO65(uint16_t base);
+
+    // Detects the format of the file at path and loads it. rawAddress is
+    // where a Raw image goes.
+    bool load(const std::string& path, uint16_t rawAddress);
+    bool load(const std::string& path, ProgramFormat format, uint16_t rawAddress);
+    bool load(std::istream& in, ProgramFormat format, uint16_t rawAddress);
+
+    // The last load; after a failure, what it wrote before stopping.
+    const LoadedProgram& getProgram() const;
+    const std::string& getError() const;
+};
+
+#endif
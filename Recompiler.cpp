@@ -0,0 +1,392 @@
+#include "Recompiler.h"
+#include "CPU.h"
+#include "OpcodeTable.h"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+
+const RecompiledProgram* linkedProgram = nullptr;
+
+struct RecompiledInstruction {
+    uint16_t address;
+    uint16_t operand;
+    uint32_t next;
+    uint8_t opcode;
+};
+
+// Decodes from start up to and including the first control-flow
+// instruction, stopping short of an invalid opcode, the next leader or the
+// end of the address space.
+std::vector<RecompiledInstruction> decodeBlock(Bus& bus, const std::vector<uint8_t>& leaders, uint16_t start) {
+    std::vector<RecompiledInstruction> instructions;
+    uint32_t address = start;
+    while (true) {
+        uint8_t opcode = bus.readMemory(address);
+        const OpcodeInfo& info = opcodeTable[opcode];
+        uint32_t next = address + 1 + operandLength(info.addressingMode);
+        if (!info.valid || next > 0x10000) {
+            break;
+        }
+        uint16_t operand = 0;
+        if (next - address > 1) {
+            operand = bus.readMemory(address + 1);
+        }
+        if (next - address > 2) {
+            operand |= bus.readMemory(address + 2) << 8;
+        }
+        instructions.push_back(RecompiledInstruction{static_cast<uint16_t>(address), operand, next, opcode});
+
+        address = next;
+        if (changesControlFlow(info.operation) || address == 0x10000 || leaders[address]) {
+            break;
+        }
+    }
+    return instructions;
+}
+
+uint32_t hashBytes(Bus& bus, uint16_t start, uint16_t length) {
+    uint32_t hash = 2166136261u;
+    for (uint32_t i = 0; i < length; i++) {
+        hash = (hash ^ bus.readMemory(start + i)) * 16777619u;
+    }
+    return hash;
+}
+
+// Prints value as a C++ hex literal of at least width digits.
+struct Hex {
+    uint32_t value;
+    int width;
+};
+
+std::ostream& operator<<(std::ostream& out, Hex hex) {
+    return out << "0x" << std::hex << std::uppercase << std::setw(hex.width) << std::setfill('0') << hex.value
+               << std::dec << std::nouppercase << std::setfill(' ');
+}
+
+// name as a C++ string literal.
+std::string quoted(const std::string& name) {
+    std::string literal = "\"";
+    for (char c : name) {
+        if (c == '\\' || c == '"') {
+            literal += '\\';
+        }
+        literal += c;
+    }
+    return literal + "\"";
+}
+
+std::string label(uint16_t address) {
+    std::ostringstream out;
+    out << "block_" << std::hex << std::setw(4) << std::setfill('0') << address;
+    return out.str();
+}
+
+}
+
+void registerRecompiledProgram(const RecompiledProgram* program) {
+    linkedProgram = program;
+}
+
+const RecompiledProgram* findRecompiledProgram() {
+    return linkedProgram;
+}
+
+size_t countStaleBlocks(Bus& bus, const RecompiledProgram& program) {
+    size_t stale = 0;
+    for (size_t i = 0; i < program.blockCount; i++) {
+        const RecompiledBlock& block = program.blocks[i];
+        stale += hashBytes(bus, block.start, block.length) != block.hash;
+    }
+    return stale;
+}
+
+Recompiler::Recompiler(Bus& bus) : bus(bus), instructionCount(0) {}
+
+void Recompiler::addEntry(uint16_t address) {
+    entries.push_back(address);
+}
+
+void Recompiler::markLeader(uint16_t address, std::vector<uint16_t>& pending) {
+    if (!leaders[address]) {
+        leaders[address] = 1;
+        pending.push_back(address);
+    }
+}
+
+// Every branch target and fall-through, JMP and JSR target, JSR return
+// address and BRK vector target reachable from the entries starts a block.
+void Recompiler::walk() {
+    leaders.assign(0x10000, 0);
+    blocks.clear();
+    instructionCount = 0;
+
+    std::vector<uint16_t> pending;
+    for (uint16_t entry : entries) {
+        markLeader(entry, pending);
+    }
+    while (!pending.empty()) {
+        uint16_t start = pending.back();
+        pending.pop_back();
+        for (const RecompiledInstruction& instruction : decodeBlock(bus, leaders, start)) {
+            const OpcodeInfo& info = opcodeTable[instruction.opcode];
+            uint16_t next = instruction.next;
+            bool fallsThrough = instruction.next < 0x10000;
+            if (info.addressingMode == AddressingModeType::Relative) {
+                if (fallsThrough) {
+                    markLeader(next, pending);
+                }
+                markLeader(next + static_cast<int8_t>(instruction.operand), pending);
+            } else if (info.operation == OperationType::JMP && info.addressingMode == AddressingModeType::Absolute) {
+                markLeader(instruction.operand, pending);
+            } else if (info.operation == OperationType::JSR) {
+                markLeader(instruction.operand, pending);
+                if (fallsThrough) {
+                    markLeader(next, pending);
+                }
+            } else if (info.operation == OperationType::BRK) {
+                markLeader(bus.readMemory(0xFFFE) | (bus.readMemory(0xFFFF) << 8), pending);
+            }
+        }
+    }
+
+    // Decode again now that every leader is known, so that blocks stop at
+    // leaders found after they were first walked.
+    for (uint32_t address = 0; address < 0x10000; address++) {
+        if (!leaders[address]) {
+            continue;
+        }
+        std::vector<RecompiledInstruction> instructions = decodeBlock(bus, leaders, address);
+        if (instructions.empty()) {
+            continue;
+        }
+        uint16_t length = instructions.back().next - address;
+        blocks.push_back(RecompiledBlock{static_cast<uint16_t>(address), length, hashBytes(bus, address, length)});
+        instructionCount += instructions.size();
+    }
+}
+
+void Recompiler::emit(std::ostream& out, const std::string& name, const std::string& symbol) const {
+    out << "// Generated by the static recompiler (see Recompiler.h); do not edit.\n"
+        << "#include \"Recompiler.h\"\n"
+        << "#include \"FusedHandlers.inl\"\n\n"
+        << "namespace {\n\n"
+        << "uint64_t run(CPU& cpu, uint64_t budget, const uint8_t* modified, int32_t* loopJump) {\n"
+        << "    uint64_t executed = 0;\n"
+        << "dispatch:\n"
+        << "    switch (cpu.getPC()) {\n";
+    for (const RecompiledBlock& block : blocks) {
+        out << "        case " << Hex{block.start, 4} << ": goto " << label(block.start) << ";\n";
+    }
+    out << "        default: return executed;\n"
+        << "    }\n";
+    for (const RecompiledBlock& block : blocks) {
+        emitBlock(out, block);
+    }
+    out << "}\n\n"
+        << "const RecompiledBlock blocks[] = {\n";
+    for (const RecompiledBlock& block : blocks) {
+        out << "    {" << Hex{block.start, 4} << ", " << block.length << ", " << Hex{block.hash, 8} << "u},\n";
+    }
+    out << "};\n\n";
+    if (!symbol.empty()) {
+        out << "}\n\n"
+            << "extern const RecompiledProgram " << symbol << ";\n"
+            << "const RecompiledProgram " << symbol << " = {" << quoted(name) << ", blocks, " << blocks.size()
+            << ", &run};\n";
+        return;
+    }
+    out << "const RecompiledProgram program = {" << quoted(name) << ", blocks, " << blocks.size() << ", &run};\n\n"
+        << "struct Registration {\n"
+        << "    Registration() { registerRecompiledProgram(&program); }\n"
+        << "} registration;\n\n"
+        << "}\n";
+}
+
+// Base cycles are charged once at the end of the block, or for the part that
+// ran when a store into the block's pages or one requesting a stop leaves it
+// early.
+void Recompiler::emitBlock(std::ostream& out, const RecompiledBlock& block) const {
+    std::vector<RecompiledInstruction> instructions = decodeBlock(bus, leaders, block.start);
+    uint8_t firstPage = block.start >> 8;
+    uint8_t lastPage = (block.start + block.length - 1) >> 8;
+    std::ostringstream modified;
+    modified << "modified[" << Hex{firstPage, 2} << "]";
+    if (lastPage != firstPage) {
+        modified << " | modified[" << Hex{lastPage, 2} << "]";
+    }
+
+    out << label(block.start) << ":\n"
+        << "    if (budget - executed < " << instructions.size() << " || " << modified.str()
+        << " || cpu.isStopRequested() || cpu.canTakeInterrupt(cpu.getInterruptDisableFlag())) {\n"
+        << "        return executed;\n"
+        << "    }\n";
+
+    uint32_t cycles = 0;
+    for (size_t i = 0; i < instructions.size(); i++) {
+        const RecompiledInstruction& instruction = instructions[i];
+        const OpcodeInfo& info = opcodeTable[instruction.opcode];
+        bool last = i + 1 == instructions.size();
+        cycles += cycleTable[instruction.opcode];
+
+        // Only control flow and immediate operands, which are read from
+        // PC - 1, depend on PC, and control flow always ends the block.
+        if (last || info.addressingMode == AddressingModeType::Immediate) {
+            out << "    cpu.setPC(" << Hex{instruction.next & 0xFFFF, 4} << ");\n";
+        }
+        out << "    predecodedHandler<" << Hex{instruction.opcode, 2} << ">(cpu, " << Hex{instruction.operand, 4} << ");\n";
+        if (!last && writesMemory(info)) {
+            out << "    if (" << modified.str() << " || cpu.isStopRequested()) {\n"
+                << "        cpu.setPC(" << Hex{instruction.next, 4} << ");\n"
+                << "        cpu.addCycles(" << cycles << ");\n"
+                << "        return executed + " << i + 1 << ";\n"
+                << "    }\n";
+        }
+    }
+    out << "    cpu.addCycles(" << cycles << ");\n"
+        << "    executed += " << instructions.size() << ";\n";
+
+    // Known successors are jumped to directly; anything else goes back
+    // through the switch.
+    const RecompiledInstruction& end = instructions.back();
+    const OpcodeInfo& info = opcodeTable[end.opcode];
+    std::vector<uint16_t> successors;
+    if (info.addressingMode == AddressingModeType::Relative) {
+        successors.push_back(end.next + static_cast<int8_t>(end.operand));
+        successors.push_back(end.next);
+    } else if (info.operation == OperationType::JMP && info.addressingMode == AddressingModeType::Absolute) {
+        successors.push_back(end.operand);
+    } else if (info.operation == OperationType::JSR) {
+        successors.push_back(end.operand);
+    } else if (!changesControlFlow(info.operation) && end.next < 0x10000) {
+        successors.push_back(end.next);
+    }
+    // Jumps back return first when the caller watches for loops.
+    auto leaveAtLoop = [&](const char* indent) {
+        out << indent << "if (loopJump) {\n"
+            << indent << "    *loopJump = " << Hex{end.address, 4} << ";\n"
+            << indent << "    return executed;\n"
+            << indent << "}\n";
+    };
+    bool branch = successors.size() > 1;
+    bool jumped = false;
+    size_t linked = 0;
+    for (uint16_t successor : successors) {
+        if (!leaders[successor] || decodeBlock(bus, leaders, successor).empty()) {
+            continue;
+        }
+        linked++;
+        bool back = successor <= end.address;
+        if (branch) {
+            out << "    if (cpu.getPC() == " << Hex{successor, 4} << ") {\n";
+            if (back) {
+                leaveAtLoop("        ");
+            }
+            out << "        goto " << label(successor) << ";\n"
+                << "    }\n";
+        } else {
+            if (back) {
+                leaveAtLoop("    ");
+            }
+            out << "    goto " << label(successor) << ";\n";
+            jumped = true;
+        }
+    }
+    if (!jumped) {
+        // A computed jump, or one to code that was not recompiled.
+        if (changesControlFlow(info.operation) && (successors.empty() || linked < successors.size())) {
+            out << "    if (cpu.getPC() <= " << Hex{end.address, 4} << ") {\n";
+            leaveAtLoop("        ");
+            out << "    }\n";
+        }
+        out << "    goto dispatch;\n";
+    }
+}
+
+size_t Recompiler::getBlockCount() const {
+    return blocks.size();
+}
+
+size_t Recompiler::getInstructionCount() const {
+    return instructionCount;
+}
+
+RecompiledRunner::RecompiledRunner(CPU& cpu, Bus& bus, const RecompiledProgram& program)
+    : cpu(cpu), bus(bus), program(program), codeBytes(0x10000, 0), breakpoints(nullptr) {
+    watchSlot = bus.addWriteWatcher(this);
+    for (size_t i = 0; i < program.blockCount; i++) {
+        const RecompiledBlock& block = program.blocks[i];
+        for (uint32_t address = block.start; address < block.start + block.length; address++) {
+            codeBytes[address] = 1;
+            bus.watchPage(watchSlot, address >> 8, true);
+        }
+    }
+    validate();
+}
+
+RecompiledRunner::~RecompiledRunner() {
+    bus.removeWriteWatcher(watchSlot);
+}
+
+void RecompiledRunner::run(uint64_t count) {
+    while (count > 0) {
+        if (cpu.hasPendingInterrupts()) {
+            cpu.serviceInterrupts();
+        }
+        uint64_t executed = program.run(cpu, count, modifiedPages, nullptr);
+        count -= executed;
+        if (executed == 0) {
+            cpu.execute();
+            count--;
+        }
+    }
+}
+
+uint64_t RecompiledRunner::runChecked(uint64_t count, int32_t* loopJump) {
+    return program.run(cpu, count, checkedPages, loopJump);
+}
+
+void RecompiledRunner::setBreakpoints(const uint8_t* map) {
+    breakpoints = map;
+    updateCheckedPages();
+}
+
+// A block holding a breakpoint spans at most two pages, one of which has
+// the breakpoint on it, so marking that page keeps the block from running.
+void RecompiledRunner::updateCheckedPages() {
+    std::copy(modifiedPages, modifiedPages + 256, checkedPages);
+    if (!breakpoints) {
+        return;
+    }
+    for (uint32_t address = 0; address < 0x10000; address++) {
+        if (breakpoints[address]) {
+            checkedPages[address >> 8] = 1;
+        }
+    }
+}
+
+void RecompiledRunner::validate() {
+    std::fill(modifiedPages, modifiedPages + 256, 0);
+    for (size_t i = 0; i < program.blockCount; i++) {
+        const RecompiledBlock& block = program.blocks[i];
+        if (hashBytes(bus, block.start, block.length) != block.hash) {
+            modifiedPages[block.start >> 8] = 1;
+            modifiedPages[(block.start + block.length - 1) >> 8] = 1;
+        }
+    }
+    updateCheckedPages();
+}
+
+void RecompiledRunner::onWatchedWrite(uint16_t address) {
+    if (codeBytes[address]) {
+        modifiedPages[address >> 8] = 1;
+        checkedPages[address >> 8] = 1;
+    }
+}
+
+// Only pages holding recompiled code are watched.
+void RecompiledRunner::onPageRemapped(uint8_t page) {
+    modifiedPages[page] = 1;
+    checkedPages[page] = 1;
+}
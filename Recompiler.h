@@ -0,0 +1,112 @@
+#ifndef RECOMPILER_H
+#define RECOMPILER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "Bus.h"
+
+class CPU;
+
+// A straight-line run of recompiled code. hash is an FNV-1a hash of its bytes
+// as they were when the program was recompiled.
+struct RecompiledBlock {
+    uint16_t start;
+    uint16_t length;
+    uint32_t hash;
+};
+
+// What a generated source file defines. run() executes recompiled code from
+// PC, jumping from block to block, until the budget is spent or PC reaches
+// code that was not recompiled, and returns the instructions it executed.
+// Blocks on a page with a non-zero modifiedPages entry are not run. It
+// returns at the next block while an interrupt can be taken, and after a
+// store once the CPU's stop is requested. With loopJump set it also returns
+// after every jump to or behind its own address, storing that address there.
+struct RecompiledProgram {
+    const char* name;
+    const RecompiledBlock* blocks;
+    size_t blockCount;
+    uint64_t (*run)(CPU& cpu, uint64_t budget, const uint8_t* modifiedPages, int32_t* loopJump);
+};
+
+// Generated files register their program from a static initialiser, so
+// linking one in is all it takes to make ExecutionEngine::Static available.
+void registerRecompiledProgram(const RecompiledProgram* program);
+const RecompiledProgram* findRecompiledProgram();
+// Blocks of program whose bytes differ from memory as the bus maps it.
+size_t countStaleBlocks(Bus& bus, const RecompiledProgram& program);
+
+// Offline half: walks the code reachable from the entry points and emits C++
+// in which every instruction is an inlined predecodedHandler with its operand
+// as a constant. Branches, JMP and JSR with known targets become gotos
+// between blocks; RTS, RTI, BRK and JMP (ind) leave through a switch on PC,
+// and anything the walk did not reach is left to the interpreter. Only the
+// NMOS opcode map is supported.
+class Recompiler {
+private:
+    Bus& bus;
+    std::vector<uint16_t> entries;
+    std::vector<uint8_t> leaders;
+    std::vector<RecompiledBlock> blocks;
+    size_t instructionCount;
+
+    void markLeader(uint16_t address, std::vector<uint16_t>& pending);
+    void emitBlock(std::ostream& out, const RecompiledBlock& block) const;
+
+public:
+    explicit Recompiler(Bus& bus);
+
+    void addEntry(uint16_t address);
+    // Finds every block reachable from the entries, reading code through the bus.
+    void walk();
+    // With symbol given, the program is defined under that name with
+    // external linkage instead of registering itself, for code that picks
+    // it with registerRecompiledProgram().
+    void emit(std::ostream& out, const std::string& name, const std::string& symbol = std::string()) const;
+
+    size_t getBlockCount() const;
+    size_t getInstructionCount() const;
+};
+
+// Runs a linked-in RecompiledProgram for the CPU, falling back to the fused
+// interpreter wherever it has no block. Writes through the bus to recompiled
+// code bytes mark their page modified, and blocks on a modified page run
+// interpreted from then on. Memory changed behind the bus's back needs
+// validate(), which rechecks every block against its hash.
+class RecompiledRunner : public WriteWatcher {
+private:
+    CPU& cpu;
+    Bus& bus;
+    const RecompiledProgram& program;
+    int watchSlot;
+    std::vector<uint8_t> codeBytes;
+    const uint8_t* breakpoints;
+    uint8_t modifiedPages[256];
+    // Modified pages and pages holding a breakpoint, which runChecked()
+    // leaves to the interpreter.
+    uint8_t checkedPages[256];
+
+    void updateCheckedPages();
+
+public:
+    RecompiledRunner(CPU& cpu, Bus& bus, const RecompiledProgram& program);
+    ~RecompiledRunner() override;
+
+    void run(uint64_t count);
+    // For runs that check stop conditions: runs recompiled code from PC for
+    // at most count instructions, as RecompiledProgram::run() does with
+    // loopJump, and returns the instructions executed, 0 when there is no
+    // block to run there. Blocks on a page with a breakpoint never run.
+    uint64_t runChecked(uint64_t count, int32_t* loopJump);
+    // Addresses with a non-zero entry in map (64K entries, or nullptr for
+    // none) are breakpoints.
+    void setBreakpoints(const uint8_t* map);
+    void validate();
+    void onWatchedWrite(uint16_t address) override;
+    void onPageRemapped(uint8_t page) override;
+};
+
+#endif
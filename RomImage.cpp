@@ -0,0 +1,121 @@
+#include "RomImage.h"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+#if defined(__linux__) || defined(__APPLE__)
+#define ROMIMAGE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+}
+
+void printImageStats(std::ostream& out, const std::string& path, const ImageStats& stats) {
+    out << path << ": " << std::dec << stats.bytes << " bytes " << (stats.mapped ? "mapped" : "copied") << " in "
+        << stats.milliseconds << " ms, " << stats.residentBytes / 1024 << " KB resident" << std::endl;
+}
+
+RomImage::RomImage() : data(nullptr), size(0), mapped(false), stats{} {}
+
+RomImage::~RomImage() {
+#ifdef ROMIMAGE_MMAP
+    if (mapped) {
+        munmap(const_cast<uint8_t*>(data), size);
+        return;
+    }
+#endif
+    delete[] data;
+}
+
+bool RomImage::open(const std::string& path) {
+    auto start = Clock::now();
+#ifdef ROMIMAGE_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        struct stat info;
+        void* address = MAP_FAILED;
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            address = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        ::close(fd);
+        if (address != MAP_FAILED) {
+            data = static_cast<const uint8_t*>(address);
+            size = info.st_size;
+            mapped = true;
+            stats = ImageStats{size, millisecondsSince(start), 0, true};
+            getStats();
+            return true;
+        }
+    }
+#endif
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        std::cerr << "Error opening file: " << path << std::endl;
+        return false;
+    }
+    size = file.tellg();
+    // Rounded up to whole pages, like a mapping.
+    uint8_t* buffer = new uint8_t[(size + 0xFF) & ~static_cast<size_t>(0xFF)]();
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(buffer), size);
+    data = buffer;
+    stats = ImageStats{size, millisecondsSince(start), size, false};
+    return true;
+}
+
+// A mapping covers whole host pages, which are a multiple of 256 bytes, so
+// the zero-filled tail of the last one makes up a partial last 6502 page.
+bool RomImage::attach(Bus& bus, uint16_t address) const {
+    if (!data || (address & 0xFF)) {
+        return false;
+    }
+    unsigned pages = (size + 0xFF) >> 8;
+    return bus.mapMemory(address >> 8, pages, const_cast<uint8_t*>(data), PAGE_READ_ONLY);
+}
+
+const uint8_t* RomImage::getData() const {
+    return data;
+}
+
+size_t RomImage::getSize() const {
+    return size;
+}
+
+const ImageStats& RomImage::getStats() {
+#ifdef ROMIMAGE_MMAP
+    if (mapped) {
+        size_t hostPage = sysconf(_SC_PAGESIZE);
+        size_t hostPages = (size + hostPage - 1) / hostPage;
+#ifdef __APPLE__
+        char* resident = new char[hostPages];
+#else
+        unsigned char* resident = new unsigned char[hostPages];
+#endif
+        stats.residentBytes = 0;
+        if (mincore(const_cast<uint8_t*>(data), size, resident) == 0) {
+            for (size_t i = 0; i < hostPages; i++) {
+                stats.residentBytes += (resident[i] & 1) ? hostPage : 0;
+            }
+        }
+        delete[] resident;
+    }
+#endif
+    return stats;
+}
+
+ImageStats loadRamImage(Memory& memory, const std::string& path, uint16_t address) {
+    auto start = Clock::now();
+    size_t bytes = memory.loadProgram(path, address);
+    return ImageStats{bytes, millisecondsSince(start), bytes, false};
+}
@@ -0,0 +1,55 @@
+#ifndef ROMIMAGE_H
+#define ROMIMAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include "Bus.h"
+#include "Memory.h"
+
+// What loading one image cost.
+struct ImageStats {
+    size_t bytes;
+    double milliseconds;
+    // Host memory the image occupies once loaded: the pages of a mapped
+    // image that are in core, the bytes copied for a RAM image.
+    size_t residentBytes;
+    bool mapped;
+};
+
+void printImageStats(std::ostream& out, const std::string& path, const ImageStats& stats);
+
+// A ROM image file mapped read-only into the host address space and
+// attached to the bus as read-only pages, so reads go straight to the page
+// cache and nothing is copied; pages the program never touches are never
+// read from disk. Hosts without mmap read the file into a buffer instead.
+class RomImage {
+private:
+    const uint8_t* data;
+    size_t size;
+    bool mapped;
+    ImageStats stats;
+
+public:
+    RomImage();
+    ~RomImage();
+    RomImage(const RomImage&) = delete;
+    RomImage& operator=(const RomImage&) = delete;
+
+    bool open(const std::string& path);
+    // Maps the image from address, which must start a page, up to the end
+    // of the image or of the address space. The image must stay open while
+    // it is attached. Fails on pages a MappedBus's map fixes.
+    bool attach(Bus& bus, uint16_t address) const;
+    const uint8_t* getData() const;
+    size_t getSize() const;
+    // Refreshes residentBytes, which grows as the program touches the image.
+    const ImageStats& getStats();
+};
+
+// Loads a RAM image into memory from address with one bulk copy. Returns
+// stats with bytes 0 if the file cannot be read.
+ImageStats loadRamImage(Memory& memory, const std::string& path, uint16_t address);
+
+#endif
@@ -0,0 +1,161 @@
+#include "RunControl.h"
+#include "OpcodeTable.h"
+#include <algorithm>
+
+const char* stopReasonName(StopReason reason) {
+    switch (reason) {
+        case StopReason::Budget: return "budget";
+        case StopReason::Breakpoint: return "breakpoint";
+        case StopReason::WriteTrigger: return "write trigger";
+        case StopReason::Halt: return "halt";
+        case StopReason::Idle: return "idle loop";
+        case StopReason::CycleDeadline: return "cycle deadline";
+    }
+    return "unknown";
+}
+
+bool StopConditions::empty() const {
+    return breakpoints.empty() && writeTriggers.empty() && !stopOnHalt && idleAction == IdleAction::Ignore &&
+           cycleDeadline == NO_DEADLINE;
+}
+
+bool StopConditions::operator==(const StopConditions& other) const {
+    return breakpoints == other.breakpoints && writeTriggers == other.writeTriggers &&
+           stopOnHalt == other.stopOnHalt && idleAction == other.idleAction && cycleDeadline == other.cycleDeadline;
+}
+
+bool LoopState::operator==(const LoopState& other) const {
+    return A == other.A && X == other.X && Y == other.Y && SP == other.SP && P == other.P;
+}
+
+StopMonitor::StopMonitor(Bus& bus, bool& stopRequested)
+    : bus(bus), stopRequested(stopRequested), breakpointMap(0x10000, 0), triggerAddress(0), resumeAddress(-1),
+      loopStart(-1), loopJump(0), loopState{}, loopCycles(0), loopPassCycles(0), idleInstructions(0) {
+    watchSlot = bus.addWriteWatcher(this);
+}
+
+StopMonitor::~StopMonitor() {
+    bus.removeWriteWatcher(watchSlot);
+}
+
+bool StopMonitor::configure(const StopConditions& value) {
+    if (value == conditions) {
+        return false;
+    }
+    bool breakpointsChanged = value.breakpoints != conditions.breakpoints;
+    conditions = value;
+
+    std::fill(breakpointMap.begin(), breakpointMap.end(), 0);
+    for (uint16_t address : conditions.breakpoints) {
+        breakpointMap[address] = 1;
+    }
+
+    for (int page = 0; page < 256; page++) {
+        bus.watchPage(watchSlot, page, false);
+    }
+    for (const std::pair<uint16_t, uint16_t>& range : conditions.writeTriggers) {
+        for (int page = range.first >> 8; page <= range.second >> 8; page++) {
+            bus.watchPage(watchSlot, page, true);
+        }
+    }
+    return breakpointsChanged;
+}
+
+void StopMonitor::onWatchedWrite(uint16_t address) {
+    for (const std::pair<uint16_t, uint16_t>& range : conditions.writeTriggers) {
+        if (address >= range.first && address <= range.second) {
+            triggerAddress = address;
+            stopRequested = true;
+            return;
+        }
+    }
+}
+
+// Instructions in the loop from start to the jump at jump, or 0 unless
+// every one of them is valid, none stores or may read a device, and only
+// the last changes control flow. Decoding goes through the bus like
+// execution does.
+uint32_t StopMonitor::idleLoopLength(uint16_t start, uint16_t jump) const {
+    uint32_t length = 0;
+    uint32_t address = start;
+    while (true) {
+        const OpcodeInfo& info = opcodeTable[bus.readMemory(address)];
+        if (!info.valid || writesMemory(info) || mayReadDevice(address, info)) {
+            return 0;
+        }
+        length++;
+        if (address == jump) {
+            return length;
+        }
+        if (changesControlFlow(info.operation)) {
+            return 0;
+        }
+        address += 1 + operandLength(info.addressingMode);
+        if (address > jump) {
+            return 0;
+        }
+    }
+}
+
+// Whether the instruction at address is on a device page or may read one.
+// Indexed addresses are checked on both pages they can fall in; indirect
+// ones could land anywhere.
+bool StopMonitor::mayReadDevice(uint16_t address, const OpcodeInfo& info) const {
+    uint16_t last = address + operandLength(info.addressingMode);
+    if (bus.isDevicePage(address >> 8) || bus.isDevicePage(last >> 8)) {
+        return true;
+    }
+    if (!bus.hasDevicePages()) {
+        return false;
+    }
+    uint16_t operand = bus.readMemory(address + 1);
+    if (operandLength(info.addressingMode) == 2) {
+        operand |= bus.readMemory(address + 2) << 8;
+    }
+    switch (info.addressingMode) {
+        case AddressingModeType::ZeroPage:
+        case AddressingModeType::ZeroPageX:
+        case AddressingModeType::ZeroPageY:
+            return bus.isDevicePage(0);
+        case AddressingModeType::Absolute:
+            if (info.operation == OperationType::JMP || info.operation == OperationType::JSR) {
+                return false;
+            }
+            return bus.isDevicePage(operand >> 8);
+        case AddressingModeType::AbsoluteX:
+        case AddressingModeType::AbsoluteY:
+        case AddressingModeType::IndirectNoWrap:
+            return bus.isDevicePage(operand >> 8) || bus.isDevicePage(((operand >> 8) + 1) & 0xFF);
+        case AddressingModeType::Indirect:
+            return bus.isDevicePage(operand >> 8);
+        case AddressingModeType::IndexedIndirectX:
+        case AddressingModeType::IndirectIndexedY:
+        case AddressingModeType::ZeroPageIndirect:
+            return true;
+        default:
+            return false;
+    }
+}
+
+uint64_t StopMonitor::fastForward(uint64_t remaining, uint32_t length, uint64_t& cycles) {
+    uint64_t passes = remaining / length;
+    if (conditions.cycleDeadline != StopConditions::NO_DEADLINE && loopPassCycles > 0) {
+        // Leave the pass that reaches the deadline to be run for real, so the
+        // run stops on the right instruction.
+        uint64_t before = cycles < conditions.cycleDeadline ? conditions.cycleDeadline - cycles - 1 : 0;
+        passes = std::min(passes, before / loopPassCycles);
+    }
+    idleInstructions += passes * length;
+    cycles += passes * loopPassCycles;
+    return remaining - passes * length;
+}
+
+void StopMonitor::beginRun() {
+    forgetLoop();
+    idleInstructions = 0;
+}
+
+RunResult StopMonitor::finish(StopReason reason, uint64_t instructions, uint16_t address) {
+    resumeAddress = reason == StopReason::Breakpoint ? address : -1;
+    return RunResult{reason, instructions, address, idleInstructions};
+}
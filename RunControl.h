@@ -0,0 +1,186 @@
+#ifndef RUNCONTROL_H
+#define RUNCONTROL_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "Bus.h"
+
+struct OpcodeInfo;
+
+enum class StopReason {
+    Budget,         // the instruction budget ran out
+    Breakpoint,     // PC reached one of StopConditions::breakpoints
+    WriteTrigger,   // a store hit one of StopConditions::writeTriggers
+    Halt,           // an instruction jumped or branched to itself
+    Idle,           // the CPU is in a loop it can never leave, see IdleAction
+    CycleDeadline   // CPU::getCycles() reached StopConditions::cycleDeadline
+};
+
+// What CPU::run() does on an idle loop: a straight run of instructions with
+// no stores, ending in a jump or branch back to its start, that comes round
+// with the same registers and flags as the time before. Nothing can change
+// what such a loop reads, so it spins until the run ends. That covers
+// JMP *, BNE * and polling loops such as LDA $reg; BEQ -, as long as $reg is
+// memory: a loop that may read a device page is never idle.
+enum class IdleAction {
+    Ignore,
+    Stop,           // return StopReason::Idle with the loop's start address
+    FastForward     // count the rest of the budget, up to the cycle
+                    // deadline, as spent in the loop
+};
+
+const char* stopReasonName(StopReason reason);
+
+// Reasons for CPU::run() to return before its budget is spent.
+struct StopConditions {
+    // Stop before executing the instruction at any of these addresses. A run
+    // that starts on the breakpoint it last stopped at steps over it.
+    std::vector<uint16_t> breakpoints;
+    // Stop right after a store into any of these inclusive address ranges.
+    std::vector<std::pair<uint16_t, uint16_t>> writeTriggers;
+    // Stop on JMP * and BNE * style traps, which is how test ROMs and most
+    // bare-metal programs signal that they are done.
+    bool stopOnHalt = false;
+    IdleAction idleAction = IdleAction::Ignore;
+    // Stop at the first instruction boundary where the cycle counter has
+    // reached this value.
+    uint64_t cycleDeadline = NO_DEADLINE;
+
+    static const uint64_t NO_DEADLINE = UINT64_MAX;
+
+    bool empty() const;
+    bool operator==(const StopConditions& other) const;
+};
+
+struct RunResult {
+    StopReason reason;
+    uint64_t instructions;
+    // The stored address for WriteTrigger, the loop's start for Idle and
+    // PC for everything else.
+    uint16_t address;
+    // Part of instructions skipped by IdleAction::FastForward.
+    uint64_t idleInstructions;
+};
+
+// Registers and flags compared between two passes round a loop.
+struct LoopState {
+    uint8_t A;
+    uint8_t X;
+    uint8_t Y;
+    uint8_t SP;
+    uint8_t P;
+
+    bool operator==(const LoopState& other) const;
+};
+
+// StopConditions compiled for the run loops: a byte per address for the
+// breakpoints and bus watches on the write-trigger pages. A trigger sets
+// the CPU's stop flag, which the loops test after every instruction. Kept
+// by the CPU between runs and only rebuilt when the conditions change.
+class StopMonitor : public WriteWatcher {
+private:
+    Bus& bus;
+    bool& stopRequested;
+    int watchSlot;
+    StopConditions conditions;
+    std::vector<uint8_t> breakpointMap;
+    uint16_t triggerAddress;
+    // Breakpoint the last run stopped at, stepped over if the next run starts there.
+    int32_t resumeAddress;
+
+    // The last backward jump seen, and the state it left the CPU in.
+    int32_t loopStart;
+    uint16_t loopJump;
+    LoopState loopState;
+    uint64_t loopCycles;
+    uint64_t loopPassCycles;
+    uint64_t idleInstructions;
+
+    uint32_t idleLoopLength(uint16_t start, uint16_t jump) const;
+    bool mayReadDevice(uint16_t address, const OpcodeInfo& info) const;
+
+public:
+    StopMonitor(Bus& bus, bool& stopRequested);
+    ~StopMonitor() override;
+
+    // Returns true when the breakpoints changed.
+    bool configure(const StopConditions& value);
+    void onWatchedWrite(uint16_t address) override;
+
+    const uint8_t* getBreakpointMap() const;
+    bool isBreakpoint(uint16_t address) const;
+    bool stopsOnHalt() const;
+    IdleAction getIdleAction() const;
+    uint64_t getCycleDeadline() const;
+    uint16_t getTriggerAddress() const;
+
+    // Called after every taken jump or branch from jump back to start, with
+    // the state and cycle count it left. Returns the loop's length in
+    // instructions once the CPU is known to be idle in it, otherwise 0.
+    uint32_t checkIdle(uint16_t jump, uint16_t start, const LoopState& state, uint64_t cycles);
+    // Remaining budget after fast-forwarding through whole passes of the
+    // idle loop checkIdle() found, stopping short of the cycle deadline.
+    // Advances cycles by the time skipped.
+    uint64_t fastForward(uint64_t remaining, uint32_t length, uint64_t& cycles);
+
+    // Forgets the loop checkIdle() last saw, after jumps back that were not
+    // passed to it.
+    void forgetLoop();
+    // Clears what was learnt about loops, since the host may have changed
+    // memory or registers since the last run.
+    void beginRun();
+
+    // True when the last run stopped at the breakpoint at pc, so a run
+    // starting there steps over it.
+    bool resumesFrom(uint16_t pc) const;
+    // Builds the result, remembering a breakpoint stop for the next run.
+    RunResult finish(StopReason reason, uint64_t instructions, uint16_t address);
+};
+
+inline const uint8_t* StopMonitor::getBreakpointMap() const {
+    return breakpointMap.data();
+}
+
+inline bool StopMonitor::isBreakpoint(uint16_t address) const {
+    return breakpointMap[address];
+}
+
+inline bool StopMonitor::stopsOnHalt() const {
+    return conditions.stopOnHalt;
+}
+
+inline IdleAction StopMonitor::getIdleAction() const {
+    return conditions.idleAction;
+}
+
+inline uint64_t StopMonitor::getCycleDeadline() const {
+    return conditions.cycleDeadline;
+}
+
+inline uint32_t StopMonitor::checkIdle(uint16_t jump, uint16_t start, const LoopState& state, uint64_t cycles) {
+    if (start != loopStart || jump != loopJump || !(state == loopState)) {
+        loopStart = start;
+        loopJump = jump;
+        loopState = state;
+        loopCycles = cycles;
+        return 0;
+    }
+    loopPassCycles = cycles - loopCycles;
+    loopCycles = cycles;
+    return idleLoopLength(start, jump);
+}
+
+inline void StopMonitor::forgetLoop() {
+    loopStart = -1;
+}
+
+inline uint16_t StopMonitor::getTriggerAddress() const {
+    return triggerAddress;
+}
+
+inline bool StopMonitor::resumesFrom(uint16_t pc) const {
+    return resumeAddress == pc;
+}
+
+#endif
@@ -0,0 +1,511 @@
+#include "SaveState.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#if defined(__linux__) || defined(__APPLE__)
+#define SAVESTATE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char MAGIC[8] = {'6', '5', '0', '2', 'S', 'A', 'V', 'E'};
+const size_t HEADER_SIZE = 64;
+const size_t CHECKED_FROM = 16;
+const size_t MEMORY_OFFSET = 4096;
+const size_t MEMORY_SIZE = 0x10000;
+
+enum HeaderField {
+    VERSION_FIELD = 8,
+    FLAGS_FIELD = 10,
+    CHECKSUM_FIELD = 12,
+    RAW_SIZE_FIELD = 16,
+    STORED_SIZE_FIELD = 20,
+    MEMORY_OFFSET_FIELD = 24,
+    DEVICE_OFFSET_FIELD = 28,
+    DEVICE_SIZE_FIELD = 32,
+    PC_FIELD = 36,
+    A_FIELD = 38,
+    X_FIELD = 39,
+    Y_FIELD = 40,
+    SP_FIELD = 41,
+    P_FIELD = 42,
+    VARIANT_FIELD = 43,
+    CYCLES_FIELD = 44,
+    PENDING_FIELD = 52,
+    NMI_FIELD = 56
+};
+
+void put(uint8_t* out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+uint64_t get(const uint8_t* in, int bytes) {
+    uint64_t value = 0;
+    for (int i = bytes - 1; i >= 0; i--) {
+        value = value << 8 | in[i];
+    }
+    return value;
+}
+
+struct Crc32Table {
+    uint32_t entries[256];
+
+    Crc32Table() {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; bit++) {
+                crc = (crc >> 1) ^ (crc & 1 ? 0xEDB88320 : 0);
+            }
+            entries[i] = crc;
+        }
+    }
+};
+
+const Crc32Table crcTable;
+
+uint32_t crc32(const uint8_t* data, size_t size) {
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < size; i++) {
+        crc = crcTable.entries[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+// LZ4 block format: sequences of a token holding a literal count and a
+// match length, each topped up by bytes of 255 when it reaches 15, then
+// the literals, then the match's 16-bit distance back. The last sequence is
+// literals alone, and matches keep clear of the last bytes as LZ4 requires,
+// so standard decoders read these blocks too.
+const size_t MIN_MATCH = 4;
+const size_t LAST_LITERALS = 5;
+const size_t MATCH_LIMIT = 12;
+const int HASH_BITS = 12;
+
+size_t compressBound(size_t size) {
+    return size + size / 255 + 16;
+}
+
+uint32_t load32(const uint8_t* data) {
+    uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+uint8_t* putLength(uint8_t* out, size_t length) {
+    for (; length >= 255; length -= 255) {
+        *out++ = 255;
+    }
+    *out++ = static_cast<uint8_t>(length);
+    return out;
+}
+
+uint8_t* putSequence(uint8_t* out, const uint8_t* literals, size_t literalCount, size_t offset, size_t matchLength) {
+    uint8_t* token = out++;
+    *token = static_cast<uint8_t>(std::min<size_t>(literalCount, 15) << 4);
+    if (literalCount >= 15) {
+        out = putLength(out, literalCount - 15);
+    }
+    std::memcpy(out, literals, literalCount);
+    out += literalCount;
+    if (matchLength) {
+        put(out, offset, 2);
+        out += 2;
+        size_t extra = matchLength - MIN_MATCH;
+        *token |= static_cast<uint8_t>(std::min<size_t>(extra, 15));
+        if (extra >= 15) {
+            out = putLength(out, extra - 15);
+        }
+    }
+    return out;
+}
+
+// Greedy matching through a hash of the next four bytes, stepping faster
+// through data that keeps failing to match.
+size_t compressBlock(const uint8_t* source, size_t size, uint8_t* destination) {
+    uint32_t table[1 << HASH_BITS] = {};
+    uint8_t* out = destination;
+    size_t anchor = 0;
+    size_t position = 0;
+    while (size >= MATCH_LIMIT && position <= size - MATCH_LIMIT) {
+        uint32_t sequence = load32(source + position);
+        uint32_t hash = (sequence * 2654435761u) >> (32 - HASH_BITS);
+        size_t candidate = table[hash];
+        table[hash] = static_cast<uint32_t>(position);
+        if (candidate >= position || position - candidate > 0xFFFF || load32(source + candidate) != sequence) {
+            position += 1 + ((position - anchor) >> 6);
+            continue;
+        }
+        size_t end = position + MIN_MATCH;
+        while (end < size - LAST_LITERALS && source[end] == source[candidate + end - position]) {
+            end++;
+        }
+        while (position > anchor && candidate > 0 && source[position - 1] == source[candidate - 1]) {
+            position--;
+            candidate--;
+        }
+        out = putSequence(out, source + anchor, position - anchor, position - candidate, end - position);
+        position = anchor = end;
+    }
+    out = putSequence(out, source + anchor, size - anchor, 0, 0);
+    return out - destination;
+}
+
+bool decompressBlock(const uint8_t* source, size_t size, uint8_t* destination, size_t capacity) {
+    const uint8_t* in = source;
+    const uint8_t* inEnd = source + size;
+    uint8_t* out = destination;
+    uint8_t* outEnd = destination + capacity;
+    auto readLength = [&](size_t& length) {
+        for (uint8_t byte = 255; byte == 255; length += byte) {
+            if (in == inEnd) {
+                return false;
+            }
+            byte = *in++;
+        }
+        return true;
+    };
+
+    while (in < inEnd) {
+        uint8_t token = *in++;
+        size_t literalCount = token >> 4;
+        if ((literalCount == 15 && !readLength(literalCount)) || literalCount > size_t(inEnd - in) ||
+            literalCount > size_t(outEnd - out)) {
+            return false;
+        }
+        std::memcpy(out, in, literalCount);
+        in += literalCount;
+        out += literalCount;
+        if (in == inEnd) {
+            break;
+        }
+
+        if (inEnd - in < 2) {
+            return false;
+        }
+        size_t offset = get(in, 2);
+        in += 2;
+        size_t length = token & 0xF;
+        if (offset == 0 || offset > size_t(out - destination) || (length == 15 && !readLength(length))) {
+            return false;
+        }
+        length += MIN_MATCH;
+        if (length > size_t(outEnd - out)) {
+            return false;
+        }
+        const uint8_t* match = out - offset;
+        if (offset >= length) {
+            std::memcpy(out, match, length);
+            out += length;
+        } else {
+            // Overlapping, so repeating the last offset bytes.
+            for (size_t i = 0; i < length; i++) {
+                *out++ = match[i];
+            }
+        }
+    }
+    return out == outEnd;
+}
+
+bool isPlainRam(const Page& page) {
+    return page.data && !(page.flags & (PAGE_READ_ONLY | PAGE_WRITE_TRAP));
+}
+
+}
+
+SaveState::SaveState()
+    : stored(nullptr), storedSize(0), image(nullptr), mapping(nullptr), mappingSize(0) {}
+
+SaveState::~SaveState() {
+    release();
+}
+
+void SaveState::release() {
+#ifdef SAVESTATE_MMAP
+    if (mapping) {
+        munmap(mapping, mappingSize);
+    }
+#endif
+    mapping = nullptr;
+    mappingSize = 0;
+    stored = nullptr;
+    storedSize = 0;
+    image = nullptr;
+}
+
+bool SaveState::fail(const std::string& message) {
+    error = message;
+    return false;
+}
+
+// Each device is saved once, under the first page it handles or traps.
+void SaveState::capture(CPU& cpu, bool compress) {
+    release();
+    error.clear();
+    Bus& bus = cpu.getBus();
+
+    std::vector<uint8_t> devices;
+    std::vector<const Device*> seen;
+    for (int page = 0; page < 256; page++) {
+        const Device* device = bus.getPage(page).device;
+        if (!device || std::find(seen.begin(), seen.end(), device) != seen.end()) {
+            continue;
+        }
+        seen.push_back(device);
+        size_t record = devices.size();
+        devices.resize(record + 5);
+        device->saveState(devices);
+        devices[record] = static_cast<uint8_t>(page);
+        put(&devices[record + 1], devices.size() - record - 5, 4);
+    }
+
+    size_t rawSize = MEMORY_OFFSET + MEMORY_SIZE + devices.size();
+    expanded.assign(rawSize, 0);
+    uint8_t* header = expanded.data();
+    for (int page = 0; page < 256; page++) {
+        if (const uint8_t* data = bus.getPage(page).data) {
+            std::memcpy(header + MEMORY_OFFSET + page * 256, data, 256);
+        }
+    }
+    std::copy(devices.begin(), devices.end(), header + MEMORY_OFFSET + MEMORY_SIZE);
+
+    CpuRegisters registers = cpu.getRegisters();
+    std::memcpy(header, MAGIC, sizeof(MAGIC));
+    put(header + VERSION_FIELD, VERSION, 2);
+    put(header + RAW_SIZE_FIELD, rawSize, 4);
+    put(header + MEMORY_OFFSET_FIELD, MEMORY_OFFSET, 4);
+    put(header + DEVICE_OFFSET_FIELD, MEMORY_OFFSET + MEMORY_SIZE, 4);
+    put(header + DEVICE_SIZE_FIELD, devices.size(), 4);
+    put(header + PC_FIELD, registers.PC, 2);
+    header[A_FIELD] = registers.A;
+    header[X_FIELD] = registers.X;
+    header[Y_FIELD] = registers.Y;
+    header[SP_FIELD] = registers.SP;
+    header[P_FIELD] = registers.P;
+    header[VARIANT_FIELD] = static_cast<uint8_t>(cpu.getVariant());
+    put(header + CYCLES_FIELD, registers.cycles, 8);
+    put(header + PENDING_FIELD, registers.pendingInterrupts, 4);
+    header[NMI_FIELD] = registers.nmiLine;
+
+    if (compress) {
+        buffer.resize(HEADER_SIZE + compressBound(rawSize - HEADER_SIZE));
+        std::memcpy(buffer.data(), header, HEADER_SIZE);
+        size_t compressed = compressBlock(header + HEADER_SIZE, rawSize - HEADER_SIZE, buffer.data() + HEADER_SIZE);
+        buffer.resize(HEADER_SIZE + compressed);
+        stored = buffer.data();
+        storedSize = buffer.size();
+        put(stored + FLAGS_FIELD, SAVE_STATE_COMPRESSED, 2);
+    } else {
+        buffer.clear();
+        stored = header;
+        storedSize = rawSize;
+    }
+    image = header;
+    put(stored + STORED_SIZE_FIELD, storedSize - HEADER_SIZE, 4);
+    put(stored + CHECKSUM_FIELD, crc32(stored + CHECKSUM_FIELD + 4, storedSize - CHECKED_FROM), 4);
+}
+
+bool SaveState::save(const std::string& path) const {
+    if (!stored) {
+        return false;
+    }
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(stored), storedSize);
+    return file.good();
+}
+
+bool SaveState::load(const std::string& path) {
+    release();
+    error.clear();
+#ifdef SAVESTATE_MMAP
+    // Privately and writable, so attached pages take the program's writes
+    // without them reaching the file.
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        struct stat info;
+        void* address = MAP_FAILED;
+        if (fstat(fd, &info) == 0 && info.st_size >= static_cast<off_t>(HEADER_SIZE)) {
+            address = mmap(nullptr, info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        }
+        ::close(fd);
+        if (address != MAP_FAILED) {
+            mapping = address;
+            mappingSize = info.st_size;
+            stored = static_cast<uint8_t*>(address);
+            storedSize = mappingSize;
+            return validate();
+        }
+    }
+#endif
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return fail("cannot open " + path);
+    }
+    buffer.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+    stored = buffer.data();
+    storedSize = buffer.size();
+    return validate();
+}
+
+bool SaveState::load(const uint8_t* data, size_t size) {
+    release();
+    error.clear();
+    buffer.assign(data, data + size);
+    stored = buffer.data();
+    storedSize = size;
+    return validate();
+}
+
+bool SaveState::validate() {
+    if (storedSize < HEADER_SIZE || std::memcmp(stored, MAGIC, sizeof(MAGIC)) != 0) {
+        return fail("not a save state");
+    }
+    uint16_t version = static_cast<uint16_t>(get(stored + VERSION_FIELD, 2));
+    if (version != VERSION) {
+        return fail("unsupported save state version " + std::to_string(version));
+    }
+    if (get(stored + STORED_SIZE_FIELD, 4) != storedSize - HEADER_SIZE) {
+        return fail("save state is truncated");
+    }
+    if (crc32(stored + CHECKSUM_FIELD + 4, storedSize - CHECKED_FROM) != get(stored + CHECKSUM_FIELD, 4)) {
+        return fail("save state checksum mismatch");
+    }
+
+    size_t rawSize = get(stored + RAW_SIZE_FIELD, 4);
+    size_t memoryOffset = get(stored + MEMORY_OFFSET_FIELD, 4);
+    size_t deviceOffset = get(stored + DEVICE_OFFSET_FIELD, 4);
+    size_t deviceSize = get(stored + DEVICE_SIZE_FIELD, 4);
+    if (memoryOffset < HEADER_SIZE || memoryOffset + MEMORY_SIZE > rawSize || deviceOffset < HEADER_SIZE ||
+        deviceOffset + deviceSize > rawSize) {
+        return fail("save state layout is corrupt");
+    }
+
+    if (get(stored + FLAGS_FIELD, 2) & SAVE_STATE_COMPRESSED) {
+        expanded.resize(rawSize);
+        std::memcpy(expanded.data(), stored, HEADER_SIZE);
+        if (!decompressBlock(stored + HEADER_SIZE, storedSize - HEADER_SIZE, expanded.data() + HEADER_SIZE,
+                             rawSize - HEADER_SIZE)) {
+            return fail("save state does not decompress");
+        }
+        image = expanded.data();
+    } else if (rawSize != storedSize) {
+        return fail("save state is truncated");
+    } else {
+        image = stored;
+    }
+    return true;
+}
+
+bool SaveState::restoreDevices(CPU& cpu) {
+    Bus& bus = cpu.getBus();
+    const uint8_t* record = image + get(image + DEVICE_OFFSET_FIELD, 4);
+    const uint8_t* end = record + get(image + DEVICE_SIZE_FIELD, 4);
+    while (record < end) {
+        if (end - record < 5 || get(record + 1, 4) > size_t(end - record - 5)) {
+            return fail("save state device records are corrupt");
+        }
+        size_t length = get(record + 1, 4);
+        Device* device = bus.getPage(record[0]).device;
+        if (!device || !device->loadState(record + 5, length)) {
+            return fail("no device at page " + std::to_string(record[0]) + " takes the saved state");
+        }
+        record += 5 + length;
+    }
+    return true;
+}
+
+void SaveState::restoreRegisters(CPU& cpu) {
+    CpuRegisters registers;
+    registers.PC = static_cast<uint16_t>(get(image + PC_FIELD, 2));
+    registers.A = image[A_FIELD];
+    registers.X = image[X_FIELD];
+    registers.Y = image[Y_FIELD];
+    registers.SP = image[SP_FIELD];
+    registers.P = image[P_FIELD];
+    registers.cycles = get(image + CYCLES_FIELD, 8);
+    registers.pendingInterrupts = static_cast<uint32_t>(get(image + PENDING_FIELD, 4));
+    registers.nmiLine = image[NMI_FIELD] != 0;
+    cpu.setRegisters(registers);
+}
+
+// Devices go first: a bank switch repoints pages, and the saved contents
+// belong in the banks the state selected, not the ones showing now.
+bool SaveState::restore(CPU& cpu) {
+    if (!image) {
+        return fail("no save state loaded");
+    }
+    if (image[VARIANT_FIELD] != static_cast<uint8_t>(cpu.getVariant())) {
+        return fail("save state is for another CPU variant");
+    }
+    if (!restoreDevices(cpu)) {
+        return false;
+    }
+    Bus& bus = cpu.getBus();
+    const uint8_t* pages = image + get(image + MEMORY_OFFSET_FIELD, 4);
+    for (int page = 0; page < 256; page++) {
+        const Page& entry = bus.getPage(page);
+        const uint8_t* saved = pages + page * 256;
+        if (isPlainRam(entry) && std::memcmp(entry.data, saved, 256) != 0) {
+            std::memcpy(entry.data, saved, 256);
+            bus.notifyRemap(page);
+        }
+    }
+    restoreRegisters(cpu);
+    return true;
+}
+
+// RAM a device maps, a bank window say, stays where the device put it and
+// is copied instead, so switching banks later keeps what was written; so
+// does RAM a MappedBus's map fixes.
+bool SaveState::attach(CPU& cpu) {
+    if (!image) {
+        return fail("no save state loaded");
+    }
+    if (image[VARIANT_FIELD] != static_cast<uint8_t>(cpu.getVariant())) {
+        return fail("save state is for another CPU variant");
+    }
+    if (!restoreDevices(cpu)) {
+        return false;
+    }
+    Bus& bus = cpu.getBus();
+    uint8_t* pages = image + get(image + MEMORY_OFFSET_FIELD, 4);
+    for (int page = 0; page < 256; page++) {
+        const Page& entry = bus.getPage(page);
+        if (!isPlainRam(entry)) {
+            continue;
+        }
+        if (!entry.device && bus.mapMemory(page, 1, pages + page * 256)) {
+            continue;
+        }
+        if (std::memcmp(entry.data, pages + page * 256, 256) != 0) {
+            std::memcpy(entry.data, pages + page * 256, 256);
+            bus.notifyRemap(page);
+        }
+    }
+    restoreRegisters(cpu);
+    return true;
+}
+
+const uint8_t* SaveState::getData() const {
+    return stored;
+}
+
+size_t SaveState::getSize() const {
+    return storedSize;
+}
+
+bool SaveState::isCompressed() const {
+    return stored && (get(stored + FLAGS_FIELD, 2) & SAVE_STATE_COMPRESSED);
+}
+
+const std::string& SaveState::getError() const {
+    return error;
+}
@@ -0,0 +1,85 @@
+#ifndef SAVESTATE_H
+#define SAVESTATE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "CPU.h"
+
+enum SaveStateFlags : uint16_t {
+    SAVE_STATE_COMPRESSED = 0x0001  // everything after the header is one LZ4 block
+};
+
+// A machine state in the save-state format, little-endian throughout:
+//
+//   0   "6502SAVE"
+//   8   u16 version, u16 flags
+//   12  u32 CRC-32 of every byte from offset 16 to the end of the file
+//   16  u32 size of the state uncompressed, u32 bytes stored after the header
+//   24  u32 memory offset, u32 device offset, u32 device bytes
+//   36  u16 PC, u8 A, X, Y, SP, P, CPU variant
+//   44  u64 cycles, u32 pending interrupts, u8 NMI line, padding to 64
+//   4096 the 256 pages as the bus saw them, device pages zeroed
+//   then one record per device: u8 first page, u32 length, its state
+//
+// The memory block sits on a host page boundary, so an uncompressed file
+// mapped privately can be attached page for page: attach() points the
+// bus's RAM pages into the mapping instead of copying anything. Compressed
+// files store the uncompressed layout after the header as a single LZ4
+// block, which mostly shrinks the free RAM.
+//
+// Restoring puts back what the machine's plain RAM pages hold, device
+// state and the registers; ROM pages and the page table stay as they are,
+// so the state must go back into a machine with the same memory map.
+class SaveState {
+private:
+    // A captured or read state, and the uncompressed image when the stored
+    // form is compressed.
+    std::vector<uint8_t> buffer;
+    std::vector<uint8_t> expanded;
+    // The state as stored, and its uncompressed image, in buffer, expanded
+    // or a mapping of the file.
+    uint8_t* stored;
+    size_t storedSize;
+    uint8_t* image;
+    void* mapping;
+    size_t mappingSize;
+    std::string error;
+
+    void release();
+    bool fail(const std::string& message);
+    bool validate();
+    bool restoreDevices(CPU& cpu);
+    void restoreRegisters(CPU& cpu);
+
+public:
+    static const uint16_t VERSION = 1;
+
+    SaveState();
+    ~SaveState();
+    SaveState(const SaveState&) = delete;
+    SaveState& operator=(const SaveState&) = delete;
+
+    // Between instructions only.
+    void capture(CPU& cpu, bool compress);
+    bool save(const std::string& path) const;
+    // Maps an uncompressed file where the host can, and reads the rest.
+    // The version and checksum are checked before anything else is used.
+    bool load(const std::string& path);
+    bool load(const uint8_t* data, size_t size);
+
+    // Copies the state into cpu's machine, leaving pages that already hold
+    // the saved contents, and code cached from them, alone.
+    bool restore(CPU& cpu);
+    // Like restore(), but maps the RAM pages onto the state itself, which
+    // must then outlive the attachment and not be loaded or captured over.
+    bool attach(CPU& cpu);
+
+    const uint8_t* getData() const;
+    size_t getSize() const;
+    bool isCompressed() const;
+    const std::string& getError() const;
+};
+
+#endif
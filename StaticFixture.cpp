@@ -0,0 +1,711 @@
+// Generated by the static recompiler (see Recompiler.h); do not edit.
+#include "Recompiler.h"
+#include "FusedHandlers.inl"
+
+namespace {
+
+uint64_t run(CPU& cpu, uint64_t budget, const uint8_t* modified, int32_t* loopJump) {
+    uint64_t executed = 0;
+dispatch:
+    switch (cpu.getPC()) {
+        case 0x0200: goto block_0200;
+        case 0x0205: goto block_0205;
+        case 0x0224: goto block_0224;
+        case 0x0239: goto block_0239;
+        case 0x023E: goto block_023e;
+        case 0x0258: goto block_0258;
+        case 0x025D: goto block_025d;
+        case 0x0261: goto block_0261;
+        case 0x0267: goto block_0267;
+        case 0x026A: goto block_026a;
+        case 0x026E: goto block_026e;
+        case 0x0272: goto block_0272;
+        case 0x0278: goto block_0278;
+        case 0x027B: goto block_027b;
+        case 0x0300: goto block_0300;
+        case 0x0306: goto block_0306;
+        case 0x030D: goto block_030d;
+        case 0x0314: goto block_0314;
+        case 0x0318: goto block_0318;
+        case 0x0320: goto block_0320;
+        case 0x0340: goto block_0340;
+        case 0x0349: goto block_0349;
+        case 0x034F: goto block_034f;
+        case 0x035C: goto block_035c;
+        case 0x0367: goto block_0367;
+        case 0x0400: goto block_0400;
+        case 0x0410: goto block_0410;
+        case 0x0500: goto block_0500;
+        default: return executed;
+    }
+block_0200:
+    if (budget - executed < 4 || modified[0x02] || cpu.isStopRequested() || cpu.canTakeInterrupt(cpu.getInterruptDisableFlag())) {
+        return executed;
+    }
+    predecodedHandler<0x78>(cpu, 0x0000);
+    predecodedHandler<0xD8>(cpu, 0x0000);
+    cpu.setPC(0x0204);
+    predecodedHandler<0xA2>(cpu, 0x00FF);
+    cpu.setPC(0x0205);
+    predecodedHandler<0x9A>(cpu, 0x0000);
+    cpu.addCycles(8);
+    executed += 4;
+    goto block_0205;
+block_0205:
+    if (budget - executed < 15 || modified[0x02] || cpu.isStopRequested() || cpu.canTakeInterrupt(cpu.getInterruptDisableFlag())) {
+        return executed;
+    }
+    cpu.setPC(0x0207);
+    predecodedHandler<0xA9>(cpu, 0x0000);
+    predecodedHandler<0x85>(cpu, 0x00F0);
+    if (modified[0x02] || cpu.isStopRequested()) {
+        cpu.setPC(0x0209);
+        cpu.addCycles(5);
+        return executed + 2;
+    }
+    cpu.setPC(0x020B);
+    predecodedHandler<0xA9>(cpu, 0x0003);
+    predecodedHandler<0x85>(cpu, 0x00F1);
+    if (modified[0x02] || cpu.isStopRequested()) {
+        cpu.setPC(0x020D);
+        cpu.addCycles(10);
+        return executed + 4;
+    }
+    cpu.setPC(0x020F);
+    predecodedHandler<0xA9>(cpu, 0x0000);
+    predecodedHandler<0x85>(cpu, 0x00F2);
+    if (modified[0x02] || cpu.isStopRequested()) {
+        cpu.setPC(0x0211);
+        cpu.addCycles(15);
+        return executed + 6;
+    }
+    predecodedHandler<0xA5>(cpu, 0x0010);
+    cpu.setPC(0x0215);
+    predecodedHandler<0x29>(cpu, 0x000F);
+    cpu.setPC(0x0217);
+    predecodedHandler<0x09>(cpu, 0x0010);
+    predecodedHandler<0x85>(cpu, 0x00F3);
+    if (modified[0x02] || cpu.isStopRequested()) {
+        cpu.setPC(0x0219);
+        cpu.addCycles(25);
+        return executed + 10;
+    }
+    predecodedHandler<0xA5>(cpu, 0x0010);
+    predecodedHandler<0x85>(cpu, 0x00F4);
+    if (modified[0x02] || cpu.isStopRequested()) {
+        cpu.setPC(0x021D);
+        cpu.addCycles(31);
+        return executed + 12;
+    }
+    cpu.setPC(0x021F);
+    predecodedHandler<0xA9>(cpu, 0x0000);
+    predecodedHandler<0x85>(cpu, 0x00F5);
+    if (modified[0x02] || cpu.isStopRequested()) {
+        cpu.setPC(0x0221);
+        cpu.addCycles(36);
+        return executed + 14;
+    }
+    cpu.setPC(0x0224);
+    predecodedHandler<0x20>(cpu, 0x0300);
+    cpu.addCycles(42);
+    executed += 15;
+    goto block_0300;
+block_0224:
+    if (budget - executed < 10 || modified[0x02] || cpu.isStopRequested() || cpu.canTakeInterrupt(cpu.getInterruptDisableFlag())) {
+        return executed;
+    }
+    predecodedHandler<0xA5>(cpu, 0x0010);
+    predecodedHandler<0x85>(cpu, 0x00F0);
+    if (modified[0x02] || cpu.isStopRequested()) {
+        cpu.setPC(0x0228);
+        cpu.addCycles(6);
+        return executed + 2;
+    }
+    cpu.setPC(0x022A);
+    predecodedHandler<0xA9>(cpu, 0x00A5);
+    predecodedHandler<0x85>(cpu, 0x00F1);
+    if (modified[0x02] || cpu.isStopRequested()) {
+        cpu.setPC(0x022C);
+        cpu.addCycles(11);
+        return executed + 4;
+    }
+    predecodedHandler<0xA5>(cpu, 0x00F4);
+    cpu.setPC(0x0230);
+    predecodedHandler<0x49>(cpu, 0x005A);
+    predecodedHandler<0x85>(cpu, 0x00F2);
+    if (modified[0x02] || cpu.isStopRequested()) {
+        cpu.setPC(0x0232);
+        cpu.addCycles(19);
+        return executed + 7;
+    }
+    cpu.setPC(0x0234);
+    predecodedHandler<0xA9>(cpu, 0x0003);
+    predecodedHandler<0x85>(cpu, 0x00F3);
+    if (modified[0x02] || cpu.isStopRequested()) {
+        cpu.setPC(0x0236);
+        cpu.addCycles(24);
+        return executed + 9;
+    }
+    cpu.setPC(0x0239);
+    predecodedHandler<0x20>(cpu, 0x0340);
+    cpu.addCycles(30);
+    executed += 10;
+    goto block_0340;
+block_0239:
+    if (budget - executed < 2 || modified[0x02] || cpu.isStopRequested() || cpu.canTakeInterrupt(cpu.getInterruptDisableFlag())) {
+        return executed;
+    }
+    predecodedHandler<0xA5>(cpu, 0x00F5);
+    cpu.setPC(0x023E);
+    predecodedHandler<0x20>(cpu, 0x0500);
+    cpu.addCycles(9);
+    executed += 2;
+    goto block_0500;
+block_023e:
+    if (budget - executed < 14 || modified[0x02] || cpu.isStopRequested() || cpu.canTakeInterrupt(cpu.getInterruptDisableFlag())) {
+        return executed;
+    }
+    predecodedHandler<0xF8>(cpu, 0x0000);
+    predecodedHandler<0x18>(cpu, 0x0000);
+    predecodedHandler<0x65>(cpu, 0x0010);
+    predecodedHandler<0xD8>(cpu, 0x0000);
+    predecodedHandler<0x85>(cpu, 0x0012);
+    if (modified[0x02] || cpu.isStopRequested()) {
+        cpu.setPC(0x0245);
+        cpu.addCycles(12);
+        return executed + 5;
+    }
+    predecodedHandler<0xA5>(cpu, 0x0010);
+    cpu.setPC(0x0249);
+    predecodedHandler<0x29>(cpu, 0x0001);
+    predecodedHandler<0x0A>(cpu, 0x0000);
+    predecodedHandler<0xAA>(cpu, 0x0000);
+    predecodedHandler<0xBD>(cpu, 0x027E);
+    predecodedHandler<0x85>(cpu, 0x0014);
+    if (modified[0x02] || cpu.isStopRequested()) {
+        cpu.setPC(0x0250);
+        cpu.addCycles(28);
+        return executed + 11;
+    }
+    predecodedHandler<0xBD>(cpu, 0x027F);
+    predecodedHandler<0x85>(cpu, 0x0015);
+    if (modified[0x02] || cpu.isStopRequested()) {
+        cpu.setPC(0x0255);
+        cpu.addCycles(35);
+        return executed + 13;
+    }
+    cpu.setPC(0x0258);
+    predecodedHandler<0x6C>(cpu, 0x0014);
+    cpu.addCycles(40);
+    executed += 14;
+    if (cpu.getPC() <= 0x0255) {
+        if (loopJump) {
+            *loopJump = 0x0255;
+            return executed;
+        }
+    }
+    goto dispatch;
+block_0258:
+    if (budget - executed < 2 || modified[0x02] || cpu.isStopRequested() || cpu.canTakeInterrupt(cpu.getInterruptDisableFlag())) {
+        return executed;
+    }
+    predecodedHandler<0xE6>(cpu, 0x0010);
+    if (modified[0x02] || cpu.isStopRequested()) {
+        cpu.setPC(0x025A);
+        cpu.addCycles(5);
+        return executed + 1;
+    }
+    cpu.setPC(0x025D);
+    predecodedHandler<0x4C>(cpu, 0x0261);
+    cpu.addCycles(8);
+    executed += 2;
+    goto block_0261;
+block_025d:
+    if (budget - executed < 2 || modified[0x02] || cpu.isStopRequested() || cpu.canTakeInterrupt(cpu.getInterruptDisableFlag())) {
+        return executed;
+    }
+    predecodedHandler<0xE6>(cpu, 0x0010);
+    if (modified[0x02] || cpu.isStopRequested()) {
+        cpu.setPC(0x025F);
+        cpu.addCycles(5);
+        return executed + 1;
+    }
+    cpu.setPC(0x0260);
+    predecodedHandler<0x00>(cpu, 0x0000);
+    cpu.addCycles(12);
+    executed += 2;
+    if (cpu.getPC() <= 0x025F) {
+        if (loopJump) {
+            *loopJump = 0x025F;
+            return executed;
+        }
+    }
+    goto dispatch;
+block_0261:
+    if (budget - executed < 3 || modified[0x02] || cpu.isStopRequested() || cpu.canTakeInterrupt(cpu.getInterruptDisableFlag())) {
+        return executed;
+    }
+    predecodedHandler<0xA5>(cpu, 0x0010);
+    cpu.setPC(0x0265);
+    predecodedHandler<0x29>(cpu, 0x0007);
+    cpu.setPC(0x0267);
+    predecodedHandler<0xF0>(cpu, 0x0003);
+    cpu.addCycles(7);
+    executed += 3;
+    if (cpu.getPC() == 0x026A) {
+        goto block_026a;
+    }
+    if (cpu.getPC() == 0x0267) {
+        goto block_0267;
+    }
+    goto dispatch;
+block_0267:
+    if (budget - executed < 1 || modified[0x02] || cpu.isStopRequested() || cpu.canTakeInterrupt(cpu.getInterruptDisableFlag())) {
+        return executed;
+    }
+    cpu.setPC(0x026A);
+    predecodedHandler<0x4C>(cpu, 0x0205);
+    cpu.addCycles(3);
+    executed += 1;
+    if (loopJump) {
+        *loopJump = 0x0267;
+        return executed;
+    }
+    goto block_0205;
+block_026a:
+    if (budget - executed < 2 || modified[0x02] || cpu.isStopRequested() || cpu.canTakeInterrupt(cpu.getInterruptDisableFlag())) {
+        return executed;
+    }
+    cpu.setPC(0x026C);
+    predecodedHandler<0xA9>(cpu, 0x0000);
+    cpu.setPC(0x026E);
+    predecodedHandler<0x85>(cpu, 0x0011);
+    cpu.addCycles(5);
+    executed += 2;
+    goto block_026e;
+block_026e:
+    if (budget - executed < 2 || modified[0x02] || cpu.isStopRequested() || cpu.canTakeInterrupt(cpu.getInterruptDisableFlag())) {
+        return executed;
+    }
+    predecodedHandler<0xA5>(cpu, 0x0011);
+    cpu.setPC(0x0272);
+    predecodedHandler<0xF0>(cpu, 0x00FC);
+    cpu.addCycles(5);
+    executed += 2;
+    if (cpu.getPC() == 0x026E) {
+        if (loopJump) {
+            *loopJump = 0x0270;
+            return executed;
+        }
+        goto block_026e;
+    }
+    if (cpu.getPC() == 0x0272) {
+        goto block_0272;
+    }
+    goto dispatch;
+block_0272:
+    if (budget - executed < 3 || modified[0x02] || cpu.isStopRequested() || cpu.canTakeInterrupt(cpu.getInterruptDisableFlag())) {
+        return executed;
+    }
+    predecodedHandler<0xA5>(cpu, 0x0010);
+    cpu.setPC(0x0276);
+    predecodedHandler<0xC9>(cpu, 0x0040);
+    cpu.setPC(0x0278);
+    predecodedHandler<0xF0>(cpu, 0x0003);
+    cpu.addCycles(7);
+    executed += 3;
+    if (cpu.getPC() == 0x027B) {
+        goto block_027b;
+    }
+    if (cpu.getPC() == 0x0278) {
+        goto block_0278;
+    }
+    goto dispatch;
+block_0278:
+    if (budget - executed < 1 || modified[0x02] || cpu.isStopRequested() || cpu.canTakeInterrupt(cpu.getInterruptDisableFlag())) {
+        return executed;
+    }
+    cpu.setPC(0x027B);
+    predecodedHandler<0x4C>(cpu, 0x0205);
+    cpu.addCycles(3);
+    executed += 1;
+    if (loopJump) {
+        *loopJump = 0x0278;
+        return executed;
+    }
+    goto block_0205;
+block_027b:
+    if (budget - executed < 1 || modified[0x02] || cpu.isStopRequested() || cpu.canTakeInterrupt(cpu.getInterruptDisableFlag())) {
+        return executed;
+    }
+    cpu.setPC(0x027E);
+    predecodedHandler<0x4C>(cpu, 0x027B);
+    cpu.addCycles(3);
+    executed += 1;
+    if (loopJump) {
+        *loopJump = 0x027B;
+        return executed;
+    }
+    goto block_027b;
+block_0300:
+    if (budget - executed < 3 || modified[0x03] || cpu.isStopRequested() || cpu.canTakeInterrupt(cpu.getInterruptDisableFlag())) {
+        return executed;
+    }
+    cpu.setPC(0x0302);
+    predecodedHandler<0xA0>(cpu, 0x0000);
+    predecodedHandler<0xA6>(cpu, 0x00F5);
+    cpu.setPC(0x0306);
+    predecodedHandler<0xF0>(cpu, 0x000E);
+    cpu.addCycles(7);
+    executed += 3;
+    if (cpu.getPC() == 0x0314) {
+        goto block_0314;
+    }
+    if (cpu.getPC() == 0x0306) {
+        goto block_0306;
+    }
+    goto dispatch;
+block_0306:
+    if (budget - executed < 4 || modified[0x03] || cpu.isStopRequested() || cpu.canTakeInterrupt(cpu.getInterruptDisableFlag())) {
+        return executed;
+    }
+    predecodedHandler<0xB1>(cpu, 0x00F0);
+    predecodedHandler<0x91>(cpu, 0x00F2);
+    if (modified[0x03] || cpu.isStopRequested()) {
+        cpu.setPC(0x030A);
+        cpu.addCycles(11);
+        return executed + 2;
+    }
+    predecodedHandler<0xC8>(cpu, 0x0000);
+    cpu.setPC(0x030D);
+    predecodedHandler<0xD0>(cpu, 0x00F9);
+    cpu.addCycles(15);
+    executed += 4;
+    if (cpu.getPC() == 0x0306) {
+        if (loopJump) {
+            *loopJump = 0x030B;
+            return executed;
+        }
+        goto block_0306;
+    }
+    if (cpu.getPC() == 0x030D) {
+        goto block_030d;
+    }
+    goto dispatch;
+block_030d:
+    if (budget - executed < 4 || modified[0x03] || cpu.isStopRequested() || cpu.canTakeInterrupt(cpu.getInterruptDisableFlag())) {
+        return executed;
+    }
+    predecodedHandler<0xE6>(cpu, 0x00F1);
+    if (modified[0x03] || cpu.isStopRequested()) {
+        cpu.setPC(0x030F);
+        cpu.addCycles(5);
+        return executed + 1;
+    }
+    predecodedHandler<0xE6>(cpu, 0x00F3);
+    if (modified[0x03] || cpu.isStopRequested()) {
+        cpu.setPC(0x0311);
+        cpu.addCycles(10);
+        return executed + 2;
+    }
+    predecodedHandler<0xCA>(cpu, 0x0000);
+    cpu.setPC(0x0314);
+    predecodedHandler<0xD0>(cpu, 0x00F2);
+    cpu.addCycles(14);
+    executed += 4;
+    if (cpu.getPC() == 0x0306) {
+        if (loopJump) {
+            *loopJump = 0x0312;
+            return executed;
+        }
+        goto block_0306;
+    }
+    if (cpu.getPC() == 0x0314) {
+        goto block_0314;
+    }
+    goto dispatch;
+block_0314:
+    if (budget - executed < 2 || modified[0x03] || cpu.isStopRequested() || cpu.canTakeInterrupt(cpu.getInterruptDisableFlag())) {
+        return executed;
+    }
+    predecodedHandler<0xA6>(cpu, 0x00F4);
+    cpu.setPC(0x0318);
+    predecodedHandler<0xF0>(cpu, 0x0008);
+    cpu.addCycles(5);
+    executed += 2;
+    if (cpu.getPC() == 0x0320) {
+        goto block_0320;
+    }
+    if (cpu.getPC() == 0x0318) {
+        goto block_0318;
+    }
+    goto dispatch;
+block_0318:
+    if (budget - executed < 5 || modified[0x03] || cpu.isStopRequested() || cpu.canTakeInterrupt(cpu.getInterruptDisableFlag())) {
+        return executed;
+    }
+    predecodedHandler<0xB1>(cpu, 0x00F0);
+    predecodedHandler<0x91>(cpu, 0x00F2);
+    if (modified[0x03] || cpu.isStopRequested()) {
+        cpu.setPC(0x031C);
+        cpu.addCycles(11);
+        return executed + 2;
+    }
+    predecodedHandler<0xC8>(cpu, 0x0000);
+    predecodedHandler<0xCA>(cpu, 0x0000);
+    cpu.setPC(0x0320);
+    predecodedHandler<0xD0>(cpu, 0x00F8);
+    cpu.addCycles(17);
+    executed += 5;
+    if (cpu.getPC() == 0x0318) {
+        if (loopJump) {
+            *loopJump = 0x031E;
+            return executed;
+        }
+        goto block_0318;
+    }
+    if (cpu.getPC() == 0x0320) {
+        goto block_0320;
+    }
+    goto dispatch;
+block_0320:
+    if (budget - executed < 1 || modified[0x03] || cpu.isStopRequested() || cpu.canTakeInterrupt(cpu.getInterruptDisableFlag())) {
+        return executed;
+    }
+    cpu.setPC(0x0321);
+    predecodedHandler<0x60>(cpu, 0x0000);
+    cpu.addCycles(6);
+    executed += 1;
+    if (cpu.getPC() <= 0x0320) {
+        if (loopJump) {
+            *loopJump = 0x0320;
+            return executed;
+        }
+    }
+    goto dispatch;
+block_0340:
+    if (budget - executed < 5 || modified[0x03] || cpu.isStopRequested() || cpu.canTakeInterrupt(cpu.getInterruptDisableFlag())) {
+        return executed;
+    }
+    predecodedHandler<0xD8>(cpu, 0x0000);
+    cpu.setPC(0x0343);
+    predecodedHandler<0xA9>(cpu, 0x0000);
+    predecodedHandler<0x85>(cpu, 0x00F6);
+    if (modified[0x03] || cpu.isStopRequested()) {
+        cpu.setPC(0x0345);
+        cpu.addCycles(7);
+        return executed + 3;
+    }
+    predecodedHandler<0x85>(cpu, 0x00F7);
+    if (modified[0x03] || cpu.isStopRequested()) {
+        cpu.setPC(0x0347);
+        cpu.addCycles(10);
+        return executed + 4;
+    }
+    cpu.setPC(0x0349);
+    predecodedHandler<0xA2>(cpu, 0x0010);
+    cpu.addCycles(12);
+    executed += 5;
+    goto block_0349;
+block_0349:
+    if (budget - executed < 3 || modified[0x03] || cpu.isStopRequested() || cpu.canTakeInterrupt(cpu.getInterruptDisableFlag())) {
+        return executed;
+    }
+    predecodedHandler<0x46>(cpu, 0x00F3);
+    if (modified[0x03] || cpu.isStopRequested()) {
+        cpu.setPC(0x034B);
+        cpu.addCycles(5);
+        return executed + 1;
+    }
+    predecodedHandler<0x66>(cpu, 0x00F2);
+    if (modified[0x03] || cpu.isStopRequested()) {
+        cpu.setPC(0x034D);
+        cpu.addCycles(10);
+        return executed + 2;
+    }
+    cpu.setPC(0x034F);
+    predecodedHandler<0x90>(cpu, 0x000D);
+    cpu.addCycles(12);
+    executed += 3;
+    if (cpu.getPC() == 0x035C) {
+        goto block_035c;
+    }
+    if (cpu.getPC() == 0x034F) {
+        goto block_034f;
+    }
+    goto dispatch;
+block_034f:
+    if (budget - executed < 7 || modified[0x03] || cpu.isStopRequested() || cpu.canTakeInterrupt(cpu.getInterruptDisableFlag())) {
+        return executed;
+    }
+    predecodedHandler<0xA5>(cpu, 0x00F6);
+    predecodedHandler<0x18>(cpu, 0x0000);
+    predecodedHandler<0x65>(cpu, 0x00F0);
+    predecodedHandler<0x85>(cpu, 0x00F6);
+    if (modified[0x03] || cpu.isStopRequested()) {
+        cpu.setPC(0x0356);
+        cpu.addCycles(11);
+        return executed + 4;
+    }
+    predecodedHandler<0xA5>(cpu, 0x00F7);
+    predecodedHandler<0x65>(cpu, 0x00F1);
+    cpu.setPC(0x035C);
+    predecodedHandler<0x85>(cpu, 0x00F7);
+    cpu.addCycles(20);
+    executed += 7;
+    goto block_035c;
+block_035c:
+    if (budget - executed < 6 || modified[0x03] || cpu.isStopRequested() || cpu.canTakeInterrupt(cpu.getInterruptDisableFlag())) {
+        return executed;
+    }
+    predecodedHandler<0x66>(cpu, 0x00F7);
+    if (modified[0x03] || cpu.isStopRequested()) {
+        cpu.setPC(0x035E);
+        cpu.addCycles(5);
+        return executed + 1;
+    }
+    predecodedHandler<0x66>(cpu, 0x00F6);
+    if (modified[0x03] || cpu.isStopRequested()) {
+        cpu.setPC(0x0360);
+        cpu.addCycles(10);
+        return executed + 2;
+    }
+    predecodedHandler<0x66>(cpu, 0x00F5);
+    if (modified[0x03] || cpu.isStopRequested()) {
+        cpu.setPC(0x0362);
+        cpu.addCycles(15);
+        return executed + 3;
+    }
+    predecodedHandler<0x66>(cpu, 0x00F4);
+    if (modified[0x03] || cpu.isStopRequested()) {
+        cpu.setPC(0x0364);
+        cpu.addCycles(20);
+        return executed + 4;
+    }
+    predecodedHandler<0xCA>(cpu, 0x0000);
+    cpu.setPC(0x0367);
+    predecodedHandler<0xD0>(cpu, 0x00E2);
+    cpu.addCycles(24);
+    executed += 6;
+    if (cpu.getPC() == 0x0349) {
+        if (loopJump) {
+            *loopJump = 0x0365;
+            return executed;
+        }
+        goto block_0349;
+    }
+    if (cpu.getPC() == 0x0367) {
+        goto block_0367;
+    }
+    goto dispatch;
+block_0367:
+    if (budget - executed < 1 || modified[0x03] || cpu.isStopRequested() || cpu.canTakeInterrupt(cpu.getInterruptDisableFlag())) {
+        return executed;
+    }
+    cpu.setPC(0x0368);
+    predecodedHandler<0x60>(cpu, 0x0000);
+    cpu.addCycles(6);
+    executed += 1;
+    if (cpu.getPC() <= 0x0367) {
+        if (loopJump) {
+            *loopJump = 0x0367;
+            return executed;
+        }
+    }
+    goto dispatch;
+block_0400:
+    if (budget - executed < 2 || modified[0x04] || cpu.isStopRequested() || cpu.canTakeInterrupt(cpu.getInterruptDisableFlag())) {
+        return executed;
+    }
+    predecodedHandler<0xE6>(cpu, 0x0011);
+    if (modified[0x04] || cpu.isStopRequested()) {
+        cpu.setPC(0x0402);
+        cpu.addCycles(5);
+        return executed + 1;
+    }
+    cpu.setPC(0x0403);
+    predecodedHandler<0x40>(cpu, 0x0000);
+    cpu.addCycles(11);
+    executed += 2;
+    if (cpu.getPC() <= 0x0402) {
+        if (loopJump) {
+            *loopJump = 0x0402;
+            return executed;
+        }
+    }
+    goto dispatch;
+block_0410:
+    if (budget - executed < 1 || modified[0x04] || cpu.isStopRequested() || cpu.canTakeInterrupt(cpu.getInterruptDisableFlag())) {
+        return executed;
+    }
+    cpu.setPC(0x0411);
+    predecodedHandler<0x40>(cpu, 0x0000);
+    cpu.addCycles(6);
+    executed += 1;
+    if (cpu.getPC() <= 0x0410) {
+        if (loopJump) {
+            *loopJump = 0x0410;
+            return executed;
+        }
+    }
+    goto dispatch;
+block_0500:
+    if (budget - executed < 3 || modified[0x05] || cpu.isStopRequested() || cpu.canTakeInterrupt(cpu.getInterruptDisableFlag())) {
+        return executed;
+    }
+    predecodedHandler<0x8D>(cpu, 0x0504);
+    if (modified[0x05] || cpu.isStopRequested()) {
+        cpu.setPC(0x0503);
+        cpu.addCycles(4);
+        return executed + 1;
+    }
+    cpu.setPC(0x0505);
+    predecodedHandler<0xA9>(cpu, 0x0000);
+    cpu.setPC(0x0506);
+    predecodedHandler<0x60>(cpu, 0x0000);
+    cpu.addCycles(12);
+    executed += 3;
+    if (cpu.getPC() <= 0x0505) {
+        if (loopJump) {
+            *loopJump = 0x0505;
+            return executed;
+        }
+    }
+    goto dispatch;
+}
+
+const RecompiledBlock blocks[] = {
+    {0x0200, 5, 0x8EC9C8F4u},
+    {0x0205, 31, 0x8ECCC397u},
+    {0x0224, 21, 0x03C37CB5u},
+    {0x0239, 5, 0xB93078A6u},
+    {0x023E, 26, 0xBF3A02C2u},
+    {0x0258, 5, 0xB3D0510Au},
+    {0x025D, 3, 0x1C8BDBB1u},
+    {0x0261, 6, 0xD525A6DDu},
+    {0x0267, 3, 0xFCA65E38u},
+    {0x026A, 4, 0x0A69E50Eu},
+    {0x026E, 4, 0xA528324Fu},
+    {0x0272, 6, 0x7A41FDE0u},
+    {0x0278, 3, 0xFCA65E38u},
+    {0x027B, 3, 0x0CFAA676u},
+    {0x0300, 6, 0x67632B6Eu},
+    {0x0306, 7, 0x4916974Au},
+    {0x030D, 7, 0xF7423BB1u},
+    {0x0314, 4, 0x3DF13E97u},
+    {0x0318, 8, 0x081A5745u},
+    {0x0320, 1, 0xE50C2ABFu},
+    {0x0340, 9, 0x3573F10Fu},
+    {0x0349, 6, 0xE31262D5u},
+    {0x034F, 13, 0x25C47B2Au},
+    {0x035C, 11, 0x8392DF87u},
+    {0x0367, 1, 0xE50C2ABFu},
+    {0x0400, 3, 0x3689C608u},
+    {0x0410, 1, 0xC50BF85Fu},
+    {0x0500, 6, 0x9C14FD2Eu},
+};
+
+}
+
+extern const RecompiledProgram staticFixtureProgram;
+const RecompiledProgram staticFixtureProgram = {"Static engine fixture", blocks, 28, &run};
@@ -0,0 +1,234 @@
+#include "Superinstructions.h"
+#include "BlockCache.h"
+#include "FusedHandlers.inl"
+#include <algorithm>
+#include <array>
+#include <utility>
+
+namespace {
+
+// Flags set by the instruction at index that a later instruction of the
+// sequence overwrites before anything reads them. Flags still live at the
+// end of the sequence are always kept, since the code after it may look.
+template <std::size_t N>
+constexpr uint8_t deadFlags(const std::array<uint8_t, N>& opcodes, std::size_t index) {
+    uint8_t pending = flagsWritten(opcodeTable[opcodes[index]].operation);
+    uint8_t dead = 0;
+    for (std::size_t i = index + 1; i < N; i++) {
+        OperationType next = opcodeTable[opcodes[i]].operation;
+        pending &= ~flagsRead(next);
+        dead |= pending & flagsWritten(next);
+        pending &= ~flagsWritten(next);
+    }
+    return dead;
+}
+
+template <uint8_t Opcode, uint8_t DeadFlags>
+inline void step(CPU& cpu, const DecodedInstruction& instruction) {
+    constexpr OpcodeInfo info = opcodeTable[Opcode];
+
+    cpu.setPC(instruction.nextPC);
+    if constexpr (WithoutFlags<info.operation>::available && (flagsWritten(info.operation) & ~DeadFlags) == 0) {
+        WithoutFlags<info.operation>::apply(cpu, predecodedAddress<Opcode>(cpu, instruction.operand));
+    } else {
+        predecodedHandler<Opcode>(cpu, instruction.operand);
+    }
+}
+
+template <std::size_t N>
+constexpr bool fusable(const std::array<uint8_t, N>& opcodes) {
+    for (std::size_t i = 0; i < N; i++) {
+        const OpcodeInfo& info = opcodeTable[opcodes[i]];
+        if (!info.valid) {
+            return false;
+        }
+        if (i + 1 < N && (changesControlFlow(info.operation) || writesMemory(info))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <uint8_t... Opcodes>
+struct Sequence {
+    static constexpr std::array<uint8_t, sizeof...(Opcodes)> opcodes{{Opcodes...}};
+
+    static_assert(sizeof...(Opcodes) >= 2 && sizeof...(Opcodes) <= 3, "superinstructions fuse two or three opcodes");
+    static_assert(fusable(opcodes), "only the last opcode of a superinstruction may store or branch");
+
+    template <std::size_t... Index>
+    static void run(CPU& cpu, const DecodedInstruction* instructions, std::index_sequence<Index...>) {
+        (step<opcodes[Index], deadFlags(opcodes, Index)>(cpu, instructions[Index]), ...);
+    }
+
+    static void handler(CPU& cpu, const DecodedInstruction* instructions) {
+        run(cpu, instructions, std::make_index_sequence<sizeof...(Opcodes)>());
+    }
+};
+
+template <uint8_t... Opcodes>
+Superinstruction fuse(const char* name) {
+    return Superinstruction{name, sizeof...(Opcodes), {Opcodes...}, &Sequence<Opcodes...>::handler};
+}
+
+bool matches(const Superinstruction& superinstruction, uint8_t first, uint8_t second, uint8_t third) {
+    return superinstruction.opcodes[0] == first && superinstruction.opcodes[1] == second &&
+           (superinstruction.length == 2 || superinstruction.opcodes[2] == third);
+}
+
+}
+
+const std::vector<Superinstruction> superinstructions = {
+    // Counted loops
+    fuse<0xC8, 0xC0, 0xD0>("INY; CPY #; BNE"),
+    fuse<0xE8, 0xE0, 0xD0>("INX; CPX #; BNE"),
+    fuse<0xCA, 0xD0>("DEX; BNE"),
+    fuse<0x88, 0xD0>("DEY; BNE"),
+    fuse<0xE8, 0xD0>("INX; BNE"),
+    fuse<0xC8, 0xD0>("INY; BNE"),
+    fuse<0xCA, 0x10>("DEX; BPL"),
+    fuse<0x88, 0x10>("DEY; BPL"),
+    fuse<0xC8, 0xC0>("INY; CPY #"),
+    fuse<0xE8, 0xE0>("INX; CPX #"),
+
+    // Compare and branch
+    fuse<0xC9, 0xF0>("CMP #; BEQ"),
+    fuse<0xC9, 0xD0>("CMP #; BNE"),
+    fuse<0xC9, 0x90>("CMP #; BCC"),
+    fuse<0xC9, 0xB0>("CMP #; BCS"),
+    fuse<0xC5, 0xD0>("CMP zp; BNE"),
+    fuse<0xC5, 0xF0>("CMP zp; BEQ"),
+    fuse<0xE0, 0xD0>("CPX #; BNE"),
+    fuse<0xE0, 0xF0>("CPX #; BEQ"),
+    fuse<0xC0, 0xD0>("CPY #; BNE"),
+    fuse<0xC0, 0xF0>("CPY #; BEQ"),
+
+    // Test and branch
+    fuse<0xA5, 0xD0>("LDA zp; BNE"),
+    fuse<0xA5, 0xF0>("LDA zp; BEQ"),
+    fuse<0xAD, 0xD0>("LDA abs; BNE"),
+    fuse<0xAD, 0xF0>("LDA abs; BEQ"),
+    fuse<0x29, 0xD0>("AND #; BNE"),
+    fuse<0x29, 0xF0>("AND #; BEQ"),
+    fuse<0x24, 0x10>("BIT zp; BPL"),
+    fuse<0x24, 0x30>("BIT zp; BMI"),
+    fuse<0x2C, 0x10>("BIT abs; BPL"),
+    fuse<0x2C, 0x30>("BIT abs; BMI"),
+
+    // Moves
+    fuse<0xA5, 0x85>("LDA zp; STA zp"),
+    fuse<0xA5, 0x8D>("LDA zp; STA abs"),
+    fuse<0xAD, 0x85>("LDA abs; STA zp"),
+    fuse<0xAD, 0x8D>("LDA abs; STA abs"),
+    fuse<0xA9, 0x85>("LDA #; STA zp"),
+    fuse<0xA9, 0x8D>("LDA #; STA abs"),
+    fuse<0xBD, 0x9D>("LDA abs,X; STA abs,X"),
+    fuse<0xB9, 0x99>("LDA abs,Y; STA abs,Y"),
+    fuse<0xB1, 0x91>("LDA (zp),Y; STA (zp),Y"),
+
+    // Arithmetic
+    fuse<0x18, 0x69>("CLC; ADC #"),
+    fuse<0x18, 0x65>("CLC; ADC zp"),
+    fuse<0x38, 0xE9>("SEC; SBC #"),
+    fuse<0x38, 0xE5>("SEC; SBC zp"),
+    fuse<0x69, 0x85>("ADC #; STA zp"),
+    fuse<0x69, 0x9D>("ADC #; STA abs,X"),
+    fuse<0xBD, 0x18>("LDA abs,X; CLC"),
+    fuse<0xA5, 0x18>("LDA zp; CLC"),
+    fuse<0x0A, 0x0A>("ASL A; ASL A"),
+    fuse<0x4A, 0x4A>("LSR A; LSR A"),
+
+    // Register shuffles
+    fuse<0x8A, 0x48>("TXA; PHA"),
+    fuse<0x98, 0x48>("TYA; PHA"),
+    fuse<0x68, 0xAA>("PLA; TAX"),
+    fuse<0x68, 0xA8>("PLA; TAY"),
+};
+
+SuperinstructionProfile::SuperinstructionProfile()
+    : pairCounts(0x10000, 0), sequenceCounts(superinstructions.size(), 0), instructions(0) {}
+
+void SuperinstructionProfile::collect(CPU& cpu, uint64_t count) {
+    // Only instructions that fall through to their neighbour can be fused,
+    // so a control-flow instruction ends the current run.
+    uint8_t run[2] = {0, 0};
+    int runLength = 0;
+
+    for (uint64_t i = 0; i < count; i++) {
+        uint8_t opcode = cpu.read(cpu.getPC());
+        cpu.execute();
+        instructions++;
+
+        if (runLength >= 1) {
+            pairCounts[(run[1] << 8) | opcode]++;
+        }
+        if (runLength >= 2) {
+            for (size_t index = 0; index < superinstructions.size(); index++) {
+                const Superinstruction& superinstruction = superinstructions[index];
+                if (superinstruction.length == 3 && matches(superinstruction, run[0], run[1], opcode)) {
+                    sequenceCounts[index]++;
+                }
+            }
+        }
+
+        const OpcodeInfo& info = opcodeTable[opcode];
+        if (!info.valid || changesControlFlow(info.operation)) {
+            runLength = 0;
+        } else {
+            run[0] = run[1];
+            run[1] = opcode;
+            runLength = std::min(runLength + 1, 2);
+        }
+    }
+}
+
+uint64_t SuperinstructionProfile::getPairCount(uint8_t first, uint8_t second) const {
+    return pairCounts[(first << 8) | second];
+}
+
+uint64_t SuperinstructionProfile::getSequenceCount(size_t index) const {
+    const Superinstruction& superinstruction = superinstructions[index];
+    if (superinstruction.length == 2) {
+        return getPairCount(superinstruction.opcodes[0], superinstruction.opcodes[1]);
+    }
+    return sequenceCounts[index];
+}
+
+std::vector<uint16_t> SuperinstructionProfile::select(double minimumShare) const {
+    std::vector<uint16_t> selected;
+    for (size_t index = 0; index < superinstructions.size(); index++) {
+        uint64_t covered = getSequenceCount(index) * superinstructions[index].length;
+        if (covered > 0 && covered >= minimumShare * instructions) {
+            selected.push_back(index);
+        }
+    }
+    std::sort(selected.begin(), selected.end(), [this](uint16_t a, uint16_t b) {
+        return getSequenceCount(a) * (superinstructions[a].length - 1) > getSequenceCount(b) * (superinstructions[b].length - 1);
+    });
+    return selected;
+}
+
+void SuperinstructionProfile::print(size_t topPairs) const {
+    std::vector<uint16_t> pairs;
+    for (uint32_t pair = 0; pair < pairCounts.size(); pair++) {
+        if (pairCounts[pair]) {
+            pairs.push_back(pair);
+        }
+    }
+    size_t shown = std::min(topPairs, pairs.size());
+    std::partial_sort(pairs.begin(), pairs.begin() + shown, pairs.end(), [this](uint16_t a, uint16_t b) {
+        return pairCounts[a] > pairCounts[b];
+    });
+
+    std::cout << std::dec << "Most frequent opcode pairs over " << instructions << " instructions:" << std::endl;
+    for (size_t i = 0; i < shown; i++) {
+        uint16_t pair = pairs[i];
+        std::cout << "  " << std::hex << (pair >> 8) << " " << (pair & 0xFF) << std::dec << ": " << pairCounts[pair];
+        for (const Superinstruction& superinstruction : superinstructions) {
+            if (superinstruction.length == 2 && matches(superinstruction, pair >> 8, pair & 0xFF, 0)) {
+                std::cout << " (" << superinstruction.name << ")";
+            }
+        }
+        std::cout << std::endl;
+    }
+}
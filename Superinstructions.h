@@ -0,0 +1,53 @@
+#ifndef SUPERINSTRUCTIONS_H
+#define SUPERINSTRUCTIONS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class CPU;
+struct DecodedInstruction;
+
+// Runs a whole fused sequence, starting at its first decoded instruction.
+// Each step sets PC past its own instruction, as predecoded handlers expect.
+typedef void (*SuperinstructionHandler)(CPU& cpu, const DecodedInstruction* instructions);
+
+// A run of adjacent opcodes executed as one dispatch. Only the last opcode
+// may store to memory or change control flow, so a block can never be
+// invalidated or left half way through a superinstruction.
+struct Superinstruction {
+    const char* name;
+    uint8_t length;
+    uint8_t opcodes[3];
+    SuperinstructionHandler handler;
+};
+
+// Every sequence with a fused implementation. Which of them are used is
+// decided per run from a SuperinstructionProfile.
+extern const std::vector<Superinstruction> superinstructions;
+
+// Counts adjacent opcode pairs (and the catalogue's longer sequences) as
+// they execute, to pick the superinstructions worth enabling.
+class SuperinstructionProfile {
+private:
+    std::vector<uint64_t> pairCounts;
+    std::vector<uint64_t> sequenceCounts;
+    uint64_t instructions;
+
+public:
+    SuperinstructionProfile();
+
+    // Steps the CPU count instructions, recording every adjacent sequence.
+    void collect(CPU& cpu, uint64_t count);
+
+    uint64_t getPairCount(uint8_t first, uint8_t second) const;
+    uint64_t getSequenceCount(size_t index) const;
+
+    // Catalogue indices of the sequences that covered at least
+    // minimumShare of the profiled instructions, most frequent first.
+    std::vector<uint16_t> select(double minimumShare) const;
+
+    void print(size_t topPairs) const;
+};
+
+#endif
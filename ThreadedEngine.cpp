@@ -0,0 +1,1069 @@
+#include "ThreadedEngine.h"
+#include "CPU.h"
+#include "MemoryMap.h"
+#include <iostream>
+
+// GCC and Clang support labels as values, which lets every handler jump
+// straight to the next one through its own indirect branch. Other compilers
+// get the same handlers laid out as a switch.
+#if defined(__GNUC__) || defined(__clang__)
+#define THREADED_COMPUTED_GOTO 1
+#endif
+
+void ThreadedEngine::run(CPU& cpu, uint64_t maxInstructions) {
+    if (maxInstructions > 0) {
+        dispatch<false>(cpu, maxInstructions, nullptr);
+    }
+}
+
+RunResult ThreadedEngine::run(CPU& cpu, uint64_t maxInstructions, StopMonitor& monitor) {
+    return dispatch<true>(cpu, maxInstructions, &monitor);
+}
+
+template <bool Checked>
+RunResult ThreadedEngine::dispatch(CPU& cpu, uint64_t maxInstructions, StopMonitor* monitor) {
+    Bus& bus = cpu.getBus();
+    switch (bus.getMachineMap()) {
+        case MachineMap::FlatRam:
+            return execute<Checked>(cpu, static_cast<MappedBus<FlatRamMap>&>(bus), maxInstructions, monitor);
+        case MachineMap::MonitorRom:
+            return execute<Checked>(cpu, static_cast<MappedBus<MonitorRomMap>&>(bus), maxInstructions, monitor);
+        default:
+            return execute<Checked>(cpu, bus, maxInstructions, monitor);
+    }
+}
+
+template <bool Checked, typename BusType>
+RunResult ThreadedEngine::execute(CPU& cpu, BusType& bus, uint64_t maxInstructions, StopMonitor* monitor) {
+
+    // The whole register file lives in locals for the duration of the run and
+    // is only written back to the CPU on exit.
+    uint8_t A = cpu.getAccumulator();
+    uint8_t X = cpu.getX();
+    uint8_t Y = cpu.getY();
+    uint8_t SP = cpu.getSP();
+    uint16_t PC = cpu.getPC();
+    uint8_t P = cpu.getStatusRegister() & (FLAG_I | FLAG_D | FLAG_B | FLAG_U);
+    bool C = cpu.getCarryFlag();
+    bool Z = cpu.getZeroFlag();
+    bool V = cpu.getOverflowFlag();
+    bool N = cpu.getNegativeFlag();
+    uint64_t cycles = cpu.getCycles();
+    const AluTables& alu = cpu.getAluTables();
+
+    uint64_t remaining = maxInstructions;
+    StopReason reason = StopReason::Budget;
+    uint16_t instructionPC = PC;
+    const uint8_t* breakpoints = Checked ? monitor->getBreakpointMap() : nullptr;
+    const bool stopOnHalt = Checked && monitor->stopsOnHalt();
+    const IdleAction idleAction = Checked ? monitor->getIdleAction() : IdleAction::Ignore;
+    const uint64_t deadline = Checked ? monitor->getCycleDeadline() : StopConditions::NO_DEADLINE;
+    uint32_t loopLength;
+    uint8_t opcode;
+    uint16_t ea;
+    uint8_t value;
+    unsigned result;
+    bool carry;
+
+#define READ(address) bus.readMemory(address)
+#define WRITE(address, data) bus.writeMemory(address, data)
+#define FETCH() READ(PC++)
+#define PUSH(data) do { WRITE(0x0100 | SP, data); SP--; } while (0)
+#define PULL() READ(0x0100 | ++SP)
+#define SET_NZ(data) do { Z = (data) == 0; N = ((data) & 0x80) != 0; } while (0)
+#define COMPARE(reg) do { value = READ(ea); result = static_cast<uint16_t>(reg - value); C = reg >= value; Z = result == 0; N = (result & 0x80) != 0; } while (0)
+#define ARITHMETIC(table) do { value = READ(ea); const AluResult& r = table[(P & FLAG_D) != 0][aluIndex(C, A, value)]; A = r.value; C = r.flags & FLAG_C; Z = r.flags & FLAG_Z; V = r.flags & FLAG_V; N = r.flags & FLAG_N; } while (0)
+#define STATUS() static_cast<uint8_t>(P | C | (Z << 1) | (V << 6) | (N << 7))
+// Indexes ea for a read, charging a cycle when that crosses a page.
+#define INDEX_READ(reg) do { cycles += ((ea & 0xFF) + reg) >> 8; ea += reg; } while (0)
+#define TAKE_BRANCH() do { cycles += 1 + (((PC ^ ea) >> 8) != 0); PC = ea; } while (0)
+#define UNPACK_STATUS(status) do { value = status; P = value & (FLAG_I | FLAG_D | FLAG_B | FLAG_U); C = value & 0x01; Z = value & 0x02; V = value & 0x40; N = value & 0x80; } while (0)
+
+// Same order as CPU::runChecked(). Compiles to nothing for unchecked runs.
+#define CHECK_STOP() \
+    do { \
+        if (Checked) { \
+            if (cpu.isStopRequested()) { reason = StopReason::WriteTrigger; goto done; } \
+            if (stopOnHalt && PC == instructionPC) { reason = StopReason::Halt; goto done; } \
+            if (cycles >= deadline) { reason = StopReason::CycleDeadline; goto done; } \
+            if (idleAction != IdleAction::Ignore && PC <= instructionPC && \
+                (loopLength = monitor->checkIdle(instructionPC, PC, LoopState{A, X, Y, SP, STATUS()}, cycles))) { \
+                if (idleAction == IdleAction::Stop) { reason = StopReason::Idle; goto done; } \
+                remaining = monitor->fastForward(remaining, loopLength, cycles); \
+            } \
+            if (breakpoints[PC]) { reason = StopReason::Breakpoint; goto done; } \
+            instructionPC = PC; \
+        } \
+    } while (0)
+
+// One load of the pending word per dispatch; the registers only go back to
+// the CPU when an interrupt is actually taken.
+#define POLL_INTERRUPTS() do { if (cpu.hasPendingInterrupts() && cpu.canTakeInterrupt(P & FLAG_I)) goto interrupt; } while (0)
+
+#ifdef THREADED_COMPUTED_GOTO
+    static void* const labels[256] = {
+        &&op_00, &&op_01, &&op_invalid, &&op_invalid, &&op_invalid, &&op_05, &&op_06, &&op_invalid, &&op_08, &&op_09, &&op_0A, &&op_invalid, &&op_invalid, &&op_0D, &&op_0E, &&op_invalid,
+        &&op_10, &&op_11, &&op_invalid, &&op_invalid, &&op_invalid, &&op_15, &&op_16, &&op_invalid, &&op_18, &&op_19, &&op_invalid, &&op_invalid, &&op_invalid, &&op_1D, &&op_1E, &&op_invalid,
+        &&op_20, &&op_21, &&op_invalid, &&op_invalid, &&op_24, &&op_25, &&op_26, &&op_invalid, &&op_28, &&op_29, &&op_2A, &&op_invalid, &&op_2C, &&op_2D, &&op_2E, &&op_invalid,
+        &&op_30, &&op_31, &&op_invalid, &&op_invalid, &&op_invalid, &&op_35, &&op_36, &&op_invalid, &&op_38, &&op_39, &&op_invalid, &&op_invalid, &&op_invalid, &&op_3D, &&op_3E, &&op_invalid,
+        &&op_40, &&op_41, &&op_invalid, &&op_invalid, &&op_invalid, &&op_45, &&op_46, &&op_invalid, &&op_48, &&op_49, &&op_4A, &&op_invalid, &&op_4C, &&op_4D, &&op_4E, &&op_invalid,
+        &&op_50, &&op_51, &&op_invalid, &&op_invalid, &&op_invalid, &&op_55, &&op_56, &&op_invalid, &&op_58, &&op_59, &&op_invalid, &&op_invalid, &&op_invalid, &&op_5D, &&op_5E, &&op_invalid,
+        &&op_60, &&op_61, &&op_invalid, &&op_invalid, &&op_invalid, &&op_65, &&op_66, &&op_invalid, &&op_68, &&op_69, &&op_6A, &&op_invalid, &&op_6C, &&op_6D, &&op_6E, &&op_invalid,
+        &&op_70, &&op_71, &&op_invalid, &&op_invalid, &&op_invalid, &&op_75, &&op_76, &&op_invalid, &&op_78, &&op_79, &&op_invalid, &&op_invalid, &&op_invalid, &&op_7D, &&op_7E, &&op_invalid,
+        &&op_invalid, &&op_81, &&op_invalid, &&op_invalid, &&op_84, &&op_85, &&op_86, &&op_invalid, &&op_88, &&op_invalid, &&op_8A, &&op_invalid, &&op_8C, &&op_8D, &&op_8E, &&op_invalid,
+        &&op_90, &&op_91, &&op_invalid, &&op_invalid, &&op_94, &&op_95, &&op_96, &&op_invalid, &&op_98, &&op_99, &&op_9A, &&op_invalid, &&op_invalid, &&op_9D, &&op_invalid, &&op_invalid,
+        &&op_A0, &&op_A1, &&op_A2, &&op_invalid, &&op_A4, &&op_A5, &&op_A6, &&op_invalid, &&op_A8, &&op_A9, &&op_AA, &&op_invalid, &&op_AC, &&op_AD, &&op_AE, &&op_invalid,
+        &&op_B0, &&op_B1, &&op_invalid, &&op_invalid, &&op_B4, &&op_B5, &&op_B6, &&op_invalid, &&op_B8, &&op_B9, &&op_BA, &&op_invalid, &&op_BC, &&op_BD, &&op_BE, &&op_invalid,
+        &&op_C0, &&op_C1, &&op_invalid, &&op_invalid, &&op_C4, &&op_C5, &&op_C6, &&op_invalid, &&op_C8, &&op_C9, &&op_CA, &&op_invalid, &&op_CC, &&op_CD, &&op_CE, &&op_invalid,
+        &&op_D0, &&op_D1, &&op_invalid, &&op_invalid, &&op_invalid, &&op_D5, &&op_D6, &&op_invalid, &&op_D8, &&op_D9, &&op_invalid, &&op_invalid, &&op_invalid, &&op_DD, &&op_DE, &&op_invalid,
+        &&op_E0, &&op_E1, &&op_invalid, &&op_invalid, &&op_E4, &&op_E5, &&op_E6, &&op_invalid, &&op_E8, &&op_E9, &&op_EA, &&op_invalid, &&op_EC, &&op_ED, &&op_EE, &&op_invalid,
+        &&op_F0, &&op_F1, &&op_invalid, &&op_invalid, &&op_invalid, &&op_F5, &&op_F6, &&op_invalid, &&op_F8, &&op_F9, &&op_invalid, &&op_invalid, &&op_invalid, &&op_FD, &&op_FE, &&op_invalid,
+    };
+
+// Each handler charges its base cycles on entry, as a constant.
+#define OPCODE(hex) op_##hex: cycles += cycleTable[0x##hex];
+#define OPCODE_INVALID op_invalid: cycles += cycleTable[opcode];
+#define NEXT() do { --remaining; CHECK_STOP(); if (remaining == 0) goto done; POLL_INTERRUPTS(); opcode = FETCH(); goto *labels[opcode]; } while (0)
+#define DISPATCH() do { opcode = FETCH(); goto *labels[opcode]; } while (0)
+
+    POLL_INTERRUPTS();
+    DISPATCH();
+#else
+#define OPCODE(hex) case 0x##hex: cycles += cycleTable[0x##hex];
+#define OPCODE_INVALID default: cycles += cycleTable[opcode];
+#define NEXT() do { --remaining; CHECK_STOP(); if (remaining == 0) goto done; POLL_INTERRUPTS(); goto dispatch; } while (0)
+#define DISPATCH() goto dispatch
+
+    POLL_INTERRUPTS();
+dispatch:
+    opcode = FETCH();
+    switch (opcode) {
+#endif
+
+    OPCODE(00) // BRK
+        PUSH((PC + 1) >> 8);
+        PUSH((PC + 1) & 0xFF);
+        P |= FLAG_B | FLAG_U;
+        PUSH(STATUS());
+        P |= FLAG_I;
+        PC = READ(0xFFFE) | (READ(0xFFFF) << 8);
+        NEXT();
+    OPCODE(01) // ORA (zp,X)
+        ea = (FETCH() + X) & 0xFF;
+        value = READ(ea);
+        ea = value | (READ(ea + 1) << 8);
+        A |= READ(ea);
+        SET_NZ(A);
+        NEXT();
+    OPCODE(05) // ORA zp
+        ea = FETCH();
+        A |= READ(ea);
+        SET_NZ(A);
+        NEXT();
+    OPCODE(06) // ASL zp
+        ea = FETCH();
+        value = READ(ea);
+        C = (value & 0x80) != 0;
+        value <<= 1;
+        WRITE(ea, value);
+        SET_NZ(value);
+        NEXT();
+    OPCODE(08) // PHP
+        P |= FLAG_B | FLAG_U;
+        PUSH(STATUS());
+        NEXT();
+    OPCODE(09) // ORA #imm
+        ea = PC++;
+        A |= READ(ea);
+        SET_NZ(A);
+        NEXT();
+    OPCODE(0A) // ASL A
+        C = (A & 0x80) != 0;
+        A <<= 1;
+        SET_NZ(A);
+        NEXT();
+    OPCODE(0D) // ORA abs
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        A |= READ(ea);
+        SET_NZ(A);
+        NEXT();
+    OPCODE(0E) // ASL abs
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        value = READ(ea);
+        C = (value & 0x80) != 0;
+        value <<= 1;
+        WRITE(ea, value);
+        SET_NZ(value);
+        NEXT();
+    OPCODE(10) // BPL rel
+        value = FETCH();
+        ea = PC + static_cast<int8_t>(value);
+        if (!N) TAKE_BRANCH();
+        NEXT();
+    OPCODE(11) // ORA (zp),Y
+        ea = FETCH();
+        value = READ(ea);
+        ea = value | (READ(ea + 1) << 8);
+        INDEX_READ(Y);
+        A |= READ(ea);
+        SET_NZ(A);
+        NEXT();
+    OPCODE(15) // ORA zp,X
+        ea = (FETCH() + X) & 0xFF;
+        A |= READ(ea);
+        SET_NZ(A);
+        NEXT();
+    OPCODE(16) // ASL zp,X
+        ea = (FETCH() + X) & 0xFF;
+        value = READ(ea);
+        C = (value & 0x80) != 0;
+        value <<= 1;
+        WRITE(ea, value);
+        SET_NZ(value);
+        NEXT();
+    OPCODE(18) // CLC
+        C = false;
+        NEXT();
+    OPCODE(19) // ORA abs,Y
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        INDEX_READ(Y);
+        A |= READ(ea);
+        SET_NZ(A);
+        NEXT();
+    OPCODE(1D) // ORA abs,X
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        INDEX_READ(X);
+        A |= READ(ea);
+        SET_NZ(A);
+        NEXT();
+    OPCODE(1E) // ASL abs,X
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        ea += X;
+        value = READ(ea);
+        C = (value & 0x80) != 0;
+        value <<= 1;
+        WRITE(ea, value);
+        SET_NZ(value);
+        NEXT();
+    OPCODE(20) // JSR abs
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        PUSH((PC - 1) >> 8);
+        PUSH((PC - 1) & 0xFF);
+        PC = ea;
+        NEXT();
+    OPCODE(21) // AND (zp,X)
+        ea = (FETCH() + X) & 0xFF;
+        value = READ(ea);
+        ea = value | (READ(ea + 1) << 8);
+        A &= READ(ea);
+        SET_NZ(A);
+        NEXT();
+    OPCODE(24) // BIT zp
+        ea = FETCH();
+        value = READ(ea);
+        Z = (A & value) == 0;
+        N = (value & 0x80) != 0;
+        V = (value & 0x40) != 0;
+        NEXT();
+    OPCODE(25) // AND zp
+        ea = FETCH();
+        A &= READ(ea);
+        SET_NZ(A);
+        NEXT();
+    OPCODE(26) // ROL zp
+        ea = FETCH();
+        value = READ(ea);
+        carry = (value & 0x80) != 0;
+        value = (value << 1) | C;
+        WRITE(ea, value);
+        C = carry;
+        SET_NZ(value);
+        NEXT();
+    OPCODE(28) // PLP
+        UNPACK_STATUS(PULL());
+        P &= ~(FLAG_B | FLAG_U);
+        NEXT();
+    OPCODE(29) // AND #imm
+        ea = PC++;
+        A &= READ(ea);
+        SET_NZ(A);
+        NEXT();
+    OPCODE(2A) // ROL A
+        carry = (A & 0x80) != 0;
+        A = (A << 1) | C;
+        C = carry;
+        SET_NZ(A);
+        NEXT();
+    OPCODE(2C) // BIT abs
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        value = READ(ea);
+        Z = (A & value) == 0;
+        N = (value & 0x80) != 0;
+        V = (value & 0x40) != 0;
+        NEXT();
+    OPCODE(2D) // AND abs
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        A &= READ(ea);
+        SET_NZ(A);
+        NEXT();
+    OPCODE(2E) // ROL abs
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        value = READ(ea);
+        carry = (value & 0x80) != 0;
+        value = (value << 1) | C;
+        WRITE(ea, value);
+        C = carry;
+        SET_NZ(value);
+        NEXT();
+    OPCODE(30) // BMI rel
+        value = FETCH();
+        ea = PC + static_cast<int8_t>(value);
+        if (N) TAKE_BRANCH();
+        NEXT();
+    OPCODE(31) // AND (zp),Y
+        ea = FETCH();
+        value = READ(ea);
+        ea = value | (READ(ea + 1) << 8);
+        INDEX_READ(Y);
+        A &= READ(ea);
+        SET_NZ(A);
+        NEXT();
+    OPCODE(35) // AND zp,X
+        ea = (FETCH() + X) & 0xFF;
+        A &= READ(ea);
+        SET_NZ(A);
+        NEXT();
+    OPCODE(36) // ROL zp,X
+        ea = (FETCH() + X) & 0xFF;
+        value = READ(ea);
+        carry = (value & 0x80) != 0;
+        value = (value << 1) | C;
+        WRITE(ea, value);
+        C = carry;
+        SET_NZ(value);
+        NEXT();
+    OPCODE(38) // SEC
+        C = true;
+        NEXT();
+    OPCODE(39) // AND abs,Y
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        INDEX_READ(Y);
+        A &= READ(ea);
+        SET_NZ(A);
+        NEXT();
+    OPCODE(3D) // AND abs,X
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        INDEX_READ(X);
+        A &= READ(ea);
+        SET_NZ(A);
+        NEXT();
+    OPCODE(3E) // ROL abs,X
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        ea += X;
+        value = READ(ea);
+        carry = (value & 0x80) != 0;
+        value = (value << 1) | C;
+        WRITE(ea, value);
+        C = carry;
+        SET_NZ(value);
+        NEXT();
+    OPCODE(40) // RTI
+        UNPACK_STATUS(PULL());
+        ea = PULL();
+        ea |= PULL() << 8;
+        PC = ea;
+        NEXT();
+    OPCODE(41) // EOR (zp,X)
+        ea = (FETCH() + X) & 0xFF;
+        value = READ(ea);
+        ea = value | (READ(ea + 1) << 8);
+        A ^= READ(ea);
+        SET_NZ(A);
+        NEXT();
+    OPCODE(45) // EOR zp
+        ea = FETCH();
+        A ^= READ(ea);
+        SET_NZ(A);
+        NEXT();
+    OPCODE(46) // LSR zp
+        ea = FETCH();
+        value = READ(ea);
+        C = (value & 0x01) != 0;
+        value >>= 1;
+        WRITE(ea, value);
+        SET_NZ(value);
+        NEXT();
+    OPCODE(48) // PHA
+        PUSH(A);
+        NEXT();
+    OPCODE(49) // EOR #imm
+        ea = PC++;
+        A ^= READ(ea);
+        SET_NZ(A);
+        NEXT();
+    OPCODE(4A) // LSR A
+        C = (A & 0x01) != 0;
+        A >>= 1;
+        SET_NZ(A);
+        NEXT();
+    OPCODE(4C) // JMP abs
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        PC = ea;
+        NEXT();
+    OPCODE(4D) // EOR abs
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        A ^= READ(ea);
+        SET_NZ(A);
+        NEXT();
+    OPCODE(4E) // LSR abs
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        value = READ(ea);
+        C = (value & 0x01) != 0;
+        value >>= 1;
+        WRITE(ea, value);
+        SET_NZ(value);
+        NEXT();
+    OPCODE(50) // BVC rel
+        value = FETCH();
+        ea = PC + static_cast<int8_t>(value);
+        if (!V) TAKE_BRANCH();
+        NEXT();
+    OPCODE(51) // EOR (zp),Y
+        ea = FETCH();
+        value = READ(ea);
+        ea = value | (READ(ea + 1) << 8);
+        INDEX_READ(Y);
+        A ^= READ(ea);
+        SET_NZ(A);
+        NEXT();
+    OPCODE(55) // EOR zp,X
+        ea = (FETCH() + X) & 0xFF;
+        A ^= READ(ea);
+        SET_NZ(A);
+        NEXT();
+    OPCODE(56) // LSR zp,X
+        ea = (FETCH() + X) & 0xFF;
+        value = READ(ea);
+        C = (value & 0x01) != 0;
+        value >>= 1;
+        WRITE(ea, value);
+        SET_NZ(value);
+        NEXT();
+    OPCODE(58) // CLI
+        P &= ~FLAG_I;
+        NEXT();
+    OPCODE(59) // EOR abs,Y
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        INDEX_READ(Y);
+        A ^= READ(ea);
+        SET_NZ(A);
+        NEXT();
+    OPCODE(5D) // EOR abs,X
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        INDEX_READ(X);
+        A ^= READ(ea);
+        SET_NZ(A);
+        NEXT();
+    OPCODE(5E) // LSR abs,X
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        ea += X;
+        value = READ(ea);
+        C = (value & 0x01) != 0;
+        value >>= 1;
+        WRITE(ea, value);
+        SET_NZ(value);
+        NEXT();
+    OPCODE(60) // RTS
+        ea = PULL();
+        ea |= PULL() << 8;
+        PC = ea + 1;
+        NEXT();
+    OPCODE(61) // ADC (zp,X)
+        ea = (FETCH() + X) & 0xFF;
+        value = READ(ea);
+        ea = value | (READ(ea + 1) << 8);
+        ARITHMETIC(alu.adc);
+        NEXT();
+    OPCODE(65) // ADC zp
+        ea = FETCH();
+        ARITHMETIC(alu.adc);
+        NEXT();
+    OPCODE(66) // ROR zp
+        ea = FETCH();
+        value = READ(ea);
+        carry = (value & 0x01) != 0;
+        value = (C << 7) | (value >> 1);
+        WRITE(ea, value);
+        C = carry;
+        SET_NZ(value);
+        NEXT();
+    OPCODE(68) // PLA
+        A = PULL();
+        SET_NZ(A);
+        NEXT();
+    OPCODE(69) // ADC #imm
+        ea = PC++;
+        ARITHMETIC(alu.adc);
+        NEXT();
+    OPCODE(6A) // ROR A
+        carry = (A & 0x01) != 0;
+        A = (C << 7) | (A >> 1);
+        C = carry;
+        SET_NZ(A);
+        NEXT();
+    OPCODE(6C) // JMP (abs)
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        value = READ(ea);
+        ea = value | (READ((ea & 0xFF00) | ((ea + 1) & 0xFF)) << 8);  // no carry into the page
+        PC = ea;
+        NEXT();
+    OPCODE(6D) // ADC abs
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        ARITHMETIC(alu.adc);
+        NEXT();
+    OPCODE(6E) // ROR abs
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        value = READ(ea);
+        carry = (value & 0x01) != 0;
+        value = (C << 7) | (value >> 1);
+        WRITE(ea, value);
+        C = carry;
+        SET_NZ(value);
+        NEXT();
+    OPCODE(70) // BVS rel
+        value = FETCH();
+        ea = PC + static_cast<int8_t>(value);
+        if (V) TAKE_BRANCH();
+        NEXT();
+    OPCODE(71) // ADC (zp),Y
+        ea = FETCH();
+        value = READ(ea);
+        ea = value | (READ(ea + 1) << 8);
+        INDEX_READ(Y);
+        ARITHMETIC(alu.adc);
+        NEXT();
+    OPCODE(75) // ADC zp,X
+        ea = (FETCH() + X) & 0xFF;
+        ARITHMETIC(alu.adc);
+        NEXT();
+    OPCODE(76) // ROR zp,X
+        ea = (FETCH() + X) & 0xFF;
+        value = READ(ea);
+        carry = (value & 0x01) != 0;
+        value = (C << 7) | (value >> 1);
+        WRITE(ea, value);
+        C = carry;
+        SET_NZ(value);
+        NEXT();
+    OPCODE(78) // SEI
+        P |= FLAG_I;
+        NEXT();
+    OPCODE(79) // ADC abs,Y
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        INDEX_READ(Y);
+        ARITHMETIC(alu.adc);
+        NEXT();
+    OPCODE(7D) // ADC abs,X
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        INDEX_READ(X);
+        ARITHMETIC(alu.adc);
+        NEXT();
+    OPCODE(7E) // ROR abs,X
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        ea += X;
+        value = READ(ea);
+        carry = (value & 0x01) != 0;
+        value = (C << 7) | (value >> 1);
+        WRITE(ea, value);
+        C = carry;
+        SET_NZ(value);
+        NEXT();
+    OPCODE(81) // STA (zp,X)
+        ea = (FETCH() + X) & 0xFF;
+        value = READ(ea);
+        ea = value | (READ(ea + 1) << 8);
+        WRITE(ea, A);
+        NEXT();
+    OPCODE(84) // STY zp
+        ea = FETCH();
+        WRITE(ea, Y);
+        NEXT();
+    OPCODE(85) // STA zp
+        ea = FETCH();
+        WRITE(ea, A);
+        NEXT();
+    OPCODE(86) // STX zp
+        ea = FETCH();
+        WRITE(ea, X);
+        NEXT();
+    OPCODE(88) // DEY
+        Y--;
+        SET_NZ(Y);
+        NEXT();
+    OPCODE(8A) // TXA
+        A = X;
+        SET_NZ(A);
+        NEXT();
+    OPCODE(8C) // STY abs
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        WRITE(ea, Y);
+        NEXT();
+    OPCODE(8D) // STA abs
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        WRITE(ea, A);
+        NEXT();
+    OPCODE(8E) // STX abs
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        WRITE(ea, X);
+        NEXT();
+    OPCODE(90) // BCC rel
+        value = FETCH();
+        ea = PC + static_cast<int8_t>(value);
+        if (!C) TAKE_BRANCH();
+        NEXT();
+    OPCODE(91) // STA (zp),Y
+        ea = FETCH();
+        value = READ(ea);
+        ea = value | (READ(ea + 1) << 8);
+        ea += Y;
+        WRITE(ea, A);
+        NEXT();
+    OPCODE(94) // STY zp,X
+        ea = (FETCH() + X) & 0xFF;
+        WRITE(ea, Y);
+        NEXT();
+    OPCODE(95) // STA zp,X
+        ea = (FETCH() + X) & 0xFF;
+        WRITE(ea, A);
+        NEXT();
+    OPCODE(96) // STX zp,Y
+        ea = (FETCH() + Y) & 0xFF;
+        WRITE(ea, X);
+        NEXT();
+    OPCODE(98) // TYA
+        A = Y;
+        SET_NZ(A);
+        NEXT();
+    OPCODE(99) // STA abs,Y
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        ea += Y;
+        WRITE(ea, A);
+        NEXT();
+    OPCODE(9A) // TXS
+        SP = X;
+        NEXT();
+    OPCODE(9D) // STA abs,X
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        ea += X;
+        WRITE(ea, A);
+        NEXT();
+    OPCODE(A0) // LDY #imm
+        ea = PC++;
+        Y = READ(ea);
+        SET_NZ(Y);
+        NEXT();
+    OPCODE(A1) // LDA (zp,X)
+        ea = (FETCH() + X) & 0xFF;
+        value = READ(ea);
+        ea = value | (READ(ea + 1) << 8);
+        A = READ(ea);
+        SET_NZ(A);
+        NEXT();
+    OPCODE(A2) // LDX #imm
+        ea = PC++;
+        X = READ(ea);
+        SET_NZ(X);
+        NEXT();
+    OPCODE(A4) // LDY zp
+        ea = FETCH();
+        Y = READ(ea);
+        SET_NZ(Y);
+        NEXT();
+    OPCODE(A5) // LDA zp
+        ea = FETCH();
+        A = READ(ea);
+        SET_NZ(A);
+        NEXT();
+    OPCODE(A6) // LDX zp
+        ea = FETCH();
+        X = READ(ea);
+        SET_NZ(X);
+        NEXT();
+    OPCODE(A8) // TAY
+        Y = A;
+        SET_NZ(Y);
+        NEXT();
+    OPCODE(A9) // LDA #imm
+        ea = PC++;
+        A = READ(ea);
+        SET_NZ(A);
+        NEXT();
+    OPCODE(AA) // TAX
+        X = A;
+        SET_NZ(X);
+        NEXT();
+    OPCODE(AC) // LDY abs
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        Y = READ(ea);
+        SET_NZ(Y);
+        NEXT();
+    OPCODE(AD) // LDA abs
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        A = READ(ea);
+        SET_NZ(A);
+        NEXT();
+    OPCODE(AE) // LDX abs
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        X = READ(ea);
+        SET_NZ(X);
+        NEXT();
+    OPCODE(B0) // BCS rel
+        value = FETCH();
+        ea = PC + static_cast<int8_t>(value);
+        if (C) TAKE_BRANCH();
+        NEXT();
+    OPCODE(B1) // LDA (zp),Y
+        ea = FETCH();
+        value = READ(ea);
+        ea = value | (READ(ea + 1) << 8);
+        INDEX_READ(Y);
+        A = READ(ea);
+        SET_NZ(A);
+        NEXT();
+    OPCODE(B4) // LDY zp,X
+        ea = (FETCH() + X) & 0xFF;
+        Y = READ(ea);
+        SET_NZ(Y);
+        NEXT();
+    OPCODE(B5) // LDA zp,X
+        ea = (FETCH() + X) & 0xFF;
+        A = READ(ea);
+        SET_NZ(A);
+        NEXT();
+    OPCODE(B6) // LDX zp,Y
+        ea = (FETCH() + Y) & 0xFF;
+        X = READ(ea);
+        SET_NZ(X);
+        NEXT();
+    OPCODE(B8) // CLV
+        V = false;
+        NEXT();
+    OPCODE(B9) // LDA abs,Y
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        INDEX_READ(Y);
+        A = READ(ea);
+        SET_NZ(A);
+        NEXT();
+    OPCODE(BA) // TSX
+        X = SP;
+        SET_NZ(X);
+        NEXT();
+    OPCODE(BC) // LDY abs,X
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        INDEX_READ(X);
+        Y = READ(ea);
+        SET_NZ(Y);
+        NEXT();
+    OPCODE(BD) // LDA abs,X
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        INDEX_READ(X);
+        A = READ(ea);
+        SET_NZ(A);
+        NEXT();
+    OPCODE(BE) // LDX abs,Y
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        INDEX_READ(Y);
+        X = READ(ea);
+        SET_NZ(X);
+        NEXT();
+    OPCODE(C0) // CPY #imm
+        ea = PC++;
+        COMPARE(Y);
+        NEXT();
+    OPCODE(C1) // CMP (zp,X)
+        ea = (FETCH() + X) & 0xFF;
+        value = READ(ea);
+        ea = value | (READ(ea + 1) << 8);
+        COMPARE(A);
+        NEXT();
+    OPCODE(C4) // CPY zp
+        ea = FETCH();
+        COMPARE(Y);
+        NEXT();
+    OPCODE(C5) // CMP zp
+        ea = FETCH();
+        COMPARE(A);
+        NEXT();
+    OPCODE(C6) // DEC zp
+        ea = FETCH();
+        value = READ(ea) - 1;
+        WRITE(ea, value);
+        SET_NZ(value);
+        NEXT();
+    OPCODE(C8) // INY
+        Y++;
+        SET_NZ(Y);
+        NEXT();
+    OPCODE(C9) // CMP #imm
+        ea = PC++;
+        COMPARE(A);
+        NEXT();
+    OPCODE(CA) // DEX
+        X--;
+        SET_NZ(X);
+        NEXT();
+    OPCODE(CC) // CPY abs
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        COMPARE(Y);
+        NEXT();
+    OPCODE(CD) // CMP abs
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        COMPARE(A);
+        NEXT();
+    OPCODE(CE) // DEC abs
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        value = READ(ea) - 1;
+        WRITE(ea, value);
+        SET_NZ(value);
+        NEXT();
+    OPCODE(D0) // BNE rel
+        value = FETCH();
+        ea = PC + static_cast<int8_t>(value);
+        if (!Z) TAKE_BRANCH();
+        NEXT();
+    OPCODE(D1) // CMP (zp),Y
+        ea = FETCH();
+        value = READ(ea);
+        ea = value | (READ(ea + 1) << 8);
+        INDEX_READ(Y);
+        COMPARE(A);
+        NEXT();
+    OPCODE(D5) // CMP zp,X
+        ea = (FETCH() + X) & 0xFF;
+        COMPARE(A);
+        NEXT();
+    OPCODE(D6) // DEC zp,X
+        ea = (FETCH() + X) & 0xFF;
+        value = READ(ea) - 1;
+        WRITE(ea, value);
+        SET_NZ(value);
+        NEXT();
+    OPCODE(D8) // CLD
+        P &= ~FLAG_D;
+        NEXT();
+    OPCODE(D9) // CMP abs,Y
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        INDEX_READ(Y);
+        COMPARE(A);
+        NEXT();
+    OPCODE(DD) // CMP abs,X
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        INDEX_READ(X);
+        COMPARE(A);
+        NEXT();
+    OPCODE(DE) // DEC abs,X
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        ea += X;
+        value = READ(ea) - 1;
+        WRITE(ea, value);
+        SET_NZ(value);
+        NEXT();
+    OPCODE(E0) // CPX #imm
+        ea = PC++;
+        COMPARE(X);
+        NEXT();
+    OPCODE(E1) // SBC (zp,X)
+        ea = (FETCH() + X) & 0xFF;
+        value = READ(ea);
+        ea = value | (READ(ea + 1) << 8);
+        ARITHMETIC(alu.sbc);
+        NEXT();
+    OPCODE(E4) // CPX zp
+        ea = FETCH();
+        COMPARE(X);
+        NEXT();
+    OPCODE(E5) // SBC zp
+        ea = FETCH();
+        ARITHMETIC(alu.sbc);
+        NEXT();
+    OPCODE(E6) // INC zp
+        ea = FETCH();
+        value = READ(ea) + 1;
+        WRITE(ea, value);
+        SET_NZ(value);
+        NEXT();
+    OPCODE(E8) // INX
+        X++;
+        SET_NZ(X);
+        NEXT();
+    OPCODE(E9) // SBC #imm
+        ea = PC++;
+        ARITHMETIC(alu.sbc);
+        NEXT();
+    OPCODE(EA) // NOP
+        NEXT();
+    OPCODE(EC) // CPX abs
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        COMPARE(X);
+        NEXT();
+    OPCODE(ED) // SBC abs
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        ARITHMETIC(alu.sbc);
+        NEXT();
+    OPCODE(EE) // INC abs
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        value = READ(ea) + 1;
+        WRITE(ea, value);
+        SET_NZ(value);
+        NEXT();
+    OPCODE(F0) // BEQ rel
+        value = FETCH();
+        ea = PC + static_cast<int8_t>(value);
+        if (Z) TAKE_BRANCH();
+        NEXT();
+    OPCODE(F1) // SBC (zp),Y
+        ea = FETCH();
+        value = READ(ea);
+        ea = value | (READ(ea + 1) << 8);
+        INDEX_READ(Y);
+        ARITHMETIC(alu.sbc);
+        NEXT();
+    OPCODE(F5) // SBC zp,X
+        ea = (FETCH() + X) & 0xFF;
+        ARITHMETIC(alu.sbc);
+        NEXT();
+    OPCODE(F6) // INC zp,X
+        ea = (FETCH() + X) & 0xFF;
+        value = READ(ea) + 1;
+        WRITE(ea, value);
+        SET_NZ(value);
+        NEXT();
+    OPCODE(F8) // SED
+        P |= FLAG_D;
+        NEXT();
+    OPCODE(F9) // SBC abs,Y
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        INDEX_READ(Y);
+        ARITHMETIC(alu.sbc);
+        NEXT();
+    OPCODE(FD) // SBC abs,X
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        INDEX_READ(X);
+        ARITHMETIC(alu.sbc);
+        NEXT();
+    OPCODE(FE) // INC abs,X
+        ea = FETCH();
+        ea |= FETCH() << 8;
+        ea += X;
+        value = READ(ea) + 1;
+        WRITE(ea, value);
+        SET_NZ(value);
+        NEXT();
+    OPCODE_INVALID
+        std::cout << "Invalid opcode: " << std::hex << (int)opcode << std::dec << std::endl;
+        NEXT();
+
+#ifndef THREADED_COMPUTED_GOTO
+    }
+#endif
+
+interrupt:
+    cpu.setAccumulator(A);
+    cpu.setX(X);
+    cpu.setY(Y);
+    cpu.setSP(SP);
+    cpu.setPC(PC);
+    cpu.setStatusRegister(STATUS());
+    cpu.setCycles(cycles);
+    cpu.serviceInterrupts();
+    A = cpu.getAccumulator();
+    X = cpu.getX();
+    Y = cpu.getY();
+    SP = cpu.getSP();
+    PC = cpu.getPC();
+    UNPACK_STATUS(cpu.getStatusRegister());
+    cycles = cpu.getCycles();
+    instructionPC = PC;
+    DISPATCH();
+
+done:
+    cpu.setAccumulator(A);
+    cpu.setX(X);
+    cpu.setY(Y);
+    cpu.setSP(SP);
+    cpu.setPC(PC);
+    cpu.setStatusRegister(STATUS());
+    cpu.setCycles(cycles);
+
+    if (!Checked) {
+        return RunResult{StopReason::Budget, maxInstructions, PC, 0};
+    }
+    return monitor->finish(reason, maxInstructions - remaining,
+                           reason == StopReason::WriteTrigger ? monitor->getTriggerAddress() : PC);
+
+#undef READ
+#undef WRITE
+#undef FETCH
+#undef PUSH
+#undef PULL
+#undef SET_NZ
+#undef COMPARE
+#undef ARITHMETIC
+#undef STATUS
+#undef UNPACK_STATUS
+#undef INDEX_READ
+#undef TAKE_BRANCH
+#undef CHECK_STOP
+#undef POLL_INTERRUPTS
+#undef DISPATCH
+#undef OPCODE
+#undef OPCODE_INVALID
+#undef NEXT
+}
@@ -0,0 +1,29 @@
+#ifndef THREADEDENGINE_H
+#define THREADEDENGINE_H
+
+#include <cstdint>
+#include "RunControl.h"
+
+class CPU;
+
+// Direct-threaded interpreter core. Registers and flags are kept in locals for
+// the whole run and each opcode handler dispatches the next instruction itself,
+// so there is no central loop and no per-instruction call. Semantics mirror
+// Operation.inl exactly.
+class ThreadedEngine {
+private:
+    // BusType is Bus, or the MappedBus the CPU's bus was built as, so a
+    // fixed memory map decodes with constant range checks instead of the
+    // page table.
+    template <bool Checked, typename BusType>
+    static RunResult execute(CPU& cpu, BusType& bus, uint64_t maxInstructions, StopMonitor* monitor);
+    template <bool Checked>
+    static RunResult dispatch(CPU& cpu, uint64_t maxInstructions, StopMonitor* monitor);
+
+public:
+    static void run(CPU& cpu, uint64_t maxInstructions);
+    // The same core with CPU::run()'s stop checks compiled into every dispatch.
+    static RunResult run(CPU& cpu, uint64_t maxInstructions, StopMonitor& monitor);
+};
+
+#endif
@@ -0,0 +1,163 @@
+#include "TrapRoutines.h"
+#include "CPU.h"
+
+namespace {
+
+const uint8_t SOURCE = 0xF0;
+const uint8_t DESTINATION = 0xF2;
+const uint8_t COUNT = 0xF4;
+const uint8_t MULTIPLICAND = 0xF0;
+const uint8_t MULTIPLIER = 0xF2;
+const uint8_t PRODUCT = 0xF4;
+
+const uint8_t memcpyCode[] = {
+    0xA0, 0x00,         //        LDY #0
+    0xA6, 0xF5,         //        LDX COUNT+1
+    0xF0, 0x0E,         //        BEQ part
+    0xB1, 0xF0,         // page:  LDA (SOURCE),Y
+    0x91, 0xF2,         //        STA (DESTINATION),Y
+    0xC8,               //        INY
+    0xD0, 0xF9,         //        BNE page
+    0xE6, 0xF1,         //        INC SOURCE+1
+    0xE6, 0xF3,         //        INC DESTINATION+1
+    0xCA,               //        DEX
+    0xD0, 0xF2,         //        BNE page
+    0xA6, 0xF4,         // part:  LDX COUNT
+    0xF0, 0x08,         //        BEQ done
+    0xB1, 0xF0,         // tail:  LDA (SOURCE),Y
+    0x91, 0xF2,         //        STA (DESTINATION),Y
+    0xC8,               //        INY
+    0xCA,               //        DEX
+    0xD0, 0xF8,         //        BNE tail
+    0x60,               // done:  RTS
+};
+
+// Shift and add, one multiplier bit per pass from the lowest up. The
+// product's low half starts as whatever was there and is shifted out.
+const uint8_t multiplyCode[] = {
+    0xD8,               //        CLD
+    0xA9, 0x00,         //        LDA #0
+    0x85, 0xF6,         //        STA PRODUCT+2
+    0x85, 0xF7,         //        STA PRODUCT+3
+    0xA2, 0x10,         //        LDX #16
+    0x46, 0xF3,         // loop:  LSR MULTIPLIER+1
+    0x66, 0xF2,         //        ROR MULTIPLIER
+    0x90, 0x0D,         //        BCC shift
+    0xA5, 0xF6,         //        LDA PRODUCT+2
+    0x18,               //        CLC
+    0x65, 0xF0,         //        ADC MULTIPLICAND
+    0x85, 0xF6,         //        STA PRODUCT+2
+    0xA5, 0xF7,         //        LDA PRODUCT+3
+    0x65, 0xF1,         //        ADC MULTIPLICAND+1
+    0x85, 0xF7,         //        STA PRODUCT+3
+    0x66, 0xF7,         // shift: ROR PRODUCT+3
+    0x66, 0xF6,         //        ROR PRODUCT+2
+    0x66, 0xF5,         //        ROR PRODUCT+1
+    0x66, 0xF4,         //        ROR PRODUCT
+    0xCA,               //        DEX
+    0xD0, 0xE2,         //        BNE loop
+    0x60,               //        RTS
+};
+
+uint16_t readWord(CPU& cpu, uint8_t address) {
+    return cpu.read(address) | (cpu.read(address + 1) << 8);
+}
+
+// A whole page takes 4095 cycles plus one for each read that crosses into
+// the next page, which is as many as the source's low byte, and moving to
+// the next page 14 more (15 before another page). Each byte of the tail
+// takes 18, less one for the last branch, plus page crossings.
+void nativeMemcpy(CPU& cpu) {
+    uint16_t source = readWord(cpu, SOURCE);
+    uint16_t destination = readWord(cpu, DESTINATION);
+    uint16_t count = readWord(cpu, COUNT);
+    uint8_t pages = count >> 8;
+    uint8_t tail = count & 0xFF;
+    uint8_t sourceLow = source & 0xFF;
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint8_t value = cpu.read(static_cast<uint16_t>(source + i));
+        cpu.write(static_cast<uint16_t>(destination + i), value);
+        cpu.setAccumulator(value);
+    }
+    cpu.write(SOURCE + 1, static_cast<uint8_t>((source >> 8) + pages));
+    cpu.write(DESTINATION + 1, static_cast<uint8_t>((destination >> 8) + pages));
+    cpu.setX(0);
+    cpu.setY(tail);
+    cpu.setNZ(0);
+
+    uint32_t cycles = 2 + 3 + (pages ? 2 : 3) + 3 + (tail ? 2 : 3) + 6;
+    if (pages) {
+        cycles += pages * (4095 + sourceLow + 15) - 1;
+    }
+    if (tail) {
+        cycles += 18 * tail - 1 + (sourceLow + tail > 0x100 ? sourceLow + tail - 0x100 : 0);
+    }
+    cpu.addCycles(cycles);
+}
+
+// A pass takes 38 cycles, 57 when it adds, less one for the last branch.
+// The last add is at the highest multiplier bit, onto the partial product
+// of the bits below it shifted down to the top half, and leaves A and V.
+// The last bit shifted out of the product's low half is where the carry
+// comes from.
+void nativeMultiply(CPU& cpu) {
+    uint32_t multiplicand = readWord(cpu, MULTIPLICAND);
+    uint32_t multiplier = readWord(cpu, MULTIPLIER);
+    uint32_t product = multiplicand * multiplier;
+    bool carry = cpu.read(PRODUCT + 1) & 0x80;
+
+    uint32_t adds = 0;
+    int highest = -1;
+    for (int bit = 0; bit < 16; bit++) {
+        if (multiplier & (1u << bit)) {
+            adds++;
+            highest = bit;
+        }
+    }
+    uint8_t accumulator = 0;
+    if (highest >= 0) {
+        uint32_t top = (multiplicand * (multiplier & ((1u << highest) - 1))) >> highest;
+        uint32_t sum = top + multiplicand;
+        accumulator = static_cast<uint8_t>(sum >> 8);
+        uint8_t left = top >> 8;
+        uint8_t right = multiplicand >> 8;
+        cpu.setOverflowFlag(~(left ^ right) & (left ^ accumulator) & 0x80);
+    }
+
+    for (int i = 0; i < 4; i++) {
+        cpu.write(PRODUCT + i, static_cast<uint8_t>(product >> (8 * i)));
+    }
+    cpu.write(MULTIPLIER, 0);
+    cpu.write(MULTIPLIER + 1, 0);
+    cpu.setAccumulator(accumulator);
+    cpu.setX(0);
+    cpu.setNZ(0);
+    cpu.setCarryFlag(carry);
+    cpu.setDecimalFlag(false);
+    cpu.addCycles(12 + 16 * 38 + 19 * adds - 1 + 6);
+}
+
+}
+
+const TrapRoutine memcpyRoutine = {"memcpy", memcpyCode, sizeof(memcpyCode), &nativeMemcpy};
+const TrapRoutine multiplyRoutine = {"multiply", multiplyCode, sizeof(multiplyCode), &nativeMultiply};
+
+const TrapRoutine* findTrapRoutine(const std::string& name) {
+    for (const TrapRoutine* routine : {&memcpyRoutine, &multiplyRoutine}) {
+        if (name == routine->name) {
+            return routine;
+        }
+    }
+    return nullptr;
+}
+
+bool placeTrapRoutine(Bus& bus, uint16_t address, const TrapRoutine& routine) {
+    if ((address & 0xFF) + routine.length > 0x100) {
+        return false;
+    }
+    for (uint16_t i = 0; i < routine.length; i++) {
+        bus.writeMemory(address + i, routine.code[i]);
+    }
+    return true;
+}
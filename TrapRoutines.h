@@ -0,0 +1,37 @@
+#ifndef TRAPROUTINES_H
+#define TRAPROUTINES_H
+
+#include <cstdint>
+#include <string>
+#include "Bus.h"
+#include "Traps.h"
+
+// A 6502 subroutine shipped with the native routine that stands in for it.
+// Both take their arguments in zero page at $F0-$F7, and the 6502 code
+// only branches within itself, so it runs wherever it is placed.
+struct TrapRoutine {
+    const char* name;
+    const uint8_t* code;
+    uint16_t length;
+    NativeRoutine native;
+};
+
+// Copies the 16-bit count at $F4 bytes from ($F0) to ($F2), lowest address
+// first, so an overlapping copy upwards repeats the source as the 6502 code
+// does. Leaves $F1 and $F3 advanced by the whole pages copied, A holding
+// the last byte copied, X zero and Y the low byte of the count. Neither
+// range may overlap $F0-$F5 or the routine.
+extern const TrapRoutine memcpyRoutine;
+// Unsigned 16 x 16 bit multiply: $F4-$F7 = ($F0) * ($F2), low byte first.
+// Clears $F2-$F3 and the decimal flag, and leaves X zero.
+extern const TrapRoutine multiplyRoutine;
+
+// nullptr for an unknown name.
+const TrapRoutine* findTrapRoutine(const std::string& name);
+
+// Writes the routine's 6502 code at address through the bus. The native
+// routines charge the cycles of branches that stay on one page, so the
+// code must not cross a page boundary; returns false if it would.
+bool placeTrapRoutine(Bus& bus, uint16_t address, const TrapRoutine& routine);
+
+#endif
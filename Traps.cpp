@@ -0,0 +1,196 @@
+#include "Traps.h"
+#include "CPU.h"
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+// Everything a routine can change.
+struct MachineState {
+    uint8_t A;
+    uint8_t X;
+    uint8_t Y;
+    uint8_t SP;
+    uint8_t P;
+    uint16_t PC;
+    uint64_t cycles;
+    std::vector<uint8_t> memory;
+};
+
+// Memory as the bus maps it. Device pages are left as 0xFF rather than read,
+// which could disturb the device.
+MachineState capture(CPU& cpu) {
+    MachineState state{cpu.getAccumulator(), cpu.getX(), cpu.getY(), cpu.getSP(), cpu.getStatusRegister(),
+                       cpu.getPC(), cpu.getCycles(), std::vector<uint8_t>(0x10000, 0xFF)};
+    Bus& bus = cpu.getBus();
+    for (int page = 0; page < 256; page++) {
+        if (const uint8_t* data = bus.getPage(page).data) {
+            std::memcpy(&state.memory[page << 8], data, 256);
+        }
+    }
+    return state;
+}
+
+// Only pages that differ are written back, and engines caching code from
+// them hear about it.
+void restore(CPU& cpu, const MachineState& state) {
+    cpu.setAccumulator(state.A);
+    cpu.setX(state.X);
+    cpu.setY(state.Y);
+    cpu.setSP(state.SP);
+    cpu.setStatusRegister(state.P);
+    cpu.setPC(state.PC);
+    cpu.setCycles(state.cycles);
+    Bus& bus = cpu.getBus();
+    for (int page = 0; page < 256; page++) {
+        uint8_t* data = bus.getPage(page).data;
+        if (data && std::memcmp(data, &state.memory[page << 8], 256) != 0) {
+            std::memcpy(data, &state.memory[page << 8], 256);
+            bus.notifyRemap(page);
+        }
+    }
+}
+
+void reportMismatch(const Trap& trap, const char* what, uint64_t native, uint64_t guest) {
+    std::cout << "Trap " << trap.name << ": " << what << " differs, native " << std::hex << native
+              << ", 6502 " << guest << std::dec << std::endl;
+}
+
+// Reports the first difference. Stack bytes below the final SP are free
+// space, so what a routine left there does not count.
+bool matches(const Trap& trap, const MachineState& native, const MachineState& guest) {
+    const struct { const char* what; uint64_t native; uint64_t guest; } registers[] = {
+        {"A", native.A, guest.A}, {"X", native.X, guest.X}, {"Y", native.Y, guest.Y},
+        {"SP", native.SP, guest.SP}, {"P", native.P, guest.P}, {"PC", native.PC, guest.PC},
+        {"cycle count", native.cycles, guest.cycles},
+    };
+    for (const auto& reg : registers) {
+        if (reg.native != reg.guest) {
+            reportMismatch(trap, reg.what, reg.native, reg.guest);
+            return false;
+        }
+    }
+    for (uint32_t address = 0; address < 0x10000; address++) {
+        if (address >= 0x0100 && address <= (0x0100u | guest.SP)) {
+            continue;
+        }
+        if (native.memory[address] != guest.memory[address]) {
+            std::cout << "Trap " << trap.name << ": memory at " << std::hex << address << " differs, native "
+                      << (int)native.memory[address] << ", 6502 " << (int)guest.memory[address] << std::dec << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+TrapRegistry::TrapRegistry(Bus& bus) : bus(bus), verify(false), verifyLimit(0) {}
+
+// Patches the byte on the page the bus maps at address, so the engines
+// drop any code they cached from it.
+void TrapRegistry::patch(uint16_t address, uint8_t opcode) {
+    bus.getPage(address >> 8).data[address & 0xFF] = opcode;
+    bus.notifyRemap(address >> 8);
+}
+
+bool TrapRegistry::install(uint16_t address, const std::string& name, NativeRoutine routine) {
+    const Page& page = bus.getPage(address >> 8);
+    if (traps.count(address) || !page.data || (page.flags & PAGE_READ_ONLY)) {
+        return false;
+    }
+    traps[address] = Trap{name, routine, page.data[address & 0xFF], 0, 0};
+    patch(address, TRAP_OPCODE);
+    return true;
+}
+
+void TrapRegistry::remove(uint16_t address) {
+    auto it = traps.find(address);
+    if (it == traps.end()) {
+        return;
+    }
+    if (bus.getPage(address >> 8).data) {
+        patch(address, it->second.originalOpcode);
+    }
+    traps.erase(it);
+}
+
+const Trap* TrapRegistry::find(uint16_t address) const {
+    auto it = traps.find(address);
+    return it == traps.end() ? nullptr : &it->second;
+}
+
+void TrapRegistry::setVerify(bool enabled, uint64_t maxInstructions) {
+    verify = enabled;
+    verifyLimit = maxInstructions;
+}
+
+void TrapRegistry::execute(CPU& cpu) {
+    uint16_t address = cpu.getPC() - 1;
+    auto it = traps.find(address);
+    if (it == traps.end()) {
+        cpu.executeOpcode(TRAP_OPCODE);
+        return;
+    }
+    if (verify) {
+        runVerified(cpu, address, it->second);
+    } else {
+        runNative(cpu, it->second);
+    }
+}
+
+void TrapRegistry::runNative(CPU& cpu, Trap& trap) {
+    trap.routine(cpu);
+    cpu.setPC(cpu.pullPC() + 1);
+    trap.calls++;
+}
+
+// Runs the native routine, then rewinds and runs the guest's code until it
+// returns to its caller. The byte under the trap runs in its place each
+// time the guest reaches it, so loops and recursion back to the entry point
+// stay in the guest's code.
+void TrapRegistry::runVerified(CPU& cpu, uint16_t address, Trap& trap) {
+    cpu.setPC(address);
+    MachineState start = capture(cpu);
+    runNative(cpu, trap);
+    MachineState native = capture(cpu);
+    restore(cpu, start);
+
+    uint8_t returnSP = start.SP + 2;
+    uint16_t returnPC = (start.memory[0x0100 | static_cast<uint8_t>(start.SP + 1)] |
+                         (start.memory[0x0100 | returnSP] << 8)) + 1;
+    cpu.setPC(address + 1);
+    cpu.executeOpcode(trap.originalOpcode);
+    uint64_t executed = 1;
+    while ((cpu.getSP() != returnSP || cpu.getPC() != returnPC) && executed < verifyLimit) {
+        if (cpu.getPC() == address) {
+            cpu.setPC(address + 1);
+            cpu.executeOpcode(trap.originalOpcode);
+        } else {
+            cpu.execute();
+        }
+        executed++;
+    }
+    if (cpu.getSP() != returnSP || cpu.getPC() != returnPC) {
+        std::cout << "Trap " << trap.name << ": the 6502 routine did not return within " << verifyLimit
+                  << " instructions" << std::endl;
+        trap.mismatches++;
+        return;
+    }
+    if (!matches(trap, native, capture(cpu))) {
+        trap.mismatches++;
+    }
+}
+
+void TrapRegistry::printStats() const {
+    std::cout << std::dec;
+    for (const auto& entry : traps) {
+        const Trap& trap = entry.second;
+        std::cout << "Trap " << trap.name << " at " << std::hex << entry.first << std::dec << ": " << trap.calls << " calls";
+        if (verify) {
+            std::cout << ", " << trap.mismatches << " mismatches";
+        }
+        std::cout << std::endl;
+    }
+}
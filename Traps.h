@@ -0,0 +1,76 @@
+#ifndef TRAPS_H
+#define TRAPS_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include "Bus.h"
+
+class CPU;
+
+// Native implementation of a guest subroutine. It runs in place of the
+// routine, with the machine as the JSR left it, and must have every effect
+// the 6502 code has up to its RTS: memory, A, X, Y, the flags and the cycles
+// the routine takes, RTS included. Pulling the return address is left to the
+// registry.
+typedef void (*NativeRoutine)(CPU& cpu);
+
+struct Trap {
+    std::string name;
+    NativeRoutine routine;
+    uint8_t originalOpcode;   // the byte TRAP_OPCODE replaced
+    uint64_t calls;
+    uint64_t mismatches;      // verify mode only
+};
+
+// High-level emulation traps for hot guest routines (block copies, multiply,
+// divide, CRC). install() writes TRAP_OPCODE over a routine's first byte;
+// once the registry is attached to a CPU (CPU::setTrapRegistry), executing
+// that opcode runs the native routine and returns as RTS would. Programs can
+// also be assembled with TRAP_OPCODE at an entry point and install() called
+// on that address.
+//
+// In verify mode every trap also runs the guest's own code from the same
+// starting state and compares registers, flags, cycles and memory with what
+// the native routine produced. The guest's results are the ones kept.
+class TrapRegistry {
+public:
+    // JAM on the NMOS 6502, and invalid in every variant's opcode map.
+    static const uint8_t TRAP_OPCODE = 0x02;
+
+private:
+    Bus& bus;
+    std::unordered_map<uint16_t, Trap> traps;
+    bool verify;
+    uint64_t verifyLimit;
+
+    void patch(uint16_t address, uint8_t opcode);
+    void runNative(CPU& cpu, Trap& trap);
+    void runVerified(CPU& cpu, uint16_t address, Trap& trap);
+
+public:
+    explicit TrapRegistry(Bus& bus);
+
+    // Install after the program is loaded: loading over a trap removes it.
+    // Returns false if address already has a trap or is not on a RAM page.
+    bool install(uint16_t address, const std::string& name, NativeRoutine routine);
+    // Puts the original byte back.
+    void remove(uint16_t address);
+    const Trap* find(uint16_t address) const;
+
+    // The guest run gives up after maxInstructions and counts as a mismatch.
+    void setVerify(bool enabled, uint64_t maxInstructions = 100000000);
+    bool isVerifying() const;
+
+    // Called by the CPU for TRAP_OPCODE, with PC just past it. Opcodes at
+    // addresses without a trap run as the invalid opcode they are.
+    void execute(CPU& cpu);
+
+    void printStats() const;
+};
+
+inline bool TrapRegistry::isVerifying() const {
+    return verify;
+}
+
+#endif